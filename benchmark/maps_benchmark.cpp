@@ -0,0 +1,184 @@
+#include <benchmark/benchmark.h>
+
+#include <amc/config.hpp>
+#include <amc/flatmap.hpp>
+#include <amc/splitflatmap.hpp>
+#ifdef AMC_SMALLMAP
+#include <amc/smallmap.hpp>
+#endif
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "benchhelpers.hpp"
+#include "testhelpers.hpp"
+#include "testtypes.hpp"
+
+namespace amc {
+TypeStats TypeStats::_stats;
+
+namespace {
+
+using REFRelocType = std::map<uint32_t, ComplexTriviallyRelocatableType>;
+using REFNonRelocType = std::map<uint32_t, ComplexNonTriviallyRelocatableType>;
+using REFInt = std::map<uint32_t, uint32_t>;
+using REFUnoInt = std::unordered_map<uint32_t, uint32_t>;
+
+using AMCRelocType = amc::FlatMap<uint32_t, ComplexTriviallyRelocatableType>;
+using AMCNonRelocType = amc::FlatMap<uint32_t, ComplexNonTriviallyRelocatableType>;
+using AMCInt = amc::FlatMap<uint32_t, uint32_t>;
+
+/// Large mapped value, typical of rule tables, making binary search over pairs cache unfriendly
+struct LargeValue {
+  LargeValue(uint32_t i = 0) { std::fill(std::begin(_data), std::end(_data), i); }
+
+  operator uint32_t() const { return _data[0]; }
+
+  uint32_t _data[32];
+};
+
+using REFLargeValue = std::map<uint32_t, LargeValue>;
+using AMCLargeValue = amc::FlatMap<uint32_t, LargeValue>;
+using AMCSplitLargeValue = amc::SplitFlatMap<uint32_t, LargeValue>;
+
+#ifdef AMC_SMALLMAP
+using AMCSmallInt = amc::SmallMap<uint32_t, uint32_t, 16>;
+using AMCSmallFlatInt =
+    amc::SmallMap<uint32_t, uint32_t, 16, std::less<uint32_t>, amc::allocator<std::pair<uint32_t, uint32_t>>, AMCInt>;
+#endif
+
+template <class MapType>
+void InsertRandom(benchmark::State &state) {
+  TypeStats::_stats = TypeStats();
+  TypeStats::_stats.start();
+  for (auto _ : state) {
+    MapType m;
+    for (uint32_t s = 0; m.size() < kMaxValue / 5; ++s) {
+      uint32_t key = static_cast<uint32_t>(HashValue64(s) % kMaxValue);
+      m.emplace(key, s);
+    }
+  }
+  TypeStats::_stats.end();
+  PrintStats(state);
+}
+
+template <class MapType, unsigned InitNbInserts>
+void EraseRandom(benchmark::State &state) {
+  TypeStats::_stats = TypeStats();
+  uint32_t s = 0;
+  MapType elems;
+  std::vector<uint32_t> remainingKeys;
+  for (uint32_t i = 0; i < InitNbInserts; ++i) {
+    elems.emplace(i, i);
+    if (remainingKeys.empty()) {
+      remainingKeys.emplace_back(i);
+    } else {
+      remainingKeys.emplace(remainingKeys.begin() + (HashValue64(++s) % remainingKeys.size()), i);
+    }
+  }
+  TypeStats::_stats.start();
+  for (auto _ : state) {
+    MapType m = elems;
+    for (auto it = remainingKeys.rbegin(); it != remainingKeys.rend() && !m.empty(); ++it) {
+      m.erase(*it);
+    }
+  }
+  TypeStats::_stats.end();
+  PrintStats(state);
+}
+
+template <class MapType, unsigned Size>
+void LookUp(benchmark::State &state) {
+  TypeStats::_stats = TypeStats();
+  uint32_t s = 0;
+  MapType elems;
+  for (uint32_t i = 0; i < Size; ++i) {
+    elems.emplace(i, i);
+  }
+  TypeStats::_stats.start();
+  uint32_t out = 0;
+  for (auto _ : state) {
+    auto it = elems.find(static_cast<uint32_t>(HashValue64(++s) % Size));
+    if (it != elems.end()) {
+      out += uint32_t(it->second);
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  TypeStats::_stats.end();
+  PrintStats(state);
+}
+
+template <class MapType>
+void Iterate(benchmark::State &state) {
+  TypeStats::_stats = TypeStats();
+  MapType elems;
+  for (uint32_t i = 0; i < kMaxValue; ++i) {
+    elems.emplace(static_cast<uint32_t>(HashValue64(i)), i);
+  }
+  TypeStats::_stats.start();
+  uint32_t out = 0;
+  for (auto _ : state) {
+    for (const auto &p : elems) {
+      out += uint32_t(p.second);
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  TypeStats::_stats.end();
+  PrintStats(state);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(InsertRandom, REFRelocType);
+BENCHMARK_TEMPLATE(InsertRandom, AMCRelocType);
+
+BENCHMARK_TEMPLATE(EraseRandom, REFRelocType, 1000);
+BENCHMARK_TEMPLATE(EraseRandom, AMCRelocType, 1000);
+
+BENCHMARK_TEMPLATE(LookUp, REFRelocType, 100000);
+BENCHMARK_TEMPLATE(LookUp, AMCRelocType, 100000);
+
+BENCHMARK_TEMPLATE(InsertRandom, REFNonRelocType);
+BENCHMARK_TEMPLATE(InsertRandom, AMCNonRelocType);
+
+BENCHMARK_TEMPLATE(EraseRandom, REFNonRelocType, 1000);
+BENCHMARK_TEMPLATE(EraseRandom, AMCNonRelocType, 1000);
+
+BENCHMARK_TEMPLATE(InsertRandom, REFInt);
+BENCHMARK_TEMPLATE(InsertRandom, REFUnoInt);
+BENCHMARK_TEMPLATE(InsertRandom, AMCInt);
+
+BENCHMARK_TEMPLATE(EraseRandom, REFInt, 10000);
+BENCHMARK_TEMPLATE(EraseRandom, REFUnoInt, 10000);
+BENCHMARK_TEMPLATE(EraseRandom, AMCInt, 10000);
+
+BENCHMARK_TEMPLATE(LookUp, REFInt, 100000);
+BENCHMARK_TEMPLATE(LookUp, REFUnoInt, 100000);
+BENCHMARK_TEMPLATE(LookUp, AMCInt, 100000);
+
+BENCHMARK_TEMPLATE(LookUp, REFLargeValue, 100000);
+BENCHMARK_TEMPLATE(LookUp, AMCLargeValue, 100000);
+BENCHMARK_TEMPLATE(LookUp, AMCSplitLargeValue, 100000);
+
+BENCHMARK_TEMPLATE(InsertRandom, AMCLargeValue);
+BENCHMARK_TEMPLATE(InsertRandom, AMCSplitLargeValue);
+
+BENCHMARK_TEMPLATE(LookUp, REFInt, 12);
+BENCHMARK_TEMPLATE(LookUp, REFUnoInt, 12);
+BENCHMARK_TEMPLATE(LookUp, AMCInt, 12);
+#ifdef AMC_SMALLMAP
+BENCHMARK_TEMPLATE(LookUp, AMCSmallInt, 12);
+BENCHMARK_TEMPLATE(LookUp, AMCSmallFlatInt, 12);
+BENCHMARK_TEMPLATE(EraseRandom, AMCSmallInt, 12);
+BENCHMARK_TEMPLATE(EraseRandom, REFInt, 12);
+#endif
+
+BENCHMARK_TEMPLATE(Iterate, REFInt);
+BENCHMARK_TEMPLATE(Iterate, REFUnoInt);
+BENCHMARK_TEMPLATE(Iterate, AMCInt);
+BENCHMARK_TEMPLATE(Iterate, AMCSplitLargeValue);
+}  // namespace amc
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <amc/concurrentqueue.hpp>
+#include <amc/vector.hpp>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace amc {
+
+namespace {
+
+// Payloads passed between pipeline stages. amc::vector is trivially relocatable, so it is popped with memcpy.
+using AMCPayload = amc::vector<uint32_t>;
+using STLPayload = std::vector<uint32_t>;
+
+constexpr uint32_t kNbElemsPerProducer = 1U << 14;
+constexpr std::size_t kQueueCapacity = 1024;
+constexpr std::size_t kPopBatchSize = 32;
+
+template <class Queue>
+std::unique_ptr<Queue> MakeQueue(std::true_type /* is spsc */) {
+  return std::unique_ptr<Queue>(new Queue());
+}
+
+template <class Queue>
+std::unique_ptr<Queue> MakeQueue(std::false_type /* is spsc */) {
+  return std::unique_ptr<Queue>(new Queue(kQueueCapacity));
+}
+
+template <class T>
+struct IsSPSC : std::false_type {};
+
+template <class T, uintmax_t N>
+struct IsSPSC<SPSCQueue<T, N>> : std::true_type {};
+
+// 'state.range(0)' producer threads push payloads, popped in batches by the benchmark thread
+template <class Queue>
+void Throughput(benchmark::State &state) {
+  using Payload = typename Queue::value_type;
+  const uint32_t nbProducers = static_cast<uint32_t>(state.range(0));
+  for (auto _ : state) {
+    std::unique_ptr<Queue> queue = MakeQueue<Queue>(IsSPSC<Queue>());
+    std::vector<std::thread> producers;
+    for (uint32_t producerId = 0; producerId < nbProducers; ++producerId) {
+      producers.emplace_back([&queue] {
+        for (uint32_t i = 0; i < kNbElemsPerProducer; ++i) {
+          Payload payload(4U, i);
+          while (!queue->try_push(std::move(payload))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    Payload batch[kPopBatchSize];
+    for (uint64_t nbPopped = 0; nbPopped < uint64_t(nbProducers) * kNbElemsPerProducer;) {
+      const std::size_t nbElems = queue->try_pop_n(batch, kPopBatchSize);
+      if (nbElems == 0) {
+        std::this_thread::yield();
+      }
+      nbPopped += nbElems;
+    }
+    benchmark::DoNotOptimize(batch[0].data());
+    for (std::thread &producer : producers) {
+      producer.join();
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * nbProducers * kNbElemsPerProducer);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(Throughput, SPSCQueue<STLPayload, kQueueCapacity>)->Arg(1)->UseRealTime();
+BENCHMARK_TEMPLATE(Throughput, SPSCQueue<AMCPayload, kQueueCapacity>)->Arg(1)->UseRealTime();
+
+BENCHMARK_TEMPLATE(Throughput, MPMCQueue<STLPayload>)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(Throughput, MPMCQueue<AMCPayload>)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+}  // namespace amc
+
+BENCHMARK_MAIN();
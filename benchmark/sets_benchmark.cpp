@@ -2,9 +2,13 @@
 
 #include <amc/fixedcapacityvector.hpp>
 #include <amc/flatset.hpp>
+#include <amc/inlinestring.hpp>
 #include <amc/smallvector.hpp>
+#include <amc/staticsearchset.hpp>
 #include <set>
+#include <string>
 #include <unordered_set>
+#include <vector>
 #ifdef AMC_SMALLSET
 #include <amc/smallset.hpp>
 #endif
@@ -27,6 +31,10 @@ using AMCRelocType = amc::FlatSet<ComplexTriviallyRelocatableType>;
 using AMCNonRelocType = amc::FlatSet<ComplexNonTriviallyRelocatableType>;
 using AMCInt = amc::FlatSet<uint32_t>;
 
+using REFString = std::set<std::string>;
+using AMCString = amc::FlatSet<std::string>;
+using AMCInlineString = amc::FlatSet<amc::InlineString<24>>;
+
 template <class SetType>
 void InsertRandom(benchmark::State &state) {
   TypeStats::_stats = TypeStats();
@@ -70,6 +78,16 @@ void EraseRandom(benchmark::State &state) {
   PrintStats(state);
 }
 
+#ifdef AMC_SMALLSET
+/// Same as std::less, but not recognized as such, to measure SmallSet search without the equality scan
+struct OpaqueLess {
+  bool operator()(uint32_t lhs, uint32_t rhs) const { return lhs < rhs; }
+};
+
+using SmallSetNoScanInt = amc::SmallSet<uint32_t, 64, OpaqueLess, amc::allocator<uint32_t>,
+                                        std::set<uint32_t, OpaqueLess, amc::allocator<uint32_t>>>;
+#endif
+
 template <class SetType, unsigned Size>
 void LookUp(benchmark::State &state) {
   TypeStats::_stats = TypeStats();
@@ -92,6 +110,131 @@ void LookUp(benchmark::State &state) {
   PrintStats(state);
 }
 
+/// Lookups in a set built once from a FlatSet
+template <class SetType, unsigned Size>
+void FrozenLookUp(benchmark::State &state) {
+  std::vector<uint32_t> values(Size);
+  for (uint32_t i = 0; i < Size; ++i) {
+    values[i] = static_cast<uint32_t>(HashValue64(i));
+  }
+  SetType elems(FlatSet<uint32_t>(values.begin(), values.end()));
+  uint32_t s = 0;
+  uint32_t out = 0;
+  for (auto _ : state) {
+    if (elems.find(static_cast<uint32_t>(HashValue64(++s % Size))) != elems.end()) {
+      ++out;
+    }
+    benchmark::DoNotOptimize(out);
+  }
+}
+
+/// Bulk insertion of a range of unsorted values into a set already containing as many elements
+template <class SetType, unsigned Size>
+void InsertRange(benchmark::State &state) {
+  std::vector<uint32_t> values(2 * Size);
+  for (uint32_t i = 0; i < 2 * Size; ++i) {
+    values[i] = static_cast<uint32_t>(HashValue64(i));
+  }
+  const SetType initElems(values.begin(), values.begin() + Size);
+  for (auto _ : state) {
+    SetType elems = initElems;
+    elems.insert(values.begin() + Size, values.end());
+    benchmark::DoNotOptimize(elems);
+  }
+}
+
+/// Bulk insertion of a sorted range of values greater than the ones of the set, like a feed of increasing keys
+template <class SetType, unsigned Size>
+void AppendSortedRange(benchmark::State &state) {
+  std::vector<uint32_t> values(2 * Size);
+  for (uint32_t i = 0; i < 2 * Size; ++i) {
+    values[i] = i;
+  }
+  const SetType initElems(values.begin(), values.begin() + Size);
+  for (auto _ : state) {
+    SetType elems = initElems;
+    elems.insert(values.begin() + Size, values.end());
+    benchmark::DoNotOptimize(elems);
+  }
+}
+
+/// Construction from a concatenation of NbRuns sorted batches of interleaved values, like merged sorted feeds
+template <class SetType, unsigned Size, unsigned NbRuns>
+void ConstructFromRuns(benchmark::State &state) {
+  std::vector<uint32_t> values(Size);
+  for (uint32_t i = 0; i < Size; ++i) {
+    values[i] = (i % (Size / NbRuns)) * NbRuns + i / (Size / NbRuns);
+  }
+  for (auto _ : state) {
+    SetType elems(values.begin(), values.end());
+    benchmark::DoNotOptimize(elems);
+  }
+}
+
+#ifdef AMC_NONSTD_FEATURES
+/// Construction from unsorted values with NbThreads threads
+template <class SetType, unsigned Size, unsigned NbThreads>
+void ParallelConstruct(benchmark::State &state) {
+  std::vector<uint32_t> values(Size);
+  for (uint32_t i = 0; i < Size; ++i) {
+    values[i] = static_cast<uint32_t>(HashValue64(i));
+  }
+  for (auto _ : state) {
+    SetType elems(parallel_t{NbThreads}, values.begin(), values.end());
+    benchmark::DoNotOptimize(elems);
+  }
+}
+#endif
+
+/// Short upper case keys of 3 to 23 chars, like airport or carrier codes
+std::vector<std::string> StringKeys(uint32_t nbKeys) {
+  std::vector<std::string> keys(nbKeys);
+  for (uint32_t i = 0; i < nbKeys; ++i) {
+    uint64_t h = HashValue64(i);
+    keys[i].resize(3U + h % 21U);
+    for (char &c : keys[i]) {
+      h = HashValue64(h);
+      c = static_cast<char>('A' + h % 26U);
+    }
+  }
+  return keys;
+}
+
+template <class SetType, unsigned Size>
+void InsertStrings(benchmark::State &state) {
+  const std::vector<std::string> keys = StringKeys(Size);
+  for (auto _ : state) {
+    SetType elems;
+    for (const std::string &key : keys) {
+      elems.emplace(key.data(), key.size());
+    }
+    benchmark::DoNotOptimize(elems);
+  }
+}
+
+/// Lookups of keys already constructed, half of them being in the set
+template <class SetType, unsigned Size>
+void LookUpStrings(benchmark::State &state) {
+  using ValueType = typename SetType::value_type;
+  const std::vector<std::string> keys = StringKeys(2 * Size);
+  std::vector<ValueType> keysToLookFor;
+  SetType elems;
+  for (uint32_t i = 0; i < 2 * Size; ++i) {
+    if (i < Size) {
+      elems.emplace(keys[i].data(), keys[i].size());
+    }
+    keysToLookFor.emplace_back(keys[i].data(), keys[i].size());
+  }
+  uint32_t s = 0;
+  uint32_t out = 0;
+  for (auto _ : state) {
+    if (elems.find(keysToLookFor[HashValue64(++s) % keysToLookFor.size()]) != elems.end()) {
+      ++out;
+    }
+    benchmark::DoNotOptimize(out);
+  }
+}
+
 template <class SetType, unsigned TypicalMaxSize>
 void CommonUsage(benchmark::State &state) {
   TypeStats::_stats = TypeStats();
@@ -148,10 +291,47 @@ BENCHMARK_TEMPLATE(EraseRandom, AMCInt, 100000);
 BENCHMARK_TEMPLATE(LookUp, REFInt, 100000);
 BENCHMARK_TEMPLATE(LookUp, REFUnoInt, 100000);
 BENCHMARK_TEMPLATE(LookUp, AMCInt, 100000);
+BENCHMARK_TEMPLATE(LookUp, std::set<double>, 100000);
+BENCHMARK_TEMPLATE(LookUp, amc::FlatSet<double>, 100000);
+BENCHMARK_TEMPLATE(LookUp, AMCInt, 1000);
+BENCHMARK_TEMPLATE(LookUp, REFUnoInt, 1000);
+
+BENCHMARK_TEMPLATE(InsertStrings, REFString, 10000);
+BENCHMARK_TEMPLATE(InsertStrings, AMCString, 10000);
+BENCHMARK_TEMPLATE(InsertStrings, AMCInlineString, 10000);
+BENCHMARK_TEMPLATE(LookUpStrings, REFString, 100000);
+BENCHMARK_TEMPLATE(LookUpStrings, AMCString, 100000);
+BENCHMARK_TEMPLATE(LookUpStrings, AMCInlineString, 100000);
+
+BENCHMARK_TEMPLATE(InsertRange, REFInt, 100000);
+BENCHMARK_TEMPLATE(InsertRange, AMCInt, 100000);
+BENCHMARK_TEMPLATE(AppendSortedRange, REFInt, 100000);
+BENCHMARK_TEMPLATE(AppendSortedRange, AMCInt, 100000);
+BENCHMARK_TEMPLATE(ConstructFromRuns, AMCInt, 1000000, 8);
+BENCHMARK_TEMPLATE(ConstructFromRuns, AMCRelocType, 100000, 8);
+BENCHMARK_TEMPLATE(ConstructFromRuns, AMCNonRelocType, 100000, 8);
+#ifdef AMC_NONSTD_FEATURES
+BENCHMARK_TEMPLATE(ParallelConstruct, AMCInt, 4000000, 1);
+BENCHMARK_TEMPLATE(ParallelConstruct, AMCInt, 4000000, 4);
+BENCHMARK_TEMPLATE(ParallelConstruct, AMCRelocType, 1000000, 1);
+BENCHMARK_TEMPLATE(ParallelConstruct, AMCRelocType, 1000000, 4);
+#endif
+
+BENCHMARK_TEMPLATE(FrozenLookUp, AMCInt, 1000);
+BENCHMARK_TEMPLATE(FrozenLookUp, amc::StaticSearchSet<uint32_t>, 1000);
+BENCHMARK_TEMPLATE(FrozenLookUp, AMCInt, 100000);
+BENCHMARK_TEMPLATE(FrozenLookUp, amc::StaticSearchSet<uint32_t>, 100000);
+BENCHMARK_TEMPLATE(FrozenLookUp, AMCInt, 4000000);
+BENCHMARK_TEMPLATE(FrozenLookUp, amc::StaticSearchSet<uint32_t>, 4000000);
 
 #ifdef AMC_SMALLSET
 BENCHMARK_TEMPLATE(CommonUsage, amc::SmallSet<uint32_t, 50>, 50);
 BENCHMARK_TEMPLATE(CommonUsage, std::unordered_set<uint32_t>, 50);
+
+BENCHMARK_TEMPLATE(LookUp, amc::SmallSet<uint32_t, 64>, 64);
+BENCHMARK_TEMPLATE(LookUp, SmallSetNoScanInt, 64);
+BENCHMARK_TEMPLATE(LookUp, amc::SmallSet<uint32_t, 64>, 32);
+BENCHMARK_TEMPLATE(LookUp, SmallSetNoScanInt, 32);
 #endif
 }  // namespace amc
 
@@ -1,11 +1,19 @@
 #include <benchmark/benchmark.h>
 
 #include <amc/fixedcapacityvector.hpp>
+#include <amc/mmapallocator.hpp>
+#include <amc/poolallocator.hpp>
+#include <amc/ringvector.hpp>
+#include <amc/segmentedvector.hpp>
+#include <amc/smallstring.hpp>
 #include <amc/smallvector.hpp>
+#include <amc/soavector.hpp>
 #include <amc/vector.hpp>
 #include <array>
 #include <cstdint>
+#include <deque>
 #include <numeric>
+#include <string>
 #include <vector>
 
 #include "benchhelpers.hpp"
@@ -22,10 +30,20 @@ using AMCRelocType = amc::vector<ComplexTriviallyRelocatableType>;
 using AMCNonRelocType = amc::vector<ComplexNonTriviallyRelocatableType>;
 using AMCInt = amc::vector<uint32_t>;
 
+using AMCSegmentedRelocType = amc::SegmentedVector<ComplexTriviallyRelocatableType, 1024>;
+using AMCSegmentedNonRelocType = amc::SegmentedVector<ComplexNonTriviallyRelocatableType, 1024>;
+using AMCSegmentedInt = amc::SegmentedVector<uint32_t, 4096>;
+
 using REFRelocType = std::vector<ComplexTriviallyRelocatableType>;
 using REFNonRelocType = std::vector<ComplexNonTriviallyRelocatableType>;
 using REFInt = std::vector<uint32_t>;
 
+#ifdef AMC_MMAP_ALLOCATOR
+using AMCMmapNonRelocType =
+    amc::vector<ComplexNonTriviallyRelocatableType, amc::mmap_allocator<ComplexNonTriviallyRelocatableType>>;
+using AMCHugeBufferInt = amc::vector<uint32_t, amc::huge_buffer_allocator<uint32_t>>;
+#endif
+
 template <class VecType>
 void InsertNElemsRandom(benchmark::State &state) {
   TypeStats::_stats = TypeStats();
@@ -220,6 +238,92 @@ void CommonUsage(benchmark::State &state) {
   PrintStats(state);
 }
 
+struct Order {
+  uint64_t id;
+  double price;
+  uint32_t quantity;
+  uint32_t flags;
+  std::array<char, 16> symbol;
+};
+
+using AMCOrders = amc::vector<Order>;
+using SoAOrders = amc::SoAVector<uint64_t, double, uint32_t, uint32_t, std::array<char, 16>>;
+
+constexpr uint32_t kNbOrders = 1U << 16;
+
+Order MakeOrder(uint32_t i) {
+  uint64_t hash = HashValue64(i);
+  return Order{hash, static_cast<double>(hash % 10000U) / 100, static_cast<uint32_t>(hash % 1000U), i % 4U, {}};
+}
+
+// Hot loop reading only 2 fields of the orders
+void ColumnScanAoS(benchmark::State &state) {
+  AMCOrders orders;
+  for (uint32_t i = 0; i < kNbOrders; ++i) {
+    orders.push_back(MakeOrder(i));
+  }
+  for (auto _ : state) {
+    double notional = 0;
+    for (const Order &order : orders) {
+      notional += order.price * order.quantity;
+    }
+    benchmark::DoNotOptimize(notional);
+  }
+}
+
+void ColumnScanSoA(benchmark::State &state) {
+  SoAOrders orders;
+  for (uint32_t i = 0; i < kNbOrders; ++i) {
+    Order order = MakeOrder(i);
+    orders.emplace_back(order.id, order.price, order.quantity, order.flags, order.symbol);
+  }
+  for (auto _ : state) {
+    const double *prices = orders.data<1>();
+    const uint32_t *quantities = orders.data<2>();
+    double notional = 0;
+    for (uint32_t i = 0; i < orders.size(); ++i) {
+      notional += prices[i] * quantities[i];
+    }
+    benchmark::DoNotOptimize(notional);
+  }
+}
+
+// Vector of short strings (identifiers), which are stored inline by both string types
+template <class VecType>
+void GrowingStrings(benchmark::State &state) {
+  using StringType = typename VecType::value_type;
+  std::vector<std::string> ids;
+  for (uint32_t i = 0; i < (1U << 16); ++i) {
+    ids.push_back("ID" + std::to_string(HashValue64(i) % 100000000U));
+  }
+  for (auto _ : state) {
+    VecType v;
+    for (const std::string &id : ids) {
+      v.emplace_back(id.data(), static_cast<typename StringType::size_type>(id.size()));
+    }
+    benchmark::DoNotOptimize(v.data());
+  }
+}
+
+// Bounded queue with a steady number of pending packets: each new packet is pushed at the back, the oldest one is
+// popped from the front
+template <class QueueType>
+void PacketQueue(benchmark::State &state) {
+  constexpr uint32_t kNbPendingPackets = 48;
+  QueueType queue;
+  for (uint32_t i = 0; i < kNbPendingPackets; ++i) {
+    queue.push_back(i);
+  }
+  uint32_t packet = kNbPendingPackets;
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < 1024U; ++i) {
+      benchmark::DoNotOptimize(queue.front());
+      queue.pop_front();
+      queue.push_back(++packet);
+    }
+  }
+}
+
 }  // namespace
 
 BENCHMARK_TEMPLATE(AssignRandom, REFRelocType);
@@ -242,6 +346,7 @@ BENCHMARK_TEMPLATE(InsertFromForwardItRandom, AMCRelocType);
 
 BENCHMARK_TEMPLATE(Growing, REFRelocType);
 BENCHMARK_TEMPLATE(Growing, AMCRelocType);
+BENCHMARK_TEMPLATE(Growing, AMCSegmentedRelocType);
 
 BENCHMARK_TEMPLATE(AssignRandom, REFInt);
 BENCHMARK_TEMPLATE(AssignRandom, AMCInt);
@@ -263,6 +368,10 @@ BENCHMARK_TEMPLATE(InsertFromForwardItRandom, AMCInt);
 
 BENCHMARK_TEMPLATE(Growing, REFInt);
 BENCHMARK_TEMPLATE(Growing, AMCInt);
+BENCHMARK_TEMPLATE(Growing, AMCSegmentedInt);
+#ifdef AMC_MMAP_ALLOCATOR
+BENCHMARK_TEMPLATE(Growing, AMCHugeBufferInt);
+#endif
 
 BENCHMARK_TEMPLATE(AssignRandom, REFNonRelocType);
 BENCHMARK_TEMPLATE(AssignRandom, AMCNonRelocType);
@@ -284,8 +393,13 @@ BENCHMARK_TEMPLATE(InsertFromForwardItRandom, AMCNonRelocType);
 
 BENCHMARK_TEMPLATE(Growing, REFNonRelocType);
 BENCHMARK_TEMPLATE(Growing, AMCNonRelocType);
+BENCHMARK_TEMPLATE(Growing, AMCSegmentedNonRelocType);
+#ifdef AMC_MMAP_ALLOCATOR
+BENCHMARK_TEMPLATE(Growing, AMCMmapNonRelocType);
+#endif
 
 BENCHMARK_TEMPLATE(CommonUsage, amc::vector<int>, 30);
+BENCHMARK_TEMPLATE(CommonUsage, amc::vector<int, amc::pool_allocator<int>>, 30);
 BENCHMARK_TEMPLATE(CommonUsage, amc::SmallVector<int, 32>, 30);
 BENCHMARK_TEMPLATE(CommonUsage, amc::FixedCapacityVector<int, 40>, 30);
 
@@ -296,6 +410,17 @@ BENCHMARK_TEMPLATE(CommonUsage, amc::FixedCapacityVector<ComplexTriviallyRelocat
 BENCHMARK_TEMPLATE(CommonUsage, amc::vector<ComplexNonTriviallyRelocatableType>, 100);
 BENCHMARK_TEMPLATE(CommonUsage, amc::SmallVector<ComplexNonTriviallyRelocatableType, 100>, 100);
 
+BENCHMARK(ColumnScanAoS);
+BENCHMARK(ColumnScanSoA);
+
+BENCHMARK_TEMPLATE(GrowingStrings, std::vector<std::string>);
+BENCHMARK_TEMPLATE(GrowingStrings, amc::vector<std::string>);
+BENCHMARK_TEMPLATE(GrowingStrings, amc::vector<amc::SmallString<16>>);
+
+BENCHMARK_TEMPLATE(PacketQueue, std::deque<uint32_t>);
+BENCHMARK_TEMPLATE(PacketQueue, amc::RingVector<uint32_t>);
+BENCHMARK_TEMPLATE(PacketQueue, amc::FixedCapacityRing<uint32_t, 64>);
+
 }  // namespace amc
 
 BENCHMARK_MAIN();
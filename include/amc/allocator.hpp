@@ -5,11 +5,130 @@
 #include <new>
 
 #include "config.hpp"
+#include "isdetected.hpp"
 #include "memory.hpp"
 #include "type_traits.hpp"
 
+#ifndef AMC_NO_MALLOC_USABLE_SIZE
+#if defined(__GLIBC__) || defined(__ANDROID__)
+#include <malloc.h>
+#define AMC_MALLOC_USABLE_SIZE(p) malloc_usable_size(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define AMC_MALLOC_USABLE_SIZE(p) malloc_size(p)
+#elif defined(_MSC_VER)
+#include <malloc.h>
+#define AMC_MALLOC_USABLE_SIZE(p) _msize(p)
+#endif
+#endif
+
 namespace amc {
 
+/// Result of an allocation of at least a given number of elements (same as C++23 std::allocation_result).
+/// 'count' is the real number of elements (or bytes for basic allocators) usable from 'ptr'.
+template <class Pointer, class SizeType = std::size_t>
+struct allocation_result {
+  Pointer ptr;
+  SizeType count;
+};
+
+namespace memory_details {
+template <class T>
+using has_basic_allocate_at_least_t = decltype(std::declval<T>().allocate_at_least(std::declval<size_t>()));
+
+template <class T>
+using has_basic_reallocate_at_least_t = decltype(std::declval<T>().reallocate_at_least(
+    std::declval<void *>(), std::declval<size_t>(), std::declval<size_t>()));
+
+template <class T>
+using has_basic_sized_allocate_at_least_t =
+    decltype(std::declval<T>().allocate_at_least(std::declval<size_t>(), std::declval<size_t>()));
+
+template <class T>
+using has_basic_sized_reallocate_at_least_t = decltype(std::declval<T>().reallocate_at_least(
+    std::declval<void *>(), std::declval<size_t>(), std::declval<size_t>(), std::declval<size_t>()));
+
+template <class T>
+using has_basic_try_expand_t = decltype(std::declval<T>().try_expand(
+    std::declval<void *>(), std::declval<size_t>(), std::declval<size_t>()));
+
+template <class T>
+using has_basic_allocate_at_least = is_detected<has_basic_allocate_at_least_t, T>;
+
+template <class T>
+using has_basic_reallocate_at_least = is_detected<has_basic_reallocate_at_least_t, T>;
+
+template <class T>
+using has_basic_sized_allocate_at_least = is_detected<has_basic_sized_allocate_at_least_t, T>;
+
+template <class T>
+using has_basic_sized_reallocate_at_least = is_detected<has_basic_sized_reallocate_at_least_t, T>;
+
+template <class T>
+using has_basic_try_expand = is_detected<has_basic_try_expand_t, T>;
+
+/// Calls 'allocate_at_least' of given basic allocator, with the size of the elements if it accepts it.
+template <class B>
+typename std::enable_if<has_basic_sized_allocate_at_least<B>::value, allocation_result<void *>>::type
+BasicAllocateAtLeast(B &basicAlloc, size_t n, size_t elemSize) {
+  return basicAlloc.allocate_at_least(n, elemSize);
+}
+
+template <class B>
+typename std::enable_if<!has_basic_sized_allocate_at_least<B>::value, allocation_result<void *>>::type
+BasicAllocateAtLeast(B &basicAlloc, size_t n, size_t) {
+  return basicAlloc.allocate_at_least(n);
+}
+
+/// Calls 'reallocate_at_least' of given basic allocator, with the size of the elements if it accepts it.
+template <class B>
+typename std::enable_if<has_basic_sized_reallocate_at_least<B>::value, allocation_result<void *>>::type
+BasicReallocateAtLeast(B &basicAlloc, void *p, size_t oldSz, size_t newSz, size_t elemSize) {
+  return basicAlloc.reallocate_at_least(p, oldSz, newSz, elemSize);
+}
+
+template <class B>
+typename std::enable_if<!has_basic_sized_reallocate_at_least<B>::value, allocation_result<void *>>::type
+BasicReallocateAtLeast(B &basicAlloc, void *p, size_t oldSz, size_t newSz, size_t) {
+  return basicAlloc.reallocate_at_least(p, oldSz, newSz);
+}
+
+template <class T>
+using has_basic_equal_t = decltype(std::declval<const T &>() == std::declval<const T &>());
+
+template <class T>
+using has_basic_equal = is_detected<has_basic_equal_t, T>;
+
+/// Stateless basic allocators are always equal, stateful ones are equal if they compare equal (if they can).
+template <class BasicAllocator>
+constexpr typename std::enable_if<std::is_empty<BasicAllocator>::value, bool>::type AreEqualBasicAllocators(
+    const BasicAllocator &, const BasicAllocator &) noexcept {
+  return true;
+}
+
+template <class BasicAllocator>
+constexpr typename std::enable_if<!std::is_empty<BasicAllocator>::value && has_basic_equal<BasicAllocator>::value,
+                                  bool>::type
+AreEqualBasicAllocators(const BasicAllocator &lhs, const BasicAllocator &rhs) noexcept {
+  return lhs == rhs;
+}
+
+template <class BasicAllocator>
+constexpr typename std::enable_if<!std::is_empty<BasicAllocator>::value && !has_basic_equal<BasicAllocator>::value,
+                                  bool>::type
+AreEqualBasicAllocators(const BasicAllocator &, const BasicAllocator &) noexcept {
+  return false;
+}
+
+#if defined(AMC_MALLOC_USABLE_SIZE) && defined(__GNUC__)
+/// Tells the compiler that the whole usable size of the block 'p' can be accessed, as it would otherwise only
+/// consider the requested size (_FORTIFY_SOURCE object size checks). It must not be inlined for that purpose.
+__attribute__((noinline, alloc_size(2))) inline void *ExpandToUsableSize(void *p, size_t) { return p; }
+#else
+inline void *ExpandToUsableSize(void *p, size_t) { return p; }
+#endif
+}  // namespace memory_details
+
 /**
  * Adaptor that wraps a singleton class Alloc into a "basic" allocator.
  * Alloc is expected to model the "basic" allocator concept and to provide
@@ -19,6 +138,15 @@ namespace amc {
  * void *allocate(size_t n)
  * void *reallocate(void *p, size_t oldSz, size_t newSz)
  * void deallocate(void *p, size_t n)
+ *
+ * and optionally, to give back the real usable size of the returned blocks:
+ * allocation_result<void *> allocate_at_least(size_t n)
+ * allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz)
+ * They may accept an additional 'size_t elemSize' argument, in which case BasicAllocatorWrapper gives them the size of
+ * its elements: only a multiple of it is used from the returned block, and then passed back to 'deallocate'.
+ *
+ * and optionally, to extend a block without moving it (returns false if block cannot be extended in place):
+ * bool try_expand(void *p, size_t oldSz, size_t newSz)
  */
 template <typename Alloc>
 class BasicSingletonAllocatorAdaptor {
@@ -26,6 +154,22 @@ class BasicSingletonAllocatorAdaptor {
   void *allocate(size_t n) { return Alloc::instance().allocate(n); }
   void *reallocate(void *p, size_t oldSz, size_t newSz) { return Alloc::instance().reallocate(p, oldSz, newSz); }
   void deallocate(void *p, size_t n) { Alloc::instance().deallocate(p, n); }
+
+  template <class A = Alloc>
+  auto allocate_at_least(size_t n) -> decltype(A::instance().allocate_at_least(n)) {
+    return Alloc::instance().allocate_at_least(n);
+  }
+
+  template <class A = Alloc>
+  auto reallocate_at_least(void *p, size_t oldSz, size_t newSz)
+      -> decltype(A::instance().reallocate_at_least(p, oldSz, newSz)) {
+    return Alloc::instance().reallocate_at_least(p, oldSz, newSz);
+  }
+
+  template <class A = Alloc>
+  auto try_expand(void *p, size_t oldSz, size_t newSz) -> decltype(A::instance().try_expand(p, oldSz, newSz)) {
+    return Alloc::instance().try_expand(p, oldSz, newSz);
+  }
 };
 
 /**
@@ -38,6 +182,16 @@ class BasicSingletonAllocatorAdaptor {
  *
  * If type T is trivially relocatable, 'reallocate' will be optimized into a call to 'realloc',
  * otherwise it will simply allocate the new block and relocate all elements into it.
+ *
+ * 'allocate_at_least' and 'reallocate_at_least' return the real number of elements that fit in the returned block,
+ * if the basic allocator provides the corresponding optional methods (otherwise exactly the requested number).
+ *
+ * If the basic allocator provides the optional 'try_expand' method, it is provided as well, and 'reallocate' of non
+ * trivially relocatable types first attempts to expand the block in place before relocating its elements.
+ *
+ * Stateful basic allocators (like MonotonicArenaRef or MemoryResourceRef) should provide operator== telling whether
+ * blocks allocated by one can be freed by the other, otherwise they never compare equal.
+ * Containers only exchange their dynamic storage (on move assignment and swap) if their allocators are equal.
  */
 template <class T, class BasicAllocator>
 class BasicAllocatorWrapper : private BasicAllocator {
@@ -49,6 +203,7 @@ class BasicAllocatorWrapper : private BasicAllocator {
   using const_pointer = const T *;
   using reference = T &;
   using const_reference = const T &;
+  using is_always_equal = typename std::is_empty<BasicAllocator>::type;
 
   BasicAllocatorWrapper() = default;
 
@@ -57,9 +212,14 @@ class BasicAllocatorWrapper : private BasicAllocator {
   BasicAllocatorWrapper &operator=(const BasicAllocatorWrapper &) noexcept = default;
   BasicAllocatorWrapper &operator=(BasicAllocatorWrapper &&) noexcept = default;
 
+  /// Builds an allocator from a stateful basic allocator
+  explicit BasicAllocatorWrapper(const BasicAllocator &basicAlloc) : BasicAllocator(basicAlloc) {}
+
   template <class U>
   BasicAllocatorWrapper(const BasicAllocatorWrapper<U, BasicAllocator> &o) : BasicAllocator(o) {}
 
+  const BasicAllocator &basic_allocator() const noexcept { return *this; }
+
   pointer address(reference r) const noexcept { return std::addressof(r); }
   const_pointer address(const_reference r) const noexcept { return std::addressof(r); }
 
@@ -71,6 +231,19 @@ class BasicAllocatorWrapper : private BasicAllocator {
     return Reallocate(*this, p, oldCapacity, newCapacity, nConstructedElems);
   }
 
+  allocation_result<pointer, size_type> allocate_at_least(size_type n) { return AllocateAtLeast(*this, n); }
+
+  allocation_result<pointer, size_type> reallocate_at_least(pointer p, size_type oldCapacity, size_type newCapacity,
+                                                            size_type nConstructedElems) {
+    return ReallocateAtLeast(*this, p, oldCapacity, newCapacity, nConstructedElems);
+  }
+
+  template <class B = BasicAllocator,
+            typename std::enable_if<memory_details::has_basic_try_expand<B>::value, bool>::type = true>
+  bool try_expand(pointer p, size_type oldCapacity, size_type newCapacity) {
+    return BasicAllocator::try_expand(p, oldCapacity * sizeof(T), newCapacity * sizeof(T));
+  }
+
   void deallocate(pointer p, size_type s) { BasicAllocator::deallocate(p, s * sizeof(T)); }
 
   constexpr size_type max_size() const { return static_cast<size_type>(-1) / sizeof(value_type); }
@@ -91,8 +264,8 @@ class BasicAllocatorWrapper : private BasicAllocator {
   };
 
   template <typename U>
-  constexpr bool operator==(const BasicAllocatorWrapper<U, BasicAllocator> &) const {
-    return std::is_empty<BasicAllocator>::value;
+  constexpr bool operator==(const BasicAllocatorWrapper<U, BasicAllocator> &o) const {
+    return memory_details::AreEqualBasicAllocators(basic_allocator(), o.basic_allocator());
   }
 
   template <typename U>
@@ -107,6 +280,9 @@ class BasicAllocatorWrapper : private BasicAllocator {
   template <class V = T>
   static typename std::enable_if<!amc::is_trivially_relocatable<V>::value, T *>::type Reallocate(
       BasicAllocator &basicAlloc, V *p, size_t oldCapacity, size_t newCapacity, size_t nConstructedElems) {
+    if (oldCapacity != 0 && newCapacity > oldCapacity && TryExpand(basicAlloc, p, oldCapacity, newCapacity)) {
+      return p;
+    }
     T *newPtr = static_cast<T *>(basicAlloc.allocate(newCapacity * sizeof(T)));
     amc::uninitialized_relocate_n(p, nConstructedElems, newPtr);
     basicAlloc.deallocate(p, oldCapacity * sizeof(T));
@@ -118,6 +294,65 @@ class BasicAllocatorWrapper : private BasicAllocator {
       BasicAllocator &basicAlloc, V *p, size_t oldCapacity, size_t newCapacity, size_t) {
     return static_cast<T *>(basicAlloc.reallocate(p, oldCapacity * sizeof(T), newCapacity * sizeof(T)));
   }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<memory_details::has_basic_try_expand<B>::value, bool>::type TryExpand(
+      BasicAllocator &basicAlloc, T *p, size_t oldCapacity, size_t newCapacity) {
+    return basicAlloc.try_expand(p, oldCapacity * sizeof(T), newCapacity * sizeof(T));
+  }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<!memory_details::has_basic_try_expand<B>::value, bool>::type TryExpand(
+      BasicAllocator &, T *, size_t, size_t) {
+    return false;
+  }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<memory_details::has_basic_allocate_at_least<B>::value,
+                                 allocation_result<T *, size_t>>::type
+  AllocateAtLeast(BasicAllocator &basicAlloc, size_t n) {
+    auto res = memory_details::BasicAllocateAtLeast(basicAlloc, n * sizeof(T), sizeof(T));
+    return {static_cast<T *>(res.ptr), res.count / sizeof(T)};
+  }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<!memory_details::has_basic_allocate_at_least<B>::value,
+                                 allocation_result<T *, size_t>>::type
+  AllocateAtLeast(BasicAllocator &basicAlloc, size_t n) {
+    return {static_cast<T *>(basicAlloc.allocate(n * sizeof(T))), n};
+  }
+
+  template <class V = T>
+  static typename std::enable_if<!amc::is_trivially_relocatable<V>::value, allocation_result<T *, size_t>>::type
+  ReallocateAtLeast(BasicAllocator &basicAlloc, V *p, size_t oldCapacity, size_t newCapacity,
+                    size_t nConstructedElems) {
+    if (oldCapacity != 0 && newCapacity > oldCapacity && TryExpand(basicAlloc, p, oldCapacity, newCapacity)) {
+      return {p, newCapacity};
+    }
+    allocation_result<T *, size_t> res = AllocateAtLeast(basicAlloc, newCapacity);
+    amc::uninitialized_relocate_n(p, nConstructedElems, res.ptr);
+    basicAlloc.deallocate(p, oldCapacity * sizeof(T));
+    return res;
+  }
+
+  template <class V = T>
+  static typename std::enable_if<amc::is_trivially_relocatable<V>::value &&
+                                     memory_details::has_basic_reallocate_at_least<BasicAllocator>::value,
+                                 allocation_result<T *, size_t>>::type
+  ReallocateAtLeast(BasicAllocator &basicAlloc, V *p, size_t oldCapacity, size_t newCapacity, size_t) {
+    auto res = memory_details::BasicReallocateAtLeast(basicAlloc, p, oldCapacity * sizeof(T), newCapacity * sizeof(T),
+                                                      sizeof(T));
+    return {static_cast<T *>(res.ptr), res.count / sizeof(T)};
+  }
+
+  template <class V = T>
+  static typename std::enable_if<amc::is_trivially_relocatable<V>::value &&
+                                     !memory_details::has_basic_reallocate_at_least<BasicAllocator>::value,
+                                 allocation_result<T *, size_t>>::type
+  ReallocateAtLeast(BasicAllocator &basicAlloc, V *p, size_t oldCapacity, size_t newCapacity, size_t) {
+    return {static_cast<T *>(basicAlloc.reallocate(p, oldCapacity * sizeof(T), newCapacity * sizeof(T))),
+            newCapacity};
+  }
 };
 
 template <class BasicAllocator>
@@ -140,6 +375,10 @@ struct BasicAllocatorWrapper<void, BasicAllocator> {
  * void * allocate(size_t n)
  * void *reallocate(void *p, size_t oldSz, size_t newSz)
  * void deallocate(void *p, size_t n)
+ *
+ * When the C library tells the usable size of a block (malloc_usable_size, malloc_size, _msize), 'allocate_at_least'
+ * and 'reallocate_at_least' return it, so that containers can use the slack of the size class of the block.
+ * Define AMC_NO_MALLOC_USABLE_SIZE to disable it.
  */
 struct SimpleAllocator {
   void *allocate(size_t n) {
@@ -158,7 +397,31 @@ struct SimpleAllocator {
     return p;
   }
 
+  allocation_result<void *> allocate_at_least(size_t n) {
+    void *ptr = allocate(n);
+    return {ptr, UsableSize(ptr, n)};
+  }
+
+  allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz) {
+    p = reallocate(p, oldSz, newSz);
+    return {p, UsableSize(p, newSz)};
+  }
+
   void deallocate(void *p, size_t) { free(p); }
+
+ private:
+  static size_t UsableSize(void *&p, size_t n) {
+#ifdef AMC_MALLOC_USABLE_SIZE
+    const size_t usableSize = AMC_MALLOC_USABLE_SIZE(p);
+    if (usableSize > n) {
+      p = memory_details::ExpandToUsableSize(p, usableSize);
+      return usableSize;
+    }
+#else
+    (void)p;
+#endif
+    return n;
+  }
 };
 
 /**
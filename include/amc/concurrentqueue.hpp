@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "memory.hpp"
+#include "type_traits.hpp"
+#include "vectorcommon.hpp"
+
+namespace amc {
+namespace vec {
+
+/// Size of the padding separating data written by different threads, to avoid false sharing.
+/// std::hardware_destructive_interference_size is not used as its value may change between compilations.
+constexpr std::size_t kCacheLineSize = 64;
+
+/// Moves the element at 'elem' into the constructed object at 'dest', and destroys 'elem'.
+/// Trivially relocatable types are relocated by memcpy instead of being move assigned and destroyed.
+template <class T>
+inline void relocate_assign_at(T *elem, T *dest, std::true_type) noexcept {
+  amc::destroy_at(dest);
+  amc::relocate_at(elem, dest);
+}
+
+template <class T>
+inline void relocate_assign_at(T *elem, T *dest, std::false_type) noexcept {
+  *dest = std::move(*elem);
+  amc::destroy_at(elem);
+}
+
+/// Same as relocate_assign_at for 'n' contiguous elements, in a single memcpy for trivially relocatable types.
+template <class T>
+inline void relocate_assign_n(T *first, std::size_t n, T *dest, std::true_type) noexcept {
+  amc::destroy_n(dest, n);
+  (void)amc::uninitialized_relocate_n(first, n, dest);
+}
+
+template <class T>
+inline void relocate_assign_n(T *first, std::size_t n, T *dest, std::false_type) noexcept {
+  std::move(first, first + n, dest);
+  amc::destroy_n(first, n);
+}
+
+}  // namespace vec
+
+/**
+ * Lock-free bounded queue for exactly one producer thread and one consumer thread, storing at most N elements inline.
+ *
+ * Producer and consumer positions are on their own cache lines, each with a cached copy of the other position, so
+ * that they only share a cache line when the queue looks full or empty. Elements are contiguous in a power of 2
+ * number of slots (N rounded up), so that batches are pushed and popped in at most two contiguous ranges.
+ *
+ * Elements are popped into existing objects: trivially relocatable types (such as amc vectors) are relocated with
+ * memcpy instead of being move assigned and destroyed.
+ *
+ * As it is over-aligned, allocating a queue on the heap requires C++17 (aligned new).
+ */
+template <class T, uintmax_t N>
+class SPSCQueue {
+  static_assert(N != 0, "SPSCQueue should have a strictly positive capacity");
+  static_assert(vec::is_shift_nothrow<T>::value,
+                "SPSCQueue requires trivially relocatable types or nothrow move constructible and assignable types");
+
+  static constexpr std::size_t kNbSlots = static_cast<std::size_t>(vec::NextPowerOf2(N));
+  static constexpr std::size_t kMask = kNbSlots - 1U;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+  SPSCQueue() noexcept = default;
+
+  SPSCQueue(const SPSCQueue &) = delete;
+  SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+  ~SPSCQueue() {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    for (std::size_t pos = head; pos != tail; ++pos) {
+      amc::destroy_at(slot(pos));
+    }
+  }
+
+  static constexpr size_type capacity() noexcept { return static_cast<size_type>(N); }
+
+  /// Number of elements in the queue, which may be already outdated if called during concurrent pushes or pops.
+  size_type size() const noexcept {
+    const std::size_t head = _head.load(std::memory_order_acquire);
+    return _tail.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /// Producer only. Constructs a new element at the end of the queue, and returns false (without constructing
+  /// anything) if the queue is full.
+  template <class... Args>
+  bool try_emplace(Args &&...args) {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    if (AMC_UNLIKELY(freeSlots(tail, 1U) == 0)) {
+      return false;
+    }
+    amc::construct_at(slot(tail), std::forward<Args>(args)...);
+    _tail.store(tail + 1U, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(const T &v) { return try_emplace(v); }
+  bool try_push(T &&v) { return try_emplace(std::move(v)); }
+
+  /// Producer only. Moves at most 'n' elements from 'first' to the end of the queue, returning the number of pushed
+  /// elements. Pushed elements are published to the consumer all at once.
+  size_type try_push_n(T *first, size_type n) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    n = std::min(n, freeSlots(tail, n));
+    const std::size_t idx = tail & kMask;
+    const std::size_t nOne = std::min(n, kNbSlots - idx);
+    MoveToSlots(first, nOne, slots() + idx, n - nOne, slots());
+    _tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Consumer only. Moves the first element of the queue to 'out' and pops it, or returns false if queue is empty.
+  bool try_pop(T &out) noexcept {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    if (AMC_UNLIKELY(nbReadable(head, 1U) == 0)) {
+      return false;
+    }
+    vec::relocate_assign_at(slot(head), std::addressof(out), amc::is_trivially_relocatable<T>());
+    _head.store(head + 1U, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer only. Moves at most 'n' elements from the front of the queue to the 'n' objects starting at 'first',
+  /// returning the number of popped elements.
+  size_type try_pop_n(T *first, size_type n) noexcept {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    n = std::min(n, nbReadable(head, n));
+    const std::size_t idx = head & kMask;
+    const std::size_t nOne = std::min(n, kNbSlots - idx);
+    vec::relocate_assign_n(slots() + idx, nOne, first, amc::is_trivially_relocatable<T>());
+    vec::relocate_assign_n(slots(), n - nOne, first + nOne, amc::is_trivially_relocatable<T>());
+    _head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+ private:
+  T *slots() noexcept { return _slots[0].ptr(); }
+  T *slot(std::size_t pos) noexcept { return _slots[pos & kMask].ptr(); }
+
+  /// Moves 'nOne' elements from 'first' to 'destOne', then the next 'nTwo' ones to 'destTwo'.
+  static void MoveToSlots(T *first, std::size_t nOne, T *destOne, std::size_t nTwo, T *destTwo) {
+    (void)amc::uninitialized_move_n(first, nOne, destOne);
+    try {
+      (void)amc::uninitialized_move_n(first + nOne, nTwo, destTwo);
+    } catch (...) {
+      amc::destroy_n(destOne, nOne);
+      throw;
+    }
+  }
+
+  /// Number of free slots from the producer point of view, reloading the consumer position only if there are less
+  /// than 'nbWanted' ones.
+  std::size_t freeSlots(std::size_t tail, std::size_t nbWanted) noexcept {
+    std::size_t nbFree = N - (tail - _cachedHead);
+    if (nbFree < nbWanted) {
+      _cachedHead = _head.load(std::memory_order_acquire);
+      nbFree = N - (tail - _cachedHead);
+    }
+    return nbFree;
+  }
+
+  /// Number of readable elements from the consumer point of view, reloading the producer position only if there are
+  /// less than 'nbWanted' ones.
+  std::size_t nbReadable(std::size_t head, std::size_t nbWanted) noexcept {
+    std::size_t nbElems = _cachedTail - head;
+    if (nbElems < nbWanted) {
+      _cachedTail = _tail.load(std::memory_order_acquire);
+      nbElems = _cachedTail - head;
+    }
+    return nbElems;
+  }
+
+  // Written by the consumer
+  alignas(vec::kCacheLineSize) std::atomic<std::size_t> _head{0};
+  std::size_t _cachedTail = 0;
+
+  // Written by the producer
+  alignas(vec::kCacheLineSize) std::atomic<std::size_t> _tail{0};
+  std::size_t _cachedHead = 0;
+
+  alignas(vec::kCacheLineSize) vec::ElemStorage<T> _slots[kNbSlots];
+};
+
+/**
+ * Lock-free bounded queue for any number of producer and consumer threads, with a capacity given at construction
+ * (rounded up to a power of 2) and allocated once.
+ *
+ * Each slot holds its element and a sequence number telling whether it is ready to be written or read for a given
+ * position (Dmitry Vyukov's bounded MPMC queue). Slots are padded to a cache line, so that threads working on
+ * neighbour slots do not share cache lines, and producer and consumer positions are on their own cache lines.
+ *
+ * Elements are constructed before claiming a slot, then relocated into it, and popped into existing objects:
+ * trivially relocatable types (such as amc vectors) are moved around with memcpy.
+ *
+ * Slots are aligned on cache lines within their buffer whatever the standard, but the queue itself is over-aligned
+ * (for its positions), so allocating a queue on the heap requires C++17 (aligned new), as for SPSCQueue.
+ */
+template <class T>
+class MPMCQueue {
+  static_assert(vec::is_shift_nothrow<T>::value,
+                "MPMCQueue requires trivially relocatable types or nothrow move constructible and assignable types");
+  static_assert(alignof(T) <= vec::kCacheLineSize, "MPMCQueue does not support types aligned on more than a cache line");
+
+  struct alignas(vec::kCacheLineSize) Slot {
+    std::atomic<std::size_t> seq;
+    vec::ElemStorage<T> elem;
+  };
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+  /// Creates a queue of at least 'capacity' elements (rounded up to a power of 2).
+  explicit MPMCQueue(size_type capacity) : _mask(RoundCapacity(capacity) - 1U) {
+    const std::size_t nbSlots = _mask + 1U;
+    _buffer = SimpleAllocator().allocate(nbSlots * sizeof(Slot) + vec::kCacheLineSize - 1U);
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(_buffer);
+    _slots = reinterpret_cast<Slot *>((addr + vec::kCacheLineSize - 1U) & ~uintptr_t(vec::kCacheLineSize - 1U));
+    for (std::size_t pos = 0; pos < nbSlots; ++pos) {
+      amc::construct_at(_slots + pos);
+      _slots[pos].seq.store(pos, std::memory_order_relaxed);
+    }
+  }
+
+  MPMCQueue(const MPMCQueue &) = delete;
+  MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+  ~MPMCQueue() {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    for (std::size_t pos = head; pos != tail; ++pos) {
+      amc::destroy_at(_slots[pos & _mask].elem.ptr());
+    }
+    amc::destroy_n(_slots, _mask + 1U);
+    SimpleAllocator().deallocate(_buffer, (_mask + 1U) * sizeof(Slot) + vec::kCacheLineSize - 1U);
+  }
+
+  size_type capacity() const noexcept { return _mask + 1U; }
+
+  /// Approximate number of elements in the queue, including the ones being pushed or popped by other threads.
+  size_type size() const noexcept {
+    const std::size_t head = _head.load(std::memory_order_acquire);
+    const std::size_t tail = _tail.load(std::memory_order_acquire);
+    return tail > head ? std::min(tail - head, capacity()) : 0;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /// Constructs a new element at the end of the queue, and returns false if the queue is full.
+  template <class... Args>
+  bool try_emplace(Args &&...args) {
+    // construct outside of the claimed slot, as other threads cannot progress past it until it is published
+    vec::ElemStorage<T> e;
+    amc::construct_at(e.ptr(), std::forward<Args>(args)...);
+    Slot *slot = claimPush();
+    if (AMC_UNLIKELY(slot == nullptr)) {
+      amc::destroy_at(e.ptr());
+      return false;
+    }
+    amc::relocate_at(e.ptr(), slot->elem.ptr());
+    publishPush(slot);
+    return true;
+  }
+
+  bool try_push(const T &v) { return try_emplace(v); }
+
+  bool try_push(T &&v) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    return tryPushMoved(v, std::is_nothrow_move_constructible<T>());
+  }
+
+  /// Moves at most 'n' elements from 'first' to the end of the queue, stopping at the first failure, and returns the
+  /// number of pushed elements. Elements are claimed and published one by one, as slots are shared with other
+  /// producers.
+  size_type try_push_n(T *first, size_type n) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    size_type nbPushed = 0;
+    while (nbPushed < n && try_push(std::move(first[nbPushed]))) {
+      ++nbPushed;
+    }
+    return nbPushed;
+  }
+
+  /// Moves the first element of the queue to 'out' and pops it, or returns false if the queue is empty.
+  bool try_pop(T &out) noexcept {
+    std::size_t pos = _head.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+      slot = _slots + (pos & _mask);
+      const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1U));
+      if (diff == 0) {
+        if (_head.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = _head.load(std::memory_order_relaxed);
+      }
+    }
+    vec::relocate_assign_at(slot->elem.ptr(), std::addressof(out), amc::is_trivially_relocatable<T>());
+    slot->seq.store(pos + _mask + 1U, std::memory_order_release);
+    return true;
+  }
+
+  /// Moves at most 'n' elements from the front of the queue to the 'n' objects starting at 'first', stopping when the
+  /// queue is empty, and returns the number of popped elements.
+  size_type try_pop_n(T *first, size_type n) noexcept {
+    size_type nbPopped = 0;
+    while (nbPopped < n && try_pop(first[nbPopped])) {
+      ++nbPopped;
+    }
+    return nbPopped;
+  }
+
+ private:
+  static std::size_t RoundCapacity(size_type capacity) {
+    if (AMC_UNLIKELY(capacity == 0 || capacity > (std::numeric_limits<std::size_t>::max() / sizeof(Slot)) / 2U)) {
+      throw std::length_error("Invalid MPMCQueue capacity");
+    }
+    return static_cast<std::size_t>(vec::NextPowerOf2(capacity));
+  }
+
+  /// Moves 'v' directly in the claimed slot, as it cannot throw.
+  bool tryPushMoved(T &v, std::true_type) noexcept {
+    Slot *slot = claimPush();
+    if (AMC_UNLIKELY(slot == nullptr)) {
+      return false;
+    }
+    amc::construct_at(slot->elem.ptr(), std::move(v));
+    publishPush(slot);
+    return true;
+  }
+
+  bool tryPushMoved(T &v, std::false_type) { return try_emplace(std::move(v)); }
+
+  /// Claims the slot of the next position to push, or returns nullptr if the queue is full.
+  Slot *claimPush() noexcept {
+    std::size_t pos = _tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot *slot = _slots + (pos & _mask);
+      const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        if (_tail.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          return slot;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = _tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Makes the element of a claimed slot visible to consumers. Its sequence number is the claimed position.
+  static void publishPush(Slot *slot) noexcept {
+    slot->seq.store(slot->seq.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+  }
+
+  Slot *_slots;
+  void *_buffer;
+  std::size_t _mask;
+
+  // Written by producers
+  alignas(vec::kCacheLineSize) std::atomic<std::size_t> _tail{0};
+
+  // Written by consumers
+  alignas(vec::kCacheLineSize) std::atomic<std::size_t> _head{0};
+};
+
+}  // namespace amc
@@ -28,9 +28,11 @@
 #if defined(__GNUC__)
 #define AMC_LIKELY(x) (__builtin_expect(!!(x), 1))
 #define AMC_UNLIKELY(x) (__builtin_expect(!!(x), 0))
+#define AMC_PREFETCH(addr) __builtin_prefetch(addr)
 #else
 #define AMC_LIKELY(x) (!!(x))
 #define AMC_UNLIKELY(x) (!!(x))
+#define AMC_PREFETCH(addr)
 #endif
 
 #if defined(_MSC_VER)
@@ -40,6 +42,7 @@
 #if _MSVC_LANG >= 201703L
 #define AMC_CXX17 1
 #define AMC_SMALLSET 1
+#define AMC_SMALLMAP 1
 #endif
 
 #if _MSVC_LANG >= 202002L
@@ -58,6 +61,7 @@
 #if __cplusplus >= 201703L
 #define AMC_CXX17 1
 #define AMC_SMALLSET 1
+#define AMC_SMALLMAP 1
 #endif
 
 #if __cplusplus >= 202002L
@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "memory.hpp"
+#include "smallvector.hpp"
+#include "type_traits.hpp"
+
+#ifdef AMC_CXX17
+#include <optional>
+#endif
+
+namespace amc {
+
+template <class, class, class, class>
+class FlatSet;
+
+template <class, class, class, class, class, bool>
+class SortedVectorMap;
+
+template <class, class, uintmax_t, class, class, class>
+class SmallMap;
+
+/// Tag type telling a flat container that the given elements are already sorted and do not contain equivalent
+/// elements, like std::sorted_unique_t of C++23. Input is then trusted and only checked in debug mode.
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+
+#ifdef AMC_CXX17
+inline constexpr sorted_unique_t sorted_unique{};
+#else
+constexpr sorted_unique_t sorted_unique{};
+#endif
+
+/// Algorithms and helper types shared by the containers implemented on top of a sorted vector (FlatSet, FlatMap).
+/// Unless stated otherwise, 'comp' is a comparator of values (and possibly of keys against values) of the vector.
+namespace flat {
+
+#ifdef AMC_CXX17
+/// Common part of node handles of flat containers.
+/// Extracted value is held in an optional, as there is no node to steal from a vector.
+template <class T, class Alloc>
+class NodeHandleBase : private Alloc {
+ public:
+  using allocator_type = Alloc;
+
+  NodeHandleBase() noexcept = default;
+
+  NodeHandleBase(const NodeHandleBase &) = delete;
+  NodeHandleBase(NodeHandleBase &&o) noexcept(std::is_nothrow_move_constructible<T>::value) = default;
+  NodeHandleBase &operator=(const NodeHandleBase &) = delete;
+  NodeHandleBase &operator=(NodeHandleBase &&o) noexcept(std::is_nothrow_move_assignable<T>::value) = default;
+
+  ~NodeHandleBase() = default;
+
+  bool empty() const noexcept { return !_optV.has_value(); }
+  explicit operator bool() const noexcept { return _optV.has_value(); }
+  allocator_type get_allocator() const { return static_cast<allocator_type>(*this); }
+
+  void swap(NodeHandleBase &o) noexcept(std::is_nothrow_move_constructible<T>::value &&
+                                        amc::is_nothrow_swappable<T>::value) {
+    _optV.swap(o._optV);
+  }
+
+ protected:
+  explicit NodeHandleBase(Alloc alloc) : Alloc(alloc) {}
+  explicit NodeHandleBase(T &&v, Alloc alloc = Alloc()) : Alloc(alloc), _optV(std::move(v)) {}
+
+  std::optional<T> _optV;
+};
+
+/// Node handle of set-like flat containers.
+template <class T, class Alloc>
+class SetNodeHandle : public NodeHandleBase<T, Alloc> {
+ public:
+  using value_type = T;
+
+  SetNodeHandle() noexcept = default;
+
+  value_type &value() { return this->_optV.value(); }
+  const value_type &value() const { return this->_optV.value(); }
+
+ private:
+  template <class, class, class, class>
+  friend class amc::FlatSet;
+
+  explicit SetNodeHandle(Alloc alloc) : NodeHandleBase<T, Alloc>(alloc) {}
+  explicit SetNodeHandle(value_type &&v, Alloc alloc = Alloc()) : NodeHandleBase<T, Alloc>(std::move(v), alloc) {}
+};
+
+/// Node handle of map-like flat containers (and of SmallMap). Value is a std::pair<Key, T>.
+template <class Key, class T, class Alloc>
+class MapNodeHandle : public NodeHandleBase<std::pair<Key, T>, Alloc> {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+
+  MapNodeHandle() noexcept = default;
+
+  key_type &key() const { return const_cast<key_type &>(this->_optV.value().first); }
+  mapped_type &mapped() const { return const_cast<mapped_type &>(this->_optV.value().second); }
+
+ private:
+  template <class, class, class, class, class, bool>
+  friend class amc::SortedVectorMap;
+  template <class, class, uintmax_t, class, class, class>
+  friend class amc::SmallMap;
+
+  using Base = NodeHandleBase<std::pair<Key, T>, Alloc>;
+
+  explicit MapNodeHandle(Alloc alloc) : Base(alloc) {}
+  explicit MapNodeHandle(std::pair<Key, T> &&v, Alloc alloc = Alloc()) : Base(std::move(v), alloc) {}
+};
+#endif
+
+/// Adapts a key comparator into a comparator of pairs (and of pairs against keys) on their first member.
+/// It holds a reference to the key comparator, so it is cheap to copy into standard algorithms.
+template <class Pair, class Compare>
+class PairFirstCompare {
+ public:
+  explicit PairFirstCompare(const Compare &comp) noexcept : _comp(comp) {}
+
+  template <class U, class V>
+  bool operator()(const U &lhs, const V &rhs) const {
+    return _comp(KeyOf(lhs), KeyOf(rhs));
+  }
+
+ private:
+  static const typename Pair::first_type &KeyOf(const Pair &p) noexcept { return p.first; }
+
+  template <class K>
+  static const K &KeyOf(const K &k) noexcept {
+    return k;
+  }
+
+  const Compare &_comp;
+};
+
+/// Returns true if 'lhs' and 'rhs' are equivalent according to 'comp'
+template <class Comp, class U, class V>
+inline bool Equivalent(const Comp &comp, const U &lhs, const V &rhs) {
+  return !comp(lhs, rhs) && !comp(rhs, lhs);
+}
+
+/// Computes the position where 'k' should be inserted in sorted range [first, last), making use of 'hint' when it is
+/// correct (that is, when 'k' should be inserted just before or just after it).
+/// Returned bool is false when an element equivalent to 'k' is already present, in which case the returned iterator
+/// points to it.
+template <class It, class Comp, class K>
+std::pair<It, bool> HintPosition(It first, It last, It hint, const Comp &comp, const K &k) {
+  assert(hint >= first && hint <= last);
+  if (hint == last || !comp(*hint, k)) {  // [k, right side) is sorted
+    if (hint == first || !comp(k, *std::prev(hint))) {  // (left side, k] is sorted
+      // hint is correct, but we need to check if equal
+      if (hint != last && !comp(k, *hint)) {
+        // *hint == k, return iterator pointing to value that prevents the insert
+        return std::pair<It, bool>(hint, false);
+      }
+      if (hint != first && !comp(*std::prev(hint), k)) {
+        // *prevIt == k, return iterator pointing to value that prevents the insert
+        return std::pair<It, bool>(std::prev(hint), false);
+      }
+      return std::pair<It, bool>(hint, true);
+    }
+    It prevIt = std::prev(hint);
+    It insertIt = std::lower_bound(first, prevIt, k, comp);
+    return std::pair<It, bool>(insertIt, insertIt == prevIt || comp(k, *insertIt));
+  }
+  It nextIt = std::next(hint);
+  if (nextIt == last || !comp(*nextIt, k)) {  // [*nextIt, right side) is sorted
+    return std::pair<It, bool>(nextIt, nextIt == last || comp(k, *nextIt));
+  }
+  // hint does not bring any valuable information, use standard search
+  It insertIt = std::lower_bound(first, last, k, comp);
+  return std::pair<It, bool>(insertIt, insertIt == last || comp(k, *insertIt));
+}
+
+/// Computes the position where 'k' should be inserted in sorted range [first, last) which may contain equivalent
+/// elements, as close as possible to the position just prior to 'hint'.
+template <class It, class Comp, class K>
+It MultiHintPosition(It first, It last, It hint, const Comp &comp, const K &k) {
+  assert(hint >= first && hint <= last);
+  if (hint != last && comp(*hint, k)) {  // k should be after hint
+    return std::lower_bound(std::next(hint), last, k, comp);
+  }
+  if (hint != first && comp(k, *std::prev(hint))) {  // k should be before hint
+    return std::upper_bound(first, std::prev(hint), k, comp);
+  }
+  return hint;
+}
+
+/// Erases consecutive equivalent elements of sorted vector 'v' from position 'first', keeping the first of each group.
+template <class VecType, class Comp>
+void EraseDuplicates(VecType &v, const Comp &comp, typename VecType::iterator first) {
+  using ValueType = typename VecType::value_type;
+  v.erase(std::unique(first, v.end(),
+                      [&comp](const ValueType &lhs, const ValueType &rhs) { return Equivalent(comp, lhs, rhs); }),
+          v.end());
+}
+
+/// Erases consecutive equivalent elements of sorted vector 'v', keeping the first of each group.
+template <class VecType, class Comp>
+void EraseDuplicates(VecType &v, const Comp &comp) {
+  EraseDuplicates(v, comp, v.begin());
+}
+
+/// Relocates back the elements remaining in a merge buffer into the hole they leave in the merged range.
+/// This is done at the end of the merge, but also if the comparator throws, so that the range always ends up
+/// with valid elements.
+template <class T>
+struct MergeHoleFiller {
+  ~MergeHoleFiller() { amc::uninitialized_relocate(bufFirst, bufLast, holeFirst); }
+
+  T *&bufFirst;
+  T *&bufLast;
+  T *&holeFirst;
+};
+
+/// Merges consecutive sorted ranges [first, middle) and [middle, last) of trivially relocatable elements, thanks to
+/// raw buffer 'buf' able to hold the smallest of both ranges.
+/// Elements are relocated (bitwise copied) instead of being moved and destroyed. Merge is stable.
+template <class T, class Comp>
+void RelocatingMerge(T *first, T *middle, T *last, const Comp &comp, T *buf) {
+  if (middle - first <= last - middle) {
+    // Relocate left range into buffer and fill the hole from its beginning
+    T *bufLast = amc::uninitialized_relocate(first, middle, buf);
+    MergeHoleFiller<T> holeFiller{buf, bufLast, first};
+    while (buf != bufLast && middle != last) {
+      T *src = comp(*middle, *buf) ? middle++ : buf++;
+      amc::relocate_at(src, first++);
+    }
+  } else {
+    // Relocate right range into buffer and fill the hole from its end
+    T *bufLast = amc::uninitialized_relocate(middle, last, buf);
+    MergeHoleFiller<T> holeFiller{buf, bufLast, middle};
+    while (buf != bufLast && middle != first) {
+      T *src = comp(*(bufLast - 1), *(middle - 1)) ? --middle : --bufLast;
+      amc::relocate_at(src, --last);
+    }
+  }
+}
+
+/// Bounds of the sorted runs of a range: run i is [bounds[i], bounds[i + 1]).
+template <class T>
+using RunBounds = amc::SmallVector<T *, 16>;
+
+/// Merges pairs of consecutive sorted runs delimited by 'bounds' with 'merger', until there is only one run left.
+template <class T, class Merger>
+void MergeRuns(RunBounds<T> &bounds, Merger merger) {
+  using SizeType = typename RunBounds<T>::size_type;
+  while (bounds.size() > 2U) {
+    SizeType nbBounds = 0;
+    SizeType runPos = 0;
+    for (; runPos + 2U < bounds.size(); runPos += 2U) {
+      merger(bounds[runPos], bounds[runPos + 1U], bounds[runPos + 2U]);
+      bounds[nbBounds++] = bounds[runPos];
+    }
+    for (; runPos < bounds.size(); ++runPos) {
+      bounds[nbBounds++] = bounds[runPos];
+    }
+    bounds.resize(nbBounds);
+  }
+}
+
+template <class T, class Comp>
+struct InplaceMerger {
+  void operator()(T *first, T *middle, T *last) const { std::inplace_merge(first, middle, last, comp); }
+
+  const Comp &comp;
+};
+
+template <class T, class Comp>
+struct RelocatingMerger {
+  void operator()(T *first, T *middle, T *last) const { RelocatingMerge(first, middle, last, comp, buf); }
+
+  const Comp &comp;
+  T *buf;
+};
+
+template <class T, class Comp>
+void MergeRuns(RunBounds<T> &bounds, const Comp &comp, std::false_type) {
+  MergeRuns(bounds, InplaceMerger<T, Comp>{comp});
+}
+
+/// Uninitialized memory for 'size' elements, used as merge buffer of trivially relocatable elements.
+template <class T>
+class MergeBuffer {
+ public:
+  explicit MergeBuffer(std::size_t size) : _buf(amc::allocator<T>().allocate(size)), _size(size) {}
+
+  MergeBuffer(const MergeBuffer &) = delete;
+  MergeBuffer &operator=(const MergeBuffer &) = delete;
+
+  ~MergeBuffer() { amc::allocator<T>().deallocate(_buf, _size); }
+
+  T *data() const noexcept { return _buf; }
+
+ private:
+  T *_buf;
+  std::size_t _size;
+};
+
+template <class T, class Comp>
+void MergeRuns(RunBounds<T> &bounds, const Comp &comp, std::true_type) {
+  // The smallest of two merged runs cannot be longer than half of the whole range
+  MergeBuffer<T> buf(static_cast<std::size_t>(bounds.back() - bounds.front()) / 2U);
+  MergeRuns(bounds, RelocatingMerger<T, Comp>{comp, buf.data()});
+}
+
+template <class T, class Comp>
+void Merge(T *first, T *middle, T *last, const Comp &comp, std::false_type) {
+  std::inplace_merge(first, middle, last, comp);
+}
+
+template <class T, class Comp>
+void Merge(T *first, T *middle, T *last, const Comp &comp, std::true_type) {
+  if (first != middle && middle != last) {
+    MergeBuffer<T> buf(static_cast<std::size_t>(std::min(middle - first, last - middle)));
+    RelocatingMerge(first, middle, last, comp, buf.data());
+  }
+}
+
+/// Merges consecutive sorted ranges [first, middle) and [middle, last). Merge is stable.
+/// Trivially relocatable elements are relocated instead of being moved.
+template <class T, class Comp>
+void Merge(T *first, T *middle, T *last, const Comp &comp) {
+  Merge(first, middle, last, comp, typename is_trivially_relocatable<T>::type());
+}
+
+/// Minimum average length of the already sorted runs for AdaptiveSort to merge them instead of using std::sort.
+constexpr std::ptrdiff_t kAdaptiveSortMinAverageRunLength = 16;
+
+template <class T, class Comp>
+void FallbackSort(T *first, T *last, const Comp &comp, std::false_type) {
+  std::sort(first, last, comp);
+}
+
+template <class T, class Comp>
+void FallbackSort(T *first, T *last, const Comp &comp, std::true_type) {
+  std::stable_sort(first, last, comp);
+}
+
+/// Sorts [first, last) according to 'comp', taking advantage of already sorted parts of the range.
+/// If the range is made of R ascending runs that are long enough (appended sorted data, mostly sorted data), they
+/// are merged pairwise in O(N.log(R)) (natural merge sort), otherwise it falls back to std::sort.
+/// If 'IsStable' is std::true_type, it falls back to std::stable_sort instead, so that equivalent elements keep
+/// their relative order (merges of runs are always stable).
+/// Trivially relocatable elements are relocated instead of being moved during merges.
+/// Note that contrary to std::sort, it may allocate memory.
+template <class T, class Comp, class IsStable = std::false_type>
+void AdaptiveSort(T *first, T *last, const Comp &comp, IsStable isStable = IsStable()) {
+  const std::ptrdiff_t maxNbRuns = (last - first) / kAdaptiveSortMinAverageRunLength;
+  if (maxNbRuns < 2) {
+    // Too small to be worth it
+    FallbackSort(first, last, comp, isStable);
+    return;
+  }
+  RunBounds<T> bounds;
+  bounds.push_back(first);
+  for (T *it = first; it != last && ++it != last;) {
+    if (comp(*it, *(it - 1))) {
+      if (static_cast<std::ptrdiff_t>(bounds.size()) >= maxNbRuns) {
+        FallbackSort(first, last, comp, isStable);
+        return;
+      }
+      bounds.push_back(it);
+    }
+  }
+  bounds.push_back(last);
+  MergeRuns(bounds, comp, typename is_trivially_relocatable<T>::type());
+}
+
+/// Sorts elements of vector 'v' from 'first' to its end with AdaptiveSort.
+template <class VecType, class Comp, class IsStable = std::false_type>
+void SortTail(VecType &v, typename VecType::iterator first, const Comp &comp, IsStable isStable = IsStable()) {
+  auto *pFirst = v.data() + (first - v.begin());
+  AdaptiveSort(pFirst, v.data() + v.size(), comp, isStable);
+}
+
+/// Tells whether range [first, last) is sorted according to 'comp' without equivalent elements.
+template <class It, class Comp>
+bool IsSortedUnique(It first, It last, const Comp &comp) {
+  using ValueType = typename std::iterator_traits<It>::value_type;
+  return std::adjacent_find(first, last, [&comp](const ValueType &lhs, const ValueType &rhs) {
+           return !comp(lhs, rhs);
+         }) == last;
+}
+
+/// Merges the sorted elements appended from 'insertIt' into the sorted elements before them, removing those which
+/// are equivalent to existing ones.
+/// Only existing elements not smaller than the smallest new one are moved.
+template <class VecType, class Comp>
+void MergeAppendedUnique(VecType &v, const Comp &comp, typename VecType::iterator insertIt) {
+  if (insertIt == v.end()) {
+    return;
+  }
+  // Existing elements equivalent to the smallest new one should be kept first, hence the lower bound
+  auto mergeIt = std::lower_bound(v.begin(), insertIt, *insertIt, comp);
+  std::inplace_merge(mergeIt, insertIt, v.end(), comp);
+  EraseDuplicates(v, comp, mergeIt);
+}
+
+/// Inserts elements of [first, last) in sorted vector 'v', without inserting elements equivalent to existing ones.
+/// New elements are appended, sorted among themselves (with AdaptiveSort) and then merged with the existing
+/// elements not smaller than the smallest new one, which are the only ones to move.
+/// Complexity is O(M + N.log(N)) for N elements inserted into M existing ones, instead of O(M.N) for N single inserts.
+/// With a stable sort ('IsStable' is std::true_type), the first of equivalent new elements is the one inserted.
+template <class VecType, class Comp, class InputIt, class IsStable = std::false_type>
+void InsertRangeUnique(VecType &v, const Comp &comp, InputIt first, InputIt last, IsStable isStable = IsStable()) {
+  auto insertIt = v.insert(v.end(), first, last);
+  SortTail(v, insertIt, comp, isStable);
+  MergeAppendedUnique(v, comp, insertIt);
+}
+
+/// Same as InsertRangeUnique, for a range [first, last) already sorted without equivalent elements.
+template <class VecType, class Comp, class InputIt>
+void InsertSortedRangeUnique(VecType &v, const Comp &comp, InputIt first, InputIt last) {
+  auto insertIt = v.insert(v.end(), first, last);
+  assert(IsSortedUnique(insertIt, v.end(), comp));
+  MergeAppendedUnique(v, comp, insertIt);
+}
+
+/// Inserts elements of [first, last) in sorted vector 'v', keeping equivalent elements in their insertion order.
+/// Same algorithm as InsertRangeUnique, with stable sort and merge.
+template <class VecType, class Comp, class InputIt>
+void InsertRangeEqual(VecType &v, const Comp &comp, InputIt first, InputIt last) {
+  auto insertIt = v.insert(v.end(), first, last);
+  if (insertIt == v.end()) {
+    return;
+  }
+  if (!std::is_sorted(insertIt, v.end(), comp)) {
+    std::stable_sort(insertIt, v.end(), comp);
+  }
+  // Existing elements equivalent to the smallest new one should stay before it, hence the upper bound
+  std::inplace_merge(std::upper_bound(v.begin(), insertIt, *insertIt, comp), insertIt, v.end(), comp);
+}
+
+/// Moves elements of sorted vector 'o' into sorted vector 'v' that are not already present in 'v'.
+/// Both vectors should be sorted according to 'comp', and 'o' should not contain equivalent elements.
+template <class VecType, class Comp>
+void MergeUnique(VecType &v, VecType &o, const Comp &comp) {
+  // Do not use std::inplace_merge to avoid allocating memory if not needed
+  auto first1 = v.begin(), last1 = v.end();
+  auto first2 = o.begin(), last2 = o.end();
+  while (first2 != last2) {
+    if (first1 == last1) {
+      v.insert(last1, std::make_move_iterator(first2), std::make_move_iterator(last2));
+      o.erase(first2, last2);
+      break;
+    }
+    if (comp(*first1, *first2)) {
+      ++first1;
+    } else if (comp(*first2, *first1)) {
+      first1 = std::next(v.insert(first1, std::move(*first2)));
+      last1 = v.end();
+      first2 = o.erase(first2);
+      --last2;
+    } else {
+      // equal
+      ++first1;
+      ++first2;
+    }
+  }
+}
+
+/// Moves elements of 'o' into sorted vector 'v' that are not already present in 'v', one by one.
+/// 'o' does not need to be sorted according to 'comp'.
+template <class VecType, class OVecType, class Comp>
+void MergeUniqueUnsorted(VecType &v, OVecType &o, const Comp &comp) {
+  for (auto oit = o.begin(); oit != o.end();) {
+    auto lbIt = std::lower_bound(v.begin(), v.end(), *oit, comp);
+    if (lbIt == v.end() || comp(*oit, *lbIt)) {
+      v.insert(lbIt, std::move(*oit));
+      oit = o.erase(oit);
+    } else {
+      // equal
+      ++oit;
+    }
+  }
+}
+
+/// Moves all elements of 'o' into sorted vector 'v' accepting equivalent elements, leaving 'o' empty.
+/// Elements from 'o' are placed after the equivalent ones of 'v'.
+template <class VecType, class OVecType, class Comp>
+void MergeEqual(VecType &v, OVecType &o, const Comp &comp) {
+  auto insertIt = v.insert(v.end(), std::make_move_iterator(o.begin()), std::make_move_iterator(o.end()));
+  o.clear();
+  std::stable_sort(insertIt, v.end(), comp);
+  std::inplace_merge(v.begin(), insertIt, v.end(), comp);
+}
+
+}  // namespace flat
+}  // namespace amc
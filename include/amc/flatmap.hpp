@@ -0,0 +1,653 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "flatcommon.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+#ifdef AMC_CXX14
+#include "istransparent.hpp"
+#ifdef AMC_CXX20
+#include <compare>
+#ifdef AMC_CXX23
+#include <ranges>
+#endif
+#endif
+#endif
+namespace amc {
+
+/**
+ * Map which keeps its key-value pairs into a vector sorted by key.
+ * It is the map counterpart of FlatSet, with which it shares the sorted vector algorithms, and offers the same
+ * trade-offs: faster lookups, much faster iteration and smaller memory footprint than standard maps,
+ * at the price of linear-time insertions and erasures and non-stable iterators.
+ *
+ * Differences with std::map:
+ * - value_type is std::pair<Key, T> (and not std::pair<const Key, T>) so that elements can be relocated in the vector.
+ *   Keys should never be modified through iterators, as it would break the ordering of the map.
+ * - iterators are random-access iterators, invalidated by insertions and erasures.
+ *
+ * Use it through its aliases:
+ * - FlatMap does not allow duplicated keys (Multi = false)
+ * - FlatMultiMap allows duplicated keys (Multi = true), equivalent keys are kept in their insertion order.
+ * Keys a, b are considered the same if !Compare(a, b) && !Compare(b, a)
+ */
+template <class Key, class T, class Compare, class Alloc, class VecType, bool Multi>
+class SortedVectorMap : private Compare {
+  using IsMulti = std::integral_constant<bool, Multi>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using difference_type = ptrdiff_t;
+  using size_type = typename VecType::size_type;
+  using iterator = typename VecType::iterator;
+  using const_iterator = typename VecType::const_iterator;
+  using reference = typename VecType::reference;
+  using const_reference = typename VecType::const_reference;
+  using pointer = typename VecType::pointer;
+  using const_pointer = typename VecType::const_pointer;
+  using key_compare = Compare;
+  using allocator_type = Alloc;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static_assert(std::is_same<value_type, typename VecType::value_type>::value,
+                "Vector value type should be std::pair<Key, T>");
+  static_assert(std::is_same<Alloc, typename VecType::allocator_type>::value, "Allocator should match vector's");
+
+  class value_compare {
+   public:
+    bool operator()(const value_type &lhs, const value_type &rhs) const { return comp(lhs.first, rhs.first); }
+
+   protected:
+    friend class SortedVectorMap;
+
+    explicit value_compare(Compare c) : comp(c) {}
+
+    Compare comp;
+  };
+
+#ifdef AMC_CXX17
+  using node_type = flat::MapNodeHandle<Key, T, Alloc>;
+
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+#endif
+
+ private:
+  using insert_result = typename std::conditional<Multi, iterator, std::pair<iterator, bool>>::type;
+#ifdef AMC_CXX17
+  using node_insert_result = typename std::conditional<Multi, iterator, insert_return_type>::type;
+#endif
+
+ public:
+  using trivially_relocatable =
+      typename std::conditional<is_trivially_relocatable<Compare>::value && is_trivially_relocatable<VecType>::value,
+                                std::true_type, std::false_type>::type;
+
+  key_compare key_comp() const { return compRef(); }
+  value_compare value_comp() const { return value_compare(compRef()); }
+  allocator_type get_allocator() const { return _sortedVector.get_allocator(); }
+
+  SortedVectorMap() noexcept(std::is_nothrow_default_constructible<Compare>::value &&
+                             std::is_nothrow_default_constructible<VecType>::value) = default;
+
+  explicit SortedVectorMap(const Compare &comp, const Alloc &alloc = Alloc()) : Compare(comp), _sortedVector(alloc) {}
+
+  explicit SortedVectorMap(const Alloc &alloc) : _sortedVector(alloc) {}
+
+  template <class InputIt>
+  SortedVectorMap(InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(first, last, alloc) {
+    sortAndEraseDuplicates();
+  }
+
+  template <class InputIt>
+  SortedVectorMap(InputIt first, InputIt last, const Alloc &alloc) : SortedVectorMap(first, last, Compare(), alloc) {}
+
+  SortedVectorMap(const SortedVectorMap &o, const Alloc &alloc)
+      : Compare(o.key_comp()), _sortedVector(o._sortedVector, alloc) {}
+
+  SortedVectorMap(SortedVectorMap &&o, const Alloc &alloc)
+      : Compare(o.key_comp()), _sortedVector(std::move(o._sortedVector), alloc) {}
+
+  SortedVectorMap(std::initializer_list<value_type> list, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(alloc) {
+    insert(list.begin(), list.end());
+  }
+
+  SortedVectorMap(std::initializer_list<value_type> list, const Alloc &alloc)
+      : SortedVectorMap(list, Compare(), alloc) {}
+
+#ifdef AMC_NONSTD_FEATURES
+  using vector_type = VecType;
+
+  /// Non standard constructor of a map from a Vector of pairs, stealing its dynamic memory.
+  explicit SortedVectorMap(vector_type &&v, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(std::move(v), alloc) {
+    sortAndEraseDuplicates();
+  }
+
+  SortedVectorMap &operator=(vector_type &&v) {
+    _sortedVector = std::move(v);
+    sortAndEraseDuplicates();
+    return *this;
+  }
+#endif
+
+  SortedVectorMap &operator=(std::initializer_list<value_type> list) {
+    _sortedVector.clear();
+    insert(list.begin(), list.end());
+    return *this;
+  }
+
+  iterator begin() noexcept { return _sortedVector.begin(); }
+  const_iterator begin() const noexcept { return _sortedVector.begin(); }
+  iterator end() noexcept { return _sortedVector.end(); }
+  const_iterator end() const noexcept { return _sortedVector.end(); }
+  const_iterator cbegin() const noexcept { return _sortedVector.begin(); }
+  const_iterator cend() const noexcept { return _sortedVector.end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+  const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+#ifdef AMC_NONSTD_FEATURES
+  pointer data() noexcept { return _sortedVector.data(); }
+  const_pointer data() const noexcept { return _sortedVector.data(); }
+
+  size_type capacity() const noexcept { return _sortedVector.capacity(); }
+  void reserve(size_type size) { _sortedVector.reserve(size); }
+
+  void shrink_to_fit() { _sortedVector.shrink_to_fit(); }
+#endif
+
+  bool empty() const noexcept { return _sortedVector.empty(); }
+  size_type size() const noexcept { return _sortedVector.size(); }
+  size_type max_size() const noexcept { return _sortedVector.max_size(); }
+
+  void clear() noexcept { _sortedVector.clear(); }
+
+  mapped_type &at(const key_type &key) {
+    static_assert(!Multi, "at is only available for maps with unique keys");
+    iterator it = find(key);
+    if (it == end()) throw std::out_of_range("Key not found");
+    return it->second;
+  }
+
+  const mapped_type &at(const key_type &key) const {
+    static_assert(!Multi, "at is only available for maps with unique keys");
+    const_iterator it = find(key);
+    if (it == end()) throw std::out_of_range("Key not found");
+    return it->second;
+  }
+
+  mapped_type &operator[](const key_type &key) { return try_emplace(key).first->second; }
+  mapped_type &operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+
+  insert_result insert(const value_type &v) { return insert_val(v, IsMulti()); }
+
+  insert_result insert(value_type &&v) { return insert_val(std::move(v), IsMulti()); }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  insert_result insert(P &&v) {
+    return insert_val(value_type(std::forward<P>(v)), IsMulti());
+  }
+
+  iterator insert(const_iterator hint, const value_type &v) { return insert_hint(hint, v, IsMulti()); }
+
+  iterator insert(const_iterator hint, value_type &&v) { return insert_hint(hint, std::move(v), IsMulti()); }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  iterator insert(const_iterator hint, P &&v) {
+    return insert_hint(hint, value_type(std::forward<P>(v)), IsMulti());
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    insert_range(first, last, IsMulti());
+  }
+
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+#ifdef AMC_CXX17
+  node_insert_result insert(node_type &&nh) { return insert_node(std::move(nh), IsMulti()); }
+
+  iterator insert(const_iterator hint, node_type &&nh) {
+    if (nh) {
+      iterator retIt = insert(hint, std::move(*nh._optV));
+      nh._optV = std::nullopt;
+      return retIt;
+    }
+    return end();
+  }
+#endif
+
+#ifdef AMC_CXX23
+  template <class R>
+  void insert_range(R &&rg) {
+    insert(std::ranges::begin(rg), std::ranges::end(rg));
+  }
+#endif
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj) {
+    return insert_or_assign_key(key, std::forward<M>(obj));
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&obj) {
+    return insert_or_assign_key(std::move(key), std::forward<M>(obj));
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator hint, const key_type &key, M &&obj) {
+    return insert_or_assign_hint(hint, key, std::forward<M>(obj));
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator hint, key_type &&key, M &&obj) {
+    return insert_or_assign_hint(hint, std::move(key), std::forward<M>(obj));
+  }
+
+  template <class... Args>
+  insert_result emplace(Args &&...args) {
+    return insert_val(value_type(std::forward<Args>(args)...), IsMulti());
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return insert_hint(hint, value_type(std::forward<Args>(args)...), IsMulti());
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, const key_type &key, Args &&...args) {
+    return try_emplace_hint(hint, key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, key_type &&key, Args &&...args) {
+    return try_emplace_hint(hint, std::move(key), std::forward<Args>(args)...);
+  }
+
+  iterator find(const key_type &key) { return mit(static_cast<const SortedVectorMap &>(*this).find(key)); }
+
+  const_iterator find(const key_type &key) const {
+    const_iterator lbIt = lower_bound(key);
+    return lbIt == cend() || compRef()(key, lbIt->first) ? cend() : lbIt;
+  }
+
+  bool contains(const key_type &key) const { return find(key) != end(); }
+
+  size_type count(const key_type &key) const {
+    std::pair<const_iterator, const_iterator> range = equal_range(key);
+    return static_cast<size_type>(range.second - range.first);
+  }
+
+  std::pair<iterator, iterator> equal_range(const key_type &key) {
+    std::pair<const_iterator, const_iterator> range = static_cast<const SortedVectorMap &>(*this).equal_range(key);
+    return std::pair<iterator, iterator>(mit(range.first), mit(range.second));
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+    return equal_range_key(key, IsMulti());
+  }
+
+  iterator lower_bound(const key_type &key) { return std::lower_bound(begin(), end(), key, pairComp()); }
+  const_iterator lower_bound(const key_type &key) const { return std::lower_bound(begin(), end(), key, pairComp()); }
+
+  iterator upper_bound(const key_type &key) { return std::upper_bound(begin(), end(), key, pairComp()); }
+  const_iterator upper_bound(const key_type &key) const { return std::upper_bound(begin(), end(), key, pairComp()); }
+
+#ifdef AMC_CXX14
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator find(const K &key) {
+    return mit(static_cast<const SortedVectorMap &>(*this).find(key));
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator find(const K &key) const {
+    const_iterator lbIt = lower_bound(key);
+    return lbIt == cend() || compRef()(key, lbIt->first) ? cend() : lbIt;
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  bool contains(const K &key) const {
+    return find(key) != end();
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  size_type count(const K &key) const {
+    std::pair<const_iterator, const_iterator> range = equal_range(key);
+    return static_cast<size_type>(range.second - range.first);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  std::pair<iterator, iterator> equal_range(const K &key) {
+    std::pair<const_iterator, const_iterator> range = static_cast<const SortedVectorMap &>(*this).equal_range(key);
+    return std::pair<iterator, iterator>(mit(range.first), mit(range.second));
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+    return equal_range_key(key, IsMulti());
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator lower_bound(const K &key) {
+    return std::lower_bound(begin(), end(), key, pairComp());
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator lower_bound(const K &key) const {
+    return std::lower_bound(begin(), end(), key, pairComp());
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator upper_bound(const K &key) {
+    return std::upper_bound(begin(), end(), key, pairComp());
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator upper_bound(const K &key) const {
+    return std::upper_bound(begin(), end(), key, pairComp());
+  }
+#endif
+
+  size_type erase(const key_type &key) {
+    std::pair<const_iterator, const_iterator> range = equal_range(key);
+    size_type nbErased = static_cast<size_type>(range.second - range.first);
+    _sortedVector.erase(range.first, range.second);
+    return nbErased;
+  }
+
+  iterator erase(iterator position) { return _sortedVector.erase(position); }
+  iterator erase(const_iterator position) { return _sortedVector.erase(position); }
+  iterator erase(const_iterator first, const_iterator last) { return _sortedVector.erase(first, last); }
+
+  bool operator==(const SortedVectorMap &o) const { return _sortedVector == o._sortedVector; }
+  bool operator!=(const SortedVectorMap &o) const { return !(*this == o); }
+
+#ifdef AMC_CXX20
+  auto operator<=>(const SortedVectorMap &o) const { return _sortedVector <=> o._sortedVector; }
+#else
+  bool operator<(const SortedVectorMap &o) const { return _sortedVector < o._sortedVector; }
+
+  bool operator<=(const SortedVectorMap &o) const { return !(o < *this); }
+  bool operator>(const SortedVectorMap &o) const { return o < *this; }
+  bool operator>=(const SortedVectorMap &o) const { return !(*this < o); }
+#endif
+
+  void swap(SortedVectorMap &o) noexcept(noexcept(std::declval<VecType>().swap(std::declval<VecType &>())) &&
+                                         amc::is_nothrow_swappable<Compare>::value) {
+    std::swap(static_cast<Compare &>(*this), static_cast<Compare &>(o));
+    _sortedVector.swap(o._sortedVector);
+  }
+
+#ifdef AMC_CXX17
+  node_type extract(const_iterator position) {
+    iterator it = mit(position);
+    node_type nh(std::move(*it), get_allocator());
+    _sortedVector.erase(it);
+    return nh;
+  }
+
+  node_type extract(const key_type &key) {
+    iterator it = find(key);
+    node_type nh(get_allocator());
+    if (it != end()) {
+      nh._optV = std::move(*it);
+      _sortedVector.erase(it);
+    }
+    return nh;
+  }
+#endif
+
+  /// Moves elements of 'o' into this map. For maps with unique keys, elements whose key is already present are left in
+  /// 'o'.
+  template <class C2, bool Multi2>
+  void merge(SortedVectorMap<Key, T, C2, Alloc, VecType, Multi2> &o) {
+    merge_map(o, IsMulti(), std::integral_constant<bool, std::is_same<Compare, C2>::value && !Multi2>());
+  }
+
+  template <class C2, bool Multi2>
+  void merge(SortedVectorMap<Key, T, C2, Alloc, VecType, Multi2> &&o) {
+    merge(o);
+  }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Get the underlying vector of elements of this map, by returning a newly move constructed vector.
+  vector_type steal_vector() {
+    vector_type ret(std::move(_sortedVector));
+    // Make sure our sorted vector is cleared to avoid unspecified state (not necessarily in order)
+    _sortedVector.clear();
+    return ret;
+  }
+#endif
+
+#ifdef AMC_CXX20
+  template <class Pred>
+  friend size_type erase_if(SortedVectorMap &c, Pred pred) {
+    return erase_if(c._sortedVector, pred);
+  }
+#endif
+
+ private:
+  template <class, class, class, class, class, bool>
+  friend class SortedVectorMap;
+
+  using PairCompare = flat::PairFirstCompare<value_type, Compare>;
+
+  /// Get a mutable iterator from a const_iterator of this map.
+  iterator mit(const_iterator it) noexcept { return begin() + (it - cbegin()); }
+
+  template <class V>
+  std::pair<iterator, bool> insert_val(V &&v, std::false_type) {
+    iterator insertIt = lower_bound(v.first);
+    bool newValue = insertIt == end() || compRef()(v.first, insertIt->first);
+    if (newValue) {
+      insertIt = _sortedVector.insert(insertIt, std::forward<V>(v));
+    }
+    return std::pair<iterator, bool>(insertIt, newValue);
+  }
+
+  template <class V>
+  iterator insert_val(V &&v, std::true_type) {
+    return _sortedVector.insert(upper_bound(v.first), std::forward<V>(v));
+  }
+
+  template <class V>
+  iterator insert_hint(const_iterator hint, V &&v, std::false_type) {
+    std::pair<iterator, bool> pos = flat::HintPosition(begin(), end(), mit(hint), pairComp(), v.first);
+    return pos.second ? _sortedVector.insert(pos.first, std::forward<V>(v)) : pos.first;
+  }
+
+  template <class V>
+  iterator insert_hint(const_iterator hint, V &&v, std::true_type) {
+    return _sortedVector.insert(flat::MultiHintPosition(begin(), end(), mit(hint), pairComp(), v.first),
+                                std::forward<V>(v));
+  }
+
+  template <class InputIt>
+  void insert_range(InputIt first, InputIt last, std::false_type) {
+    // Stable, so that the first occurrence of a duplicated key is kept, as std::map
+    flat::InsertRangeUnique(_sortedVector, pairComp(), first, last, std::true_type());
+  }
+
+  template <class InputIt>
+  void insert_range(InputIt first, InputIt last, std::true_type) {
+    flat::InsertRangeEqual(_sortedVector, pairComp(), first, last);
+  }
+
+#ifdef AMC_CXX17
+  insert_return_type insert_node(node_type &&nh, std::false_type) {
+    insert_return_type irt{end(), false, std::move(nh)};
+    if (irt.node) {
+      std::tie(irt.position, irt.inserted) = insert(std::move(*irt.node._optV));
+      if (irt.inserted) {
+        irt.node._optV = std::nullopt;
+      }
+    }
+    return irt;
+  }
+
+  iterator insert_node(node_type &&nh, std::true_type) {
+    if (nh) {
+      iterator retIt = insert(std::move(*nh._optV));
+      nh._optV = std::nullopt;
+      return retIt;
+    }
+    return end();
+  }
+#endif
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args) {
+    static_assert(!Multi, "try_emplace is only available for maps with unique keys");
+    iterator it = lower_bound(key);
+    if (it != end() && !compRef()(key, it->first)) {
+      return std::pair<iterator, bool>(it, false);
+    }
+    it = _sortedVector.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+    return std::pair<iterator, bool>(it, true);
+  }
+
+  template <class K, class... Args>
+  iterator try_emplace_hint(const_iterator hint, K &&key, Args &&...args) {
+    static_assert(!Multi, "try_emplace is only available for maps with unique keys");
+    std::pair<iterator, bool> pos = flat::HintPosition(begin(), end(), mit(hint), pairComp(), key);
+    if (!pos.second) {
+      return pos.first;
+    }
+    return _sortedVector.emplace(pos.first, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign_key(K &&key, M &&obj) {
+    static_assert(!Multi, "insert_or_assign is only available for maps with unique keys");
+    iterator it = lower_bound(key);
+    if (it != end() && !compRef()(key, it->first)) {
+      it->second = std::forward<M>(obj);
+      return std::pair<iterator, bool>(it, false);
+    }
+    it = _sortedVector.emplace(it, std::forward<K>(key), std::forward<M>(obj));
+    return std::pair<iterator, bool>(it, true);
+  }
+
+  template <class K, class M>
+  iterator insert_or_assign_hint(const_iterator hint, K &&key, M &&obj) {
+    static_assert(!Multi, "insert_or_assign is only available for maps with unique keys");
+    std::pair<iterator, bool> pos = flat::HintPosition(begin(), end(), mit(hint), pairComp(), key);
+    if (!pos.second) {
+      pos.first->second = std::forward<M>(obj);
+      return pos.first;
+    }
+    return _sortedVector.emplace(pos.first, std::forward<K>(key), std::forward<M>(obj));
+  }
+
+  template <class K>
+  std::pair<const_iterator, const_iterator> equal_range_key(const K &key, std::false_type) const {
+    const_iterator first = find(key);
+    const_iterator second = first != end() ? std::next(first) : end();
+    return std::pair<const_iterator, const_iterator>(first, second);
+  }
+
+  template <class K>
+  std::pair<const_iterator, const_iterator> equal_range_key(const K &key, std::true_type) const {
+    return std::equal_range(begin(), end(), key, pairComp());
+  }
+
+  /// Merge into a map with unique keys from a map with unique keys sorted with the same comparator
+  template <class OMap>
+  void merge_map(OMap &o, std::false_type, std::true_type) {
+    flat::MergeUnique(_sortedVector, o._sortedVector, pairComp());
+  }
+
+  /// Merge into a map with unique keys from a map sorted differently or with duplicated keys
+  template <class OMap>
+  void merge_map(OMap &o, std::false_type, std::false_type) {
+    flat::MergeUniqueUnsorted(_sortedVector, o._sortedVector, pairComp());
+  }
+
+  /// Merge into a map accepting duplicated keys
+  template <class OMap, class SameOrder>
+  void merge_map(OMap &o, std::true_type, SameOrder) {
+    flat::MergeEqual(_sortedVector, o._sortedVector, pairComp());
+  }
+
+  void sortAndEraseDuplicates() { sortAndEraseDuplicates(IsMulti()); }
+
+  void sortAndEraseDuplicates(std::false_type) {
+    // Stable, so that the first occurrence of a duplicated key is kept, as std::map
+    flat::SortTail(_sortedVector, _sortedVector.begin(), pairComp(), std::true_type());
+    flat::EraseDuplicates(_sortedVector, pairComp());
+  }
+
+  void sortAndEraseDuplicates(std::true_type) { std::stable_sort(begin(), end(), pairComp()); }
+
+  PairCompare pairComp() const noexcept { return PairCompare(compRef()); }
+
+  Compare &compRef() { return static_cast<Compare &>(*this); }
+  const Compare &compRef() const { return static_cast<const Compare &>(*this); }
+
+  VecType _sortedVector;
+};
+
+template <class Key, class T, class Compare, class Alloc, class VecType, bool Multi>
+inline void swap(SortedVectorMap<Key, T, Compare, Alloc, VecType, Multi> &lhs,
+                 SortedVectorMap<Key, T, Compare, Alloc, VecType, Multi> &rhs) {
+  lhs.swap(rhs);
+}
+
+/// Map with unique keys stored in a sorted vector (see SortedVectorMap).
+template <class Key, class T, class Compare = std::less<Key>, class Alloc = amc::allocator<std::pair<Key, T>>,
+          class VecType = amc::vector<std::pair<Key, T>, Alloc>>
+using FlatMap = SortedVectorMap<Key, T, Compare, Alloc, VecType, false>;
+
+/// Map accepting duplicated keys stored in a sorted vector (see SortedVectorMap).
+template <class Key, class T, class Compare = std::less<Key>, class Alloc = amc::allocator<std::pair<Key, T>>,
+          class VecType = amc::vector<std::pair<Key, T>, Alloc>>
+using FlatMultiMap = SortedVectorMap<Key, T, Compare, Alloc, VecType, true>;
+
+}  // namespace amc
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <type_traits>
+
+#include "flatcommon.hpp"
+#include "smallvector.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+namespace amc {
+
+/// Tag type requesting a flat container to split the sort, merge and duplicates removal of given elements across
+/// several threads (std::thread), which only live for the duration of the call.
+/// A thread is only given a part of at least flat::kParallelMinSizePerThread elements, so it is worth it for large
+/// ranges only (above a million elements). Comparator is called concurrently from several threads.
+/// Number of threads defaults to std::thread::hardware_concurrency().
+class parallel_t {
+ public:
+  explicit constexpr parallel_t(unsigned nbThreads = 0) noexcept : _nbThreads(nbThreads) {}
+
+  unsigned nbThreads() const noexcept {
+    return _nbThreads != 0U ? _nbThreads : std::max(1U, std::thread::hardware_concurrency());
+  }
+
+ private:
+  unsigned _nbThreads;
+};
+
+#ifdef AMC_CXX17
+inline constexpr parallel_t parallel{};
+#else
+constexpr parallel_t parallel{};
+#endif
+
+namespace flat {
+
+/// Minimum number of elements processed by each thread of a parallel algorithm.
+constexpr std::ptrdiff_t kParallelMinSizePerThread = 1 << 15;
+
+/// Number of threads to use for a parallel algorithm on 'size' elements.
+inline unsigned NbThreads(parallel_t par, std::ptrdiff_t size) {
+  const std::ptrdiff_t maxNbThreads = std::max(std::ptrdiff_t(1), size / kParallelMinSizePerThread);
+  return static_cast<unsigned>(std::min(static_cast<std::ptrdiff_t>(par.nbThreads()), maxNbThreads));
+}
+
+/// Runs 'leftTask' in a new thread and 'rightTask' in the calling one, and waits for both to complete.
+/// If one of them throws, exception is rethrown once both have completed (the one of 'rightTask' first).
+template <class LeftTask, class RightTask>
+void ForkJoin(const LeftTask &leftTask, const RightTask &rightTask) {
+  std::exception_ptr leftException;
+  std::thread leftThread([&leftTask, &leftException] {
+    try {
+      leftTask();
+    } catch (...) {
+      leftException = std::current_exception();
+    }
+  });
+  try {
+    rightTask();
+  } catch (...) {
+    leftThread.join();
+    throw;
+  }
+  leftThread.join();
+  if (leftException) {
+    std::rethrow_exception(leftException);
+  }
+}
+
+/// Calls task(i) for each i of [first, last), each call in its own thread (the calling one included).
+template <class Task>
+void ParallelFor(unsigned first, unsigned last, const Task &task) {
+  if (last - first < 2U) {
+    if (first != last) {
+      task(first);
+    }
+    return;
+  }
+  const unsigned middle = first + (last - first) / 2U;
+  ForkJoin([first, middle, &task] { ParallelFor(first, middle, task); },
+           [middle, last, &task] { ParallelFor(middle, last, task); });
+}
+
+/// Pointer to the element at position 'it' of vector 'v'.
+template <class VecType>
+typename VecType::pointer DataAt(VecType &v, typename VecType::iterator it) {
+  return v.data() + (it - v.begin());
+}
+
+/// Merges consecutive sorted ranges [first, middle) and [middle, last) with 'nbThreads' threads. Merge is stable.
+/// The largest range is split at its middle element, which is searched in the other one: once the elements between
+/// both split points are swapped (with a rotation), there are two independent merges left, each one given half of
+/// the threads.
+template <class T, class Comp>
+void ParallelMerge(T *first, T *middle, T *last, const Comp &comp, unsigned nbThreads) {
+  if (first == middle || middle == last) {
+    return;
+  }
+  if (nbThreads < 2U) {
+    Merge(first, middle, last, comp);
+    return;
+  }
+  T *leftSplit;
+  T *rightSplit;
+  if (middle - first >= last - middle) {
+    leftSplit = first + (middle - first) / 2;
+    rightSplit = std::lower_bound(middle, last, *leftSplit, comp);
+  } else {
+    rightSplit = middle + (last - middle) / 2;
+    leftSplit = std::upper_bound(first, middle, *rightSplit, comp);
+  }
+  T *newMiddle = std::rotate(leftSplit, middle, rightSplit);
+  T *rightMiddle = newMiddle + (middle - leftSplit);
+  const unsigned nbLeftThreads = nbThreads / 2U;
+  ForkJoin([=, &comp] { ParallelMerge(first, leftSplit, newMiddle, comp, nbLeftThreads); },
+           [=, &comp] { ParallelMerge(newMiddle, rightMiddle, last, comp, nbThreads - nbLeftThreads); });
+}
+
+/// Sorts [first, last) with 'nbThreads' threads: both halves of the range are sorted with half of the threads each,
+/// and then merged with ParallelMerge. Each thread ends up sorting its part with AdaptiveSort.
+template <class T, class Comp>
+void ParallelSort(T *first, T *last, const Comp &comp, unsigned nbThreads) {
+  if (nbThreads < 2U) {
+    AdaptiveSort(first, last, comp);
+    return;
+  }
+  const unsigned nbLeftThreads = nbThreads / 2U;
+  T *middle = first + (last - first) * static_cast<std::ptrdiff_t>(nbLeftThreads) / nbThreads;
+  ForkJoin([=, &comp] { ParallelSort(first, middle, comp, nbLeftThreads); },
+           [=, &comp] { ParallelSort(middle, last, comp, nbThreads - nbLeftThreads); });
+  ParallelMerge(first, middle, last, comp, nbThreads);
+}
+
+/// Parallel version of SortTail.
+template <class VecType, class Comp>
+void ParallelSortTail(VecType &v, typename VecType::iterator first, const Comp &comp, parallel_t par) {
+  ParallelSort(DataAt(v, first), v.data() + v.size(), comp, NbThreads(par, v.end() - first));
+}
+
+/// Parallel version of EraseDuplicates.
+/// Range is split in chunks, each of them being deduplicated by its own thread, before being moved next to the
+/// previous one. First elements of a chunk equivalent to the last one of the previous chunk are discarded.
+template <class VecType, class Comp>
+void ParallelEraseDuplicates(VecType &v, const Comp &comp, typename VecType::iterator first, parallel_t par) {
+  using Iterator = typename VecType::iterator;
+  using ValueType = typename VecType::value_type;
+
+  const std::ptrdiff_t size = v.end() - first;
+  const unsigned nbChunks = NbThreads(par, size);
+  if (nbChunks < 2U) {
+    EraseDuplicates(v, comp, first);
+    return;
+  }
+  amc::SmallVector<Iterator, 16> chunkFirsts(nbChunks);
+  amc::SmallVector<Iterator, 16> chunkLasts(nbChunks);
+  for (unsigned chunkPos = 0; chunkPos < nbChunks; ++chunkPos) {
+    chunkFirsts[chunkPos] = first + size * static_cast<std::ptrdiff_t>(chunkPos) / nbChunks;
+    chunkLasts[chunkPos] = first + size * static_cast<std::ptrdiff_t>(chunkPos + 1U) / nbChunks;
+  }
+  // Skip duplicates at chunk boundaries before any chunk is modified
+  for (unsigned chunkPos = 1; chunkPos < nbChunks; ++chunkPos) {
+    const ValueType &prevLast = *std::prev(chunkLasts[chunkPos - 1U]);
+    while (chunkFirsts[chunkPos] != chunkLasts[chunkPos] && Equivalent(comp, prevLast, *chunkFirsts[chunkPos])) {
+      ++chunkFirsts[chunkPos];
+    }
+  }
+  ParallelFor(0, nbChunks, [&](unsigned chunkPos) {
+    chunkLasts[chunkPos] = std::unique(
+        chunkFirsts[chunkPos], chunkLasts[chunkPos],
+        [&comp](const ValueType &lhs, const ValueType &rhs) { return Equivalent(comp, lhs, rhs); });
+  });
+  Iterator newLast = chunkLasts[0];
+  for (unsigned chunkPos = 1; chunkPos < nbChunks; ++chunkPos) {
+    if (newLast == chunkFirsts[chunkPos]) {
+      newLast = chunkLasts[chunkPos];
+    } else {
+      newLast = std::move(chunkFirsts[chunkPos], chunkLasts[chunkPos], newLast);
+    }
+  }
+  v.erase(newLast, v.end());
+}
+
+/// Parallel version of InsertRangeUnique.
+template <class VecType, class Comp, class InputIt>
+void ParallelInsertRangeUnique(VecType &v, const Comp &comp, InputIt first, InputIt last, parallel_t par) {
+  auto insertIt = v.insert(v.end(), first, last);
+  if (insertIt == v.end()) {
+    return;
+  }
+  ParallelSortTail(v, insertIt, comp, par);
+  auto mergeIt = std::lower_bound(v.begin(), insertIt, *insertIt, comp);
+  ParallelMerge(DataAt(v, mergeIt), DataAt(v, insertIt), v.data() + v.size(), comp, NbThreads(par, v.end() - mergeIt));
+  ParallelEraseDuplicates(v, comp, mergeIt, par);
+}
+
+/// Parallel version of MergeUnique.
+/// Elements of 'o' are looked up in 'v' by several threads, then those absent from 'v' are appended to it and merged
+/// with ParallelMerge, while the other ones are kept in 'o'.
+template <class VecType, class Comp>
+void ParallelMergeUnique(VecType &v, VecType &o, const Comp &comp, parallel_t par) {
+  const auto oSize = o.end() - o.begin();
+  const unsigned nbChunks = NbThreads(par, oSize + (v.end() - v.begin()));
+  amc::vector<char> isNew(static_cast<typename amc::vector<char>::size_type>(oSize));
+  // Each thread scans linearly 'v' from the lower bound of the first element of its chunk of 'o'
+  ParallelFor(0, nbChunks, [&](unsigned chunkPos) {
+    auto oIt = o.begin() + oSize * static_cast<std::ptrdiff_t>(chunkPos) / nbChunks;
+    auto oLast = o.begin() + oSize * static_cast<std::ptrdiff_t>(chunkPos + 1U) / nbChunks;
+    if (oIt == oLast) {
+      return;
+    }
+    auto vIt = std::lower_bound(v.begin(), v.end(), *oIt, comp);
+    for (; oIt != oLast; ++oIt) {
+      while (vIt != v.end() && comp(*vIt, *oIt)) {
+        ++vIt;
+      }
+      isNew[oIt - o.begin()] = vIt == v.end() || comp(*oIt, *vIt);
+    }
+  });
+  const auto oldSize = v.size();
+  v.reserve(oldSize + static_cast<decltype(oldSize)>(std::count(isNew.begin(), isNew.end(), 1)));
+  auto oKeptLast = o.begin();
+  for (auto oIt = o.begin(); oIt != o.end(); ++oIt) {
+    if (isNew[oIt - o.begin()]) {
+      v.push_back(std::move(*oIt));
+    } else {
+      if (oKeptLast != oIt) {
+        *oKeptLast = std::move(*oIt);
+      }
+      ++oKeptLast;
+    }
+  }
+  o.erase(oKeptLast, o.end());
+  if (v.size() != oldSize) {
+    auto insertIt = v.begin() + oldSize;
+    auto mergeIt = std::lower_bound(v.begin(), insertIt, *insertIt, comp);
+    ParallelMerge(DataAt(v, mergeIt), DataAt(v, insertIt), v.data() + v.size(), comp,
+                  NbThreads(par, v.end() - mergeIt));
+  }
+}
+
+}  // namespace flat
+}  // namespace amc
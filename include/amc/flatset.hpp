@@ -9,13 +9,18 @@
 
 #include "allocator.hpp"
 #include "config.hpp"
+#include "flatcommon.hpp"
+#include "simdfind.hpp"
 #include "type_traits.hpp"
 #include "vector.hpp"
 
+#ifdef AMC_NONSTD_FEATURES
+#include "flatparallel.hpp"
+#endif
+
 #ifdef AMC_CXX14
 #include "istransparent.hpp"
 #ifdef AMC_CXX17
-#include <optional>
 #ifdef AMC_CXX20
 #include <compare>
 #ifdef AMC_CXX23
@@ -69,41 +74,7 @@ class FlatSet : private Compare {
   static_assert(std::is_same<Alloc, typename VecType::allocator_type>::value, "Allocator should match vector's");
 
 #ifdef AMC_CXX17
-  class node_type : private Alloc {
-   public:
-    using value_type = T;
-    using allocator_type = Alloc;
-
-    node_type() noexcept = default;
-
-    node_type(const node_type &) = delete;
-    node_type(node_type &&o) noexcept(std::is_nothrow_move_constructible<value_type>::value) = default;
-    node_type &operator=(const node_type &) = delete;
-    node_type &operator=(node_type &&o) noexcept(std::is_nothrow_move_assignable<value_type>::value) = default;
-
-    ~node_type() = default;
-
-    bool empty() const noexcept { return !_optV.has_value(); }
-    explicit operator bool() const noexcept { return _optV.has_value(); }
-    allocator_type get_allocator() const { return static_cast<allocator_type>(*this); }
-
-    value_type &value() { return _optV.value(); }
-    const value_type &value() const { return _optV.value(); }
-
-    void swap(node_type &o) noexcept(std::is_nothrow_move_constructible<T>::value &&
-                                     amc::is_nothrow_swappable<T>::value) {
-      _optV.swap(o._optV);
-    }
-
-   private:
-    template <class, class, class, class>
-    friend class FlatSet;
-
-    explicit node_type(Alloc alloc) : Alloc(alloc) {}
-    explicit node_type(value_type &&v, Alloc alloc = Alloc()) : Alloc(alloc), _optV(std::move(v)) {}
-
-    std::optional<value_type> _optV;
-  };
+  using node_type = flat::SetNodeHandle<T, Alloc>;
 
   struct insert_return_type {
     iterator position;
@@ -130,7 +101,7 @@ class FlatSet : private Compare {
   template <class InputIt>
   FlatSet(InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
       : Compare(comp), _sortedVector(first, last, alloc) {
-    std::sort(_sortedVector.begin(), _sortedVector.end(), comp);
+    flat::SortTail(_sortedVector, _sortedVector.begin(), comp);
     eraseDuplicates();
   }
 
@@ -148,22 +119,63 @@ class FlatSet : private Compare {
 
   FlatSet(std::initializer_list<value_type> list, const Alloc &alloc) : FlatSet(list, Compare(), alloc) {}
 
+  /// Constructs a FlatSet from a range which is already sorted without equivalent elements, which is not checked
+  /// (except in debug mode). Complexity is linear instead of O(N.log(N)).
+  template <class InputIt>
+  FlatSet(sorted_unique_t, InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(first, last, alloc) {
+    assert(flat::IsSortedUnique(begin(), end(), compRef()));
+  }
+
+  template <class InputIt>
+  FlatSet(sorted_unique_t, InputIt first, InputIt last, const Alloc &alloc)
+      : FlatSet(sorted_unique, first, last, Compare(), alloc) {}
+
+  FlatSet(sorted_unique_t, std::initializer_list<value_type> list, const Compare &comp = Compare(),
+          const Alloc &alloc = Alloc())
+      : FlatSet(sorted_unique, list.begin(), list.end(), comp, alloc) {}
+
+  FlatSet(sorted_unique_t, std::initializer_list<value_type> list, const Alloc &alloc)
+      : FlatSet(sorted_unique, list.begin(), list.end(), Compare(), alloc) {}
+
 #ifdef AMC_NONSTD_FEATURES
   using vector_type = VecType;
 
   /// Non standard constructor of a FlatSet from a Vector, stealing its dynamic memory.
   explicit FlatSet(vector_type &&v, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
       : Compare(comp), _sortedVector(std::move(v), alloc) {
-    std::sort(_sortedVector.begin(), _sortedVector.end(), comp);
+    flat::SortTail(_sortedVector, _sortedVector.begin(), comp);
     eraseDuplicates();
   }
 
+  /// Non standard constructor of a FlatSet from a Vector already sorted without equivalent elements, stealing its
+  /// dynamic memory. Order of elements is not checked (except in debug mode).
+  FlatSet(sorted_unique_t, vector_type &&v, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(std::move(v), alloc) {
+    assert(flat::IsSortedUnique(begin(), end(), compRef()));
+  }
+
+  /// Non standard constructor sorting given elements and removing duplicates with several threads (see parallel_t).
+  template <class InputIt>
+  FlatSet(parallel_t par, InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _sortedVector(first, last, alloc) {
+    flat::ParallelSortTail(_sortedVector, _sortedVector.begin(), comp, par);
+    flat::ParallelEraseDuplicates(_sortedVector, comp, _sortedVector.begin(), par);
+  }
+
   FlatSet &operator=(vector_type &&v) {
     _sortedVector = std::move(v);
-    std::sort(_sortedVector.begin(), _sortedVector.end(), compRef());
+    flat::SortTail(_sortedVector, _sortedVector.begin(), compRef());
     eraseDuplicates();
     return *this;
   }
+
+  /// Replaces the content of this FlatSet by given Vector, which should already be sorted without equivalent elements
+  /// (this is not checked except in debug mode). Equivalent of std::flat_set::replace of C++23.
+  void replace(vector_type &&v) {
+    assert(flat::IsSortedUnique(v.begin(), v.end(), compRef()));
+    _sortedVector = std::move(v);
+  }
 #endif
 
   FlatSet &operator=(std::initializer_list<value_type> list) {
@@ -217,15 +229,30 @@ class FlatSet : private Compare {
 
   template <class InputIt>
   void insert(InputIt first, InputIt last) {
-    miterator insertIt = _sortedVector.insert(_sortedVector.end(), first, last);
-    // sort appended elements only (beginning is already sorted)
-    std::sort(insertIt, mend(), compRef());
-    std::inplace_merge(mbegin(), insertIt, mend(), compRef());
-    eraseDuplicates();
+    flat::InsertRangeUnique(_sortedVector, compRef(), first, last);
   }
 
   void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
 
+  /// Inserts elements of a range which is already sorted without equivalent elements, which is not checked (except
+  /// in debug mode). Elements are merged in linear time with existing ones.
+  template <class InputIt>
+  void insert(sorted_unique_t, InputIt first, InputIt last) {
+    flat::InsertSortedRangeUnique(_sortedVector, compRef(), first, last);
+  }
+
+  void insert(sorted_unique_t, std::initializer_list<value_type> ilist) {
+    insert(sorted_unique, ilist.begin(), ilist.end());
+  }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Non standard range insertion sorting and merging new elements with several threads (see parallel_t).
+  template <class InputIt>
+  void insert(parallel_t par, InputIt first, InputIt last) {
+    flat::ParallelInsertRangeUnique(_sortedVector, compRef(), first, last, par);
+  }
+#endif
+
 #ifdef AMC_CXX17
   insert_return_type insert(node_type &&nh) {
     insert_return_type irt{end(), false, std::move(nh)};
@@ -344,45 +371,15 @@ class FlatSet : private Compare {
 
   template <class C2, typename std::enable_if<!std::is_same<Compare, C2>::value, bool>::type = true>
   void merge(FlatSet<T, C2, Alloc, VecType> &o) {
-    for (miterator oit = o.mbegin(); oit != o.mend();) {
-      miterator lbIt = std::lower_bound(mbegin(), mend(), *oit, compRef());
-      if (lbIt == mend()) {
-        _sortedVector.push_back(std::move(*oit));
-        oit = o._sortedVector.erase(oit);
-      } else if (compRef()(*oit, *lbIt)) {
-        _sortedVector.insert(lbIt, std::move(*oit));
-        oit = o._sortedVector.erase(oit);
-      } else {
-        // equal
-        ++oit;
-      }
-    }
+    flat::MergeUniqueUnsorted(_sortedVector, o._sortedVector, compRef());
   }
 
-  void merge(FlatSet &o) {
-    // Do not use std::inplace_merge to avoid allocating memory if not needed
-    miterator first1 = mbegin(), last1 = mend();
-    miterator first2 = o.mbegin(), last2 = o.mend();
-    while (first2 != last2) {
-      if (first1 == last1) {
-        _sortedVector.insert(last1, std::make_move_iterator(first2), std::make_move_iterator(last2));
-        o._sortedVector.erase(first2, last2);
-        break;
-      }
-      if (compRef()(*first1, *first2)) {
-        ++first1;
-      } else if (compRef()(*first2, *first1)) {
-        first1 = std::next(_sortedVector.insert(first1, std::move(*first2)));
-        last1 = mend();
-        first2 = o._sortedVector.erase(first2);
-        --last2;
-      } else {
-        // equal
-        ++first1;
-        ++first2;
-      }
-    }
-  }
+  void merge(FlatSet &o) { flat::MergeUnique(_sortedVector, o._sortedVector, compRef()); }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Non standard merge looking up and merging elements of 'o' with several threads (see parallel_t).
+  void merge(parallel_t par, FlatSet &o) { flat::ParallelMergeUnique(_sortedVector, o._sortedVector, compRef(), par); }
+#endif
 
   std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
     const_iterator first = find(key);
@@ -390,8 +387,8 @@ class FlatSet : private Compare {
     return std::pair<const_iterator, const_iterator>(first, second);
   }
 
-  const_iterator lower_bound(const_reference v) const { return std::lower_bound(begin(), end(), v, compRef()); }
-  const_iterator upper_bound(const_reference v) const { return std::upper_bound(begin(), end(), v, compRef()); }
+  const_iterator lower_bound(const_reference v) const { return lower_bound_impl(v, IsOrderSearchable()); }
+  const_iterator upper_bound(const_reference v) const { return upper_bound_impl(v, IsOrderSearchable()); }
 
 #ifdef AMC_CXX14
   template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
@@ -433,14 +430,35 @@ class FlatSet : private Compare {
   miterator mbegin() noexcept { return _sortedVector.begin(); }
   miterator mend() noexcept { return _sortedVector.end(); }
 
+  // Arithmetic keys ordered with std::less are searched with a branchless binary search ending with a SIMD scan
+  using IsOrderSearchable = std::integral_constant<bool, simd::is_order_searchable<T, Compare>::value>;
+
+  const_iterator lower_bound_impl(const_reference v, std::false_type) const {
+    return std::lower_bound(begin(), end(), v, compRef());
+  }
+  const_iterator lower_bound_impl(const_reference v, std::true_type) const {
+    const T *first = _sortedVector.data();
+    return begin() + (simd::LowerBound(first, first + _sortedVector.size(), v) - first);
+  }
+
+  const_iterator upper_bound_impl(const_reference v, std::false_type) const {
+    return std::upper_bound(begin(), end(), v, compRef());
+  }
+  const_iterator upper_bound_impl(const_reference v, std::true_type) const {
+    const T *first = _sortedVector.data();
+    return begin() + (simd::UpperBound(first, first + _sortedVector.size(), v) - first);
+  }
+
+  miterator mlower_bound(const_reference v) { return mbegin() + (lower_bound(v) - begin()); }
+
   miterator mfind(const_reference v) {
-    miterator lbIt = std::lower_bound(mbegin(), mend(), v, compRef());
+    miterator lbIt = mlower_bound(v);
     return lbIt == mend() || compRef()(v, *lbIt) ? mend() : lbIt;
   }
 
   template <class V>
   std::pair<iterator, bool> insert_val(V &&v) {
-    miterator insertIt = std::lower_bound(mbegin(), mend(), v, compRef());
+    miterator insertIt = mlower_bound(v);
     bool newValue = insertIt == mend() || compRef()(v, *insertIt);
     if (newValue) {
       insertIt = _sortedVector.insert(insertIt, std::forward<V>(v));
@@ -450,51 +468,14 @@ class FlatSet : private Compare {
 
   template <class V>
   iterator insert_hint(const_iterator hint, V &&v) {
-    const_iterator b = begin();
-    const_iterator e = end();
-    assert(hint >= b && hint <= e);
-    if (hint == e || !compRef()(*hint, v)) {  // [v, right side) is sorted
-      const_iterator prevIt = b == e ? e : std::next(hint, -1);
-      if (hint == b || !compRef()(v, *prevIt)) {  // (left side, v] is sorted
-        // hint is correct, but we need to check if equal
-        if (hint != e && !compRef()(v, *hint)) {
-          // *hint == v, do not insert v, return iterator pointing to value that prevented the insert
-          return hint;
-        }
-        if (hint != b && !compRef()(*prevIt, v)) {
-          // *prevIt == v, do not insert v, return iterator pointing to value that prevented the insert
-          return prevIt;
-        }
-        // hint is correct and element not already present, insert
-        return _sortedVector.insert(hint, std::forward<V>(v));
-      } else {
-        const_iterator insertIt = std::lower_bound(b, prevIt, v, compRef());
-        if (insertIt == prevIt || compRef()(v, *insertIt)) {
-          return _sortedVector.insert(insertIt, std::forward<V>(v));
-        }
-        return insertIt;  // no insert as equal elements
-      }
-    } else {
-      const_iterator nextIt = std::next(hint);
-      if (nextIt == e || !compRef()(*nextIt, v)) {  // [*nextIt, right side) is sorted
-        if (nextIt != e && !compRef()(v, *nextIt)) {
-          return nextIt;
-        }
-        return _sortedVector.insert(nextIt, std::forward<V>(v));
-      }
-    }
-    // hint does not bring any valuable information, use standard insert
-    return insert(std::forward<V>(v)).first;
-  }
-
-  static bool value_equi(const_reference v1, const_reference v2) {
-    return !value_compare()(v1, v2) && !value_compare()(v2, v1);
+    std::pair<const_iterator, bool> pos = flat::HintPosition(begin(), end(), hint, compRef(), v);
+    return pos.second ? _sortedVector.insert(pos.first, std::forward<V>(v)) : pos.first;
   }
 
   Compare &compRef() { return static_cast<Compare &>(*this); }
   const Compare &compRef() const { return static_cast<const Compare &>(*this); }
 
-  void eraseDuplicates() { _sortedVector.erase(std::unique(mbegin(), mend(), value_equi), end()); }
+  void eraseDuplicates() { flat::EraseDuplicates(_sortedVector, compRef()); }
 
   VecType _sortedVector;
 };
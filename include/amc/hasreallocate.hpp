@@ -15,5 +15,34 @@ using has_reallocate_t = decltype(std::declval<T>().reallocate(
 
 template <class T>
 using has_reallocate = is_detected<has_reallocate_t, T>;
+
+/// Detects if allocator provides 'allocate_at_least' method, returning the real number of allocated elements.
+template <class T>
+using has_allocate_at_least_t =
+    decltype(std::declval<T>().allocate_at_least(std::declval<typename T::size_type>()).count);
+
+template <class T>
+using has_allocate_at_least = is_detected<has_allocate_at_least_t, T>;
+
+/// Detects if allocator provides 'reallocate_at_least' method, returning the real number of allocated elements.
+template <class T>
+using has_reallocate_at_least_t = decltype(std::declval<T>()
+                                               .reallocate_at_least(std::declval<typename T::pointer>(),
+                                                                    std::declval<typename T::size_type>(),
+                                                                    std::declval<typename T::size_type>(),
+                                                                    std::declval<typename T::size_type>())
+                                               .count);
+
+template <class T>
+using has_reallocate_at_least = is_detected<has_reallocate_at_least_t, T>;
+
+/// Detects if allocator provides 'try_expand' method, extending a block in place if possible.
+template <class T>
+using has_try_expand_t =
+    decltype(std::declval<T>().try_expand(std::declval<typename T::pointer>(), std::declval<typename T::size_type>(),
+                                          std::declval<typename T::size_type>()));
+
+template <class T>
+using has_try_expand = is_detected<has_try_expand_t, T>;
 }  // namespace vec
 }  // namespace amc
\ No newline at end of file
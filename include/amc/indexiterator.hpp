@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace amc {
+namespace vec {
+
+/// Random access iterator over the elements of a container with random access by index (see SegmentedVector),
+/// made of the container and the index of the element.
+template <class ContainerType, bool IsConst>
+class IndexIterator {
+  using Owner = typename std::conditional<IsConst, const ContainerType, ContainerType>::type;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename ContainerType::value_type;
+  using reference = typename std::conditional<IsConst, const value_type &, value_type &>::type;
+  using pointer = typename std::conditional<IsConst, const value_type *, value_type *>::type;
+
+  IndexIterator() = default;
+
+  IndexIterator(Owner *owner, std::size_t idx) noexcept : _owner(owner), _idx(idx) {}
+
+  /// Conversion from iterator to const_iterator
+  template <bool OIsConst, typename std::enable_if<IsConst && !OIsConst, bool>::type = true>
+  IndexIterator(const IndexIterator<ContainerType, OIsConst> &o) noexcept
+      : _owner(o._owner), _idx(o._idx) {}
+
+  reference operator*() const noexcept { return (*_owner)[_idx]; }
+  pointer operator->() const noexcept { return std::addressof(**this); }
+  reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+  IndexIterator &operator++() noexcept {
+    ++_idx;
+    return *this;
+  }
+  IndexIterator operator++(int) noexcept {
+    IndexIterator ret(*this);
+    ++*this;
+    return ret;
+  }
+  IndexIterator &operator--() noexcept {
+    --_idx;
+    return *this;
+  }
+  IndexIterator operator--(int) noexcept {
+    IndexIterator ret(*this);
+    --*this;
+    return ret;
+  }
+
+  IndexIterator &operator+=(difference_type n) noexcept {
+    _idx = static_cast<std::size_t>(static_cast<difference_type>(_idx) + n);
+    return *this;
+  }
+  IndexIterator &operator-=(difference_type n) noexcept { return *this += -n; }
+
+  IndexIterator operator+(difference_type n) const noexcept { return IndexIterator(*this) += n; }
+  IndexIterator operator-(difference_type n) const noexcept { return IndexIterator(*this) -= n; }
+  friend IndexIterator operator+(difference_type n, const IndexIterator &it) noexcept { return it + n; }
+
+  template <bool OIsConst>
+  difference_type operator-(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return static_cast<difference_type>(_idx) - static_cast<difference_type>(o._idx);
+  }
+
+  // Iterators of the same container only differ by their index
+  template <bool OIsConst>
+  bool operator==(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx == o._idx;
+  }
+  template <bool OIsConst>
+  bool operator!=(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx != o._idx;
+  }
+  template <bool OIsConst>
+  bool operator<(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx < o._idx;
+  }
+  template <bool OIsConst>
+  bool operator<=(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx <= o._idx;
+  }
+  template <bool OIsConst>
+  bool operator>(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx > o._idx;
+  }
+  template <bool OIsConst>
+  bool operator>=(const IndexIterator<ContainerType, OIsConst> &o) const noexcept {
+    return _idx >= o._idx;
+  }
+
+ private:
+  template <class, bool>
+  friend class IndexIterator;
+
+  Owner *_owner = nullptr;
+  std::size_t _idx = 0;
+};
+
+}  // namespace vec
+}  // namespace amc
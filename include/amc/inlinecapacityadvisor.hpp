@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "config.hpp"
+
+namespace amc {
+
+/// Copy of the size profile of a SmallVector type at some point in time (see InlineCapacityAdvisor).
+struct InlineSizeSnapshot {
+  /// Maximum sizes below kNbExactSizes are counted exactly, larger ones by power of 2.
+  static constexpr size_t kNbExactSizes = 64;
+  static constexpr size_t kNbBuckets = kNbExactSizes + 58;
+
+  static size_t SizeBucket(uint64_t maxSize) noexcept {
+    if (maxSize < kNbExactSizes) {
+      return static_cast<size_t>(maxSize);
+    }
+    size_t log2 = 6;
+    for (maxSize >>= 7; maxSize != 0; maxSize >>= 1) {
+      ++log2;
+    }
+    return kNbExactSizes + log2 - 6;
+  }
+
+  /// Largest maximum size counted in given bucket.
+  static uint64_t BucketMaxSize(size_t bucket) noexcept {
+    return bucket < kNbExactSizes ? bucket : (uint64_t(2) << (bucket - kNbExactSizes + 6)) - 1U;
+  }
+
+  /// Number of instances which maximum size did not exceed 'size' (counting whole buckets for large sizes).
+  uint64_t nbInstancesUpTo(uint64_t size) const noexcept {
+    uint64_t nb = 0;
+    for (size_t bucket = 0; bucket < kNbBuckets && BucketMaxSize(bucket) <= size; ++bucket) {
+      nb += maxSizes[bucket];
+    }
+    return nb;
+  }
+
+  /// Smallest inline capacity that would have kept at least 'coverage' (in [0, 1]) of the instances in small state.
+  /// Beyond kNbExactSizes elements, it is rounded up to a power of 2 minus 1.
+  uint64_t suggestedInlineCapacity(double coverage = 0.95) const noexcept {
+    const double minNbInstances = coverage * static_cast<double>(nbInstances);
+    uint64_t nb = 0;
+    for (size_t bucket = 0; bucket < kNbBuckets; ++bucket) {
+      nb += maxSizes[bucket];
+      if (static_cast<double>(nb) >= minNbInstances) {
+        return BucketMaxSize(bucket);
+      }
+    }
+    return BucketMaxSize(kNbBuckets - 1U);
+  }
+
+  uint64_t nbInstances;
+  uint64_t nbInstancesLeftSmall;  ///< Instances which allocated dynamic storage
+  uint64_t maxSizes[kNbBuckets];  ///< Histogram of the maximum sizes reached by the instances
+};
+
+/**
+ * Counters of the destroyed instances of a SmallVector type, updated with relaxed atomics.
+ * Only fed if AMC_SMALLVECTOR_PROFILING is defined (see InlineCapacityAdvisor).
+ */
+class InlineSizeCounters {
+ public:
+  static constexpr size_t kNbBuckets = InlineSizeSnapshot::kNbBuckets;
+
+  void record(uint64_t maxSize, bool leftSmall) noexcept {
+    _nbInstances.fetch_add(1, std::memory_order_relaxed);
+    if (leftSmall) {
+      _nbInstancesLeftSmall.fetch_add(1, std::memory_order_relaxed);
+    }
+    _maxSizes[InlineSizeSnapshot::SizeBucket(maxSize)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  InlineSizeSnapshot snapshot() const noexcept {
+    InlineSizeSnapshot res;
+    res.nbInstances = _nbInstances.load(std::memory_order_relaxed);
+    res.nbInstancesLeftSmall = _nbInstancesLeftSmall.load(std::memory_order_relaxed);
+    for (size_t bucket = 0; bucket < kNbBuckets; ++bucket) {
+      res.maxSizes[bucket] = _maxSizes[bucket].load(std::memory_order_relaxed);
+    }
+    return res;
+  }
+
+  void reset() noexcept {
+    _nbInstances.store(0, std::memory_order_relaxed);
+    _nbInstancesLeftSmall.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> &count : _maxSizes) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> _nbInstances{0};
+  std::atomic<uint64_t> _nbInstancesLeftSmall{0};
+  std::atomic<uint64_t> _maxSizes[kNbBuckets]{};
+};
+
+namespace vec {
+/// Singleton of the size counters of SmallVector type 'VectorType'.
+template <class VectorType>
+struct InlineSizeProfile {
+  static InlineSizeCounters &instance() {
+    static InlineSizeCounters counters;
+    return counters;
+  }
+};
+}  // namespace vec
+
+/// Summary of the size profile of a SmallVector type, with a suggested inline capacity.
+struct InlineCapacityReport {
+  uint64_t nbInstances;
+  uint64_t nbInstancesLeftSmall;
+  uint64_t inlineCapacity;           ///< Current inline capacity
+  double inlineCapacityCoverage;     ///< Ratio of instances fitting in current inline capacity
+  uint64_t suggestedInlineCapacity;  ///< Inline capacity reaching requested coverage
+};
+
+/**
+ * Inline capacity advisor of SmallVector type 'SmallVectorType', from the sizes reached by its instances.
+ *
+ * If AMC_SMALLVECTOR_PROFILING is defined (for the whole program), each SmallVector keeps track of its maximum size
+ * and whether it ever allocated dynamic storage, and records them at destruction in counters per SmallVector type.
+ * It costs a few bytes per SmallVector and relaxed atomic increments at destruction, so it is meant for profiling
+ * builds. Otherwise, statistics stay empty.
+ * A move carries the history of the source to the destination, and moved-from SmallVectors are not recorded (unless
+ * filled again), so relocations by outer containers do not add instances.
+ *
+ * SmallVectors of same type are profiled together. To profile call sites separately, give them distinct growing
+ * policies, like
+ *   struct OrderLinesTag : amc::vec::DynamicGrowingPolicy {};
+ *   using OrderLines = amc::SmallVector<OrderLine, 4, amc::allocator<OrderLine>, uint32_t, OrderLinesTag>;
+ */
+template <class SmallVectorType>
+struct InlineCapacityAdvisor {
+  static InlineSizeSnapshot snapshot() noexcept { return vec::InlineSizeProfile<SmallVectorType>::instance().snapshot(); }
+
+  static void reset() noexcept { vec::InlineSizeProfile<SmallVectorType>::instance().reset(); }
+
+  /// Suggests the inline capacity keeping at least 'coverage' (in [0, 1]) of the instances in small state.
+  static InlineCapacityReport report(double coverage = 0.95) noexcept {
+    const InlineSizeSnapshot stats = snapshot();
+    const uint64_t inlineCapacity = SmallVectorType::kInlineCapacity;
+    InlineCapacityReport res;
+    res.nbInstances = stats.nbInstances;
+    res.nbInstancesLeftSmall = stats.nbInstancesLeftSmall;
+    res.inlineCapacity = inlineCapacity;
+    res.inlineCapacityCoverage =
+        stats.nbInstances == 0
+            ? 1.0
+            : static_cast<double>(stats.nbInstancesUpTo(inlineCapacity)) / static_cast<double>(stats.nbInstances);
+    res.suggestedInlineCapacity = stats.suggestedInlineCapacity(coverage);
+    return res;
+  }
+};
+}  // namespace amc
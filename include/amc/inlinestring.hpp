@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <iterator>
+#include <stdexcept>
+
+#include "config.hpp"
+
+#ifdef AMC_CXX17
+#include <functional>
+#include <string_view>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <stdlib.h>
+#endif
+
+namespace amc {
+
+/**
+ * Immutable string of at most N - 1 chars stored inline in exactly N bytes, designed for short keys (codes,
+ * identifiers) of sorted containers such as FlatSet.
+ *
+ * Bytes after the chars are zeroed, and the last byte stores the number of unused chars, so that it doubles as the
+ * terminating null char of a full string. As all the N bytes are significant, equality and ordering are computed on
+ * 8 bytes words (read in big endian order for ordering) instead of char by char, without branching on the sizes.
+ * Ordering is the same as std::string (lexicographical with chars compared as unsigned char).
+ *
+ * It is trivially copyable, hence trivially relocatable: vectors and FlatSets of InlineStrings shift them with memmove.
+ * N should be a multiple of 8, up to 256.
+ */
+template <uintmax_t N>
+class InlineString {
+  static_assert(N != 0 && N % sizeof(uint64_t) == 0 && N <= 256U,
+                "InlineString size should be a non zero multiple of 8, up to 256");
+
+ public:
+  using value_type = char;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = const char &;
+  using const_reference = const char &;
+  using pointer = const char *;
+  using const_pointer = const char *;
+  using iterator = const char *;
+  using const_iterator = const char *;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type kCapacity = static_cast<size_type>(N - 1U);
+
+  InlineString() noexcept {
+    std::memset(_chars, 0, N);
+    _chars[kCapacity] = static_cast<char>(kCapacity);
+  }
+
+  InlineString(const char *s, size_type n) {
+    if (AMC_UNLIKELY(n > kCapacity)) {
+      throw std::length_error("InlineString cannot be larger than its capacity");
+    }
+    std::memset(_chars, 0, N);
+    if (n != 0) {
+      std::memcpy(_chars, s, n);
+    }
+    _chars[kCapacity] = static_cast<char>(kCapacity - n);
+  }
+
+  InlineString(const char *s) : InlineString(s, std::strlen(s)) {}
+
+#ifdef AMC_CXX17
+  explicit InlineString(std::string_view sv) : InlineString(sv.data(), sv.size()) {}
+
+  operator std::string_view() const noexcept { return std::string_view(data(), size()); }
+#endif
+
+  const_iterator begin() const noexcept { return _chars; }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  const_iterator end() const noexcept { return _chars + size(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  size_type size() const noexcept { return kCapacity - static_cast<unsigned char>(_chars[kCapacity]); }
+  size_type length() const noexcept { return size(); }
+  bool empty() const noexcept { return _chars[kCapacity] == static_cast<char>(kCapacity); }
+  static constexpr size_type capacity() noexcept { return kCapacity; }
+  static constexpr size_type max_size() noexcept { return kCapacity; }
+
+  const char *data() const noexcept { return _chars; }
+  const char *c_str() const noexcept { return _chars; }
+
+  const_reference operator[](size_type pos) const noexcept { return _chars[pos]; }
+
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("InlineString index out of range");
+    }
+    return _chars[pos];
+  }
+
+  const_reference front() const noexcept { return _chars[0]; }
+  const_reference back() const noexcept { return _chars[size() - 1U]; }
+
+  /// Lexicographical comparison, returning a negative value, 0 or a positive value.
+  int compare(const InlineString &o) const noexcept {
+    for (size_type wordPos = 0; wordPos < kNbWords; ++wordPos) {
+      const uint64_t lhs = orderedWord(wordPos);
+      const uint64_t rhs = o.orderedWord(wordPos);
+      if (lhs != rhs) {
+        return lhs < rhs ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  bool less(const InlineString &o) const noexcept {
+    for (size_type wordPos = 0; wordPos < kNbWords; ++wordPos) {
+      const uint64_t lhs = orderedWord(wordPos);
+      const uint64_t rhs = o.orderedWord(wordPos);
+      if (lhs != rhs) {
+        return lhs < rhs;
+      }
+    }
+    return false;
+  }
+
+  bool equals(const InlineString &o) const noexcept {
+    uint64_t diff = 0;
+    for (size_type wordPos = 0; wordPos < kNbWords; ++wordPos) {
+      diff |= word(wordPos) ^ o.word(wordPos);
+    }
+    return diff == 0;
+  }
+
+  bool equals(const char *s, size_type n) const noexcept { return n == size() && std::memcmp(_chars, s, n) == 0; }
+
+ private:
+  static constexpr size_type kNbWords = N / sizeof(uint64_t);
+
+  uint64_t word(size_type wordPos) const noexcept {
+    uint64_t ret;
+    std::memcpy(&ret, _chars + wordPos * sizeof(uint64_t), sizeof(uint64_t));
+    return ret;
+  }
+
+  /// Word whose unsigned integer order is the lexicographical order of its chars.
+  /// The unused chars count, least significant byte of the last word, is inverted so that strings only differing
+  /// by trailing null chars are ordered by size.
+  uint64_t orderedWord(size_type wordPos) const noexcept {
+    return ToBigEndian(word(wordPos)) ^ (wordPos + 1U == kNbWords ? uint64_t(0xFF) : uint64_t(0));
+  }
+
+  static uint64_t ToBigEndian(uint64_t v) noexcept {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#elif defined(__GNUC__)
+    return __builtin_bswap64(v);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    v = ((v & 0x00FF00FF00FF00FFULL) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFULL);
+    v = ((v & 0x0000FFFF0000FFFFULL) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFULL);
+    return (v << 32) | (v >> 32);
+#endif
+  }
+
+  alignas(uint64_t) char _chars[N];
+};
+
+template <uintmax_t N>
+constexpr typename InlineString<N>::size_type InlineString<N>::kCapacity;
+
+template <uintmax_t N>
+constexpr typename InlineString<N>::size_type InlineString<N>::kNbWords;
+
+template <uintmax_t N>
+inline bool operator==(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return lhs.equals(rhs);
+}
+template <uintmax_t N>
+inline bool operator!=(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return !lhs.equals(rhs);
+}
+template <uintmax_t N>
+inline bool operator<(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return lhs.less(rhs);
+}
+template <uintmax_t N>
+inline bool operator<=(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return !rhs.less(lhs);
+}
+template <uintmax_t N>
+inline bool operator>(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return rhs.less(lhs);
+}
+template <uintmax_t N>
+inline bool operator>=(const InlineString<N> &lhs, const InlineString<N> &rhs) noexcept {
+  return !lhs.less(rhs);
+}
+
+template <uintmax_t N>
+inline bool operator==(const InlineString<N> &lhs, const char *rhs) noexcept {
+  return lhs.equals(rhs, std::strlen(rhs));
+}
+template <uintmax_t N>
+inline bool operator==(const char *lhs, const InlineString<N> &rhs) noexcept {
+  return rhs.equals(lhs, std::strlen(lhs));
+}
+template <uintmax_t N>
+inline bool operator!=(const InlineString<N> &lhs, const char *rhs) noexcept {
+  return !(lhs == rhs);
+}
+template <uintmax_t N>
+inline bool operator!=(const char *lhs, const InlineString<N> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+#ifdef AMC_CXX17
+template <uintmax_t N>
+inline bool operator==(const InlineString<N> &lhs, std::string_view rhs) noexcept {
+  return lhs.equals(rhs.data(), rhs.size());
+}
+template <uintmax_t N>
+inline bool operator==(std::string_view lhs, const InlineString<N> &rhs) noexcept {
+  return rhs.equals(lhs.data(), lhs.size());
+}
+template <uintmax_t N>
+inline bool operator!=(const InlineString<N> &lhs, std::string_view rhs) noexcept {
+  return !(lhs == rhs);
+}
+template <uintmax_t N>
+inline bool operator!=(std::string_view lhs, const InlineString<N> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+#endif
+
+template <class Traits, uintmax_t N>
+inline std::basic_ostream<char, Traits> &operator<<(std::basic_ostream<char, Traits> &os, const InlineString<N> &s) {
+  return os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+}  // namespace amc
+
+#ifdef AMC_CXX17
+namespace std {
+template <uintmax_t N>
+struct hash<amc::InlineString<N>> {
+  size_t operator()(const amc::InlineString<N> &s) const noexcept {
+    return std::hash<std::string_view>()(std::string_view(s));
+  }
+};
+}  // namespace std
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "config.hpp"
+
+#if defined(AMC_CXX17) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#define AMC_MEMORY_RESOURCE 1
+#endif
+#endif
+
+#ifdef AMC_MEMORY_RESOURCE
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+
+#include "allocator.hpp"
+#include "monotonicarena.hpp"
+
+namespace amc {
+
+/**
+ * Extension of std::pmr::memory_resource for resources able to resize a block, possibly in place.
+ * MemoryResourceRef uses it for 'reallocate' (and 'try_expand') of containers instead of allocating a new block and
+ * copying the old one into it.
+ */
+class ReallocatingMemoryResource : public std::pmr::memory_resource {
+ public:
+  /// Resizes block 'p' of 'oldSz' bytes (allocated from this resource with given alignment) to 'newSz' bytes,
+  /// keeping its contents. 'p' may be null, in which case it behaves like 'allocate'.
+  void *reallocate(void *p, size_t oldSz, size_t newSz, size_t alignment = alignof(std::max_align_t)) {
+    return do_reallocate(p, oldSz, newSz, alignment);
+  }
+
+  /// Extends block 'p' of 'oldSz' bytes to 'newSz' bytes without moving it, and returns true if it could.
+  bool try_expand(void *p, size_t oldSz, size_t newSz, size_t alignment = alignof(std::max_align_t)) noexcept {
+    return do_try_expand(p, oldSz, newSz, alignment);
+  }
+
+ private:
+  virtual void *do_reallocate(void *p, size_t oldSz, size_t newSz, size_t alignment) = 0;
+
+  virtual bool do_try_expand(void *, size_t, size_t, size_t) noexcept { return false; }
+};
+
+/**
+ * Basic allocator referencing a std::pmr::memory_resource, for amc containers to allocate from the same resources
+ * as std::pmr containers (like a std::pmr::monotonic_buffer_resource per request).
+ * Blocks are aligned as with malloc.
+ *
+ * A plain memory resource cannot resize a block, so 'reallocate' allocates a new block and copies the old one into
+ * it. If the resource is given as a ReallocatingMemoryResource, its 'reallocate' and 'try_expand' are used instead.
+ *
+ * Two references are equal if their resources are (std::pmr::memory_resource::is_equal), so that containers only
+ * exchange their dynamic storage when it is allocated from equal resources.
+ */
+class MemoryResourceRef {
+ public:
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  /// References the default memory resource (std::pmr::get_default_resource()), as std::pmr::polymorphic_allocator.
+  MemoryResourceRef() noexcept : MemoryResourceRef(std::pmr::get_default_resource()) {}
+
+  MemoryResourceRef(std::pmr::memory_resource *resource) noexcept : _resource(resource) {}
+
+  MemoryResourceRef(ReallocatingMemoryResource *resource) noexcept
+      : _resource(resource), _reallocatingResource(resource) {}
+
+  void *allocate(size_t n) { return _resource->allocate(n, kAlignment); }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (_reallocatingResource) {
+      return _reallocatingResource->reallocate(p, oldSz, newSz, kAlignment);
+    }
+    void *newPtr = allocate(newSz);
+    if (p) {
+      std::memcpy(newPtr, p, std::min(oldSz, newSz));
+      deallocate(p, oldSz);
+    }
+    return newPtr;
+  }
+
+  bool try_expand(void *p, size_t oldSz, size_t newSz) noexcept {
+    return _reallocatingResource && _reallocatingResource->try_expand(p, oldSz, newSz, kAlignment);
+  }
+
+  /// As 'free', accepts a null pointer (which memory resources do not).
+  void deallocate(void *p, size_t n) noexcept {
+    if (p) {
+      _resource->deallocate(p, n, kAlignment);
+    }
+  }
+
+  std::pmr::memory_resource *resource() const noexcept { return _resource; }
+
+  bool operator==(const MemoryResourceRef &o) const noexcept {
+    return _resource == o._resource || _resource->is_equal(*o._resource);
+  }
+  bool operator!=(const MemoryResourceRef &o) const noexcept { return !(*this == o); }
+
+ private:
+  std::pmr::memory_resource *_resource;
+  ReallocatingMemoryResource *_reallocatingResource = nullptr;
+};
+
+/**
+ * Memory resource on a MonotonicArena, extending the last allocated block in place on 'reallocate'.
+ * It can be shared by std::pmr containers and amc containers (through MemoryResourceRef), as a faster alternative to
+ * std::pmr::monotonic_buffer_resource for growing vectors.
+ */
+class MonotonicArenaResource : public ReallocatingMemoryResource {
+ public:
+  explicit MonotonicArenaResource(size_t initialChunkSize = MonotonicArena::kDefaultInitialChunkSize) noexcept
+      : _arena(initialChunkSize) {}
+
+  MonotonicArena &arena() noexcept { return _arena; }
+
+  /// Frees all the memory of the arena. All blocks allocated from it are invalidated.
+  void release() noexcept { _arena.release(); }
+
+ private:
+  static bool IsOverAligned(size_t alignment) noexcept { return alignment > MonotonicArena::kAlignment; }
+
+  void *do_allocate(size_t n, size_t alignment) override {
+    if (!IsOverAligned(alignment)) {
+      return _arena.allocate(n);
+    }
+    // Over-aligned blocks are never reclaimed, like most blocks of the arena
+    char *p = static_cast<char *>(_arena.allocate(n + alignment));
+    return p + (alignment - reinterpret_cast<uintptr_t>(p) % alignment) % alignment;
+  }
+
+  void do_deallocate(void *p, size_t n, size_t alignment) override {
+    if (!IsOverAligned(alignment)) {
+      _arena.deallocate(p, n);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &o) const noexcept override { return this == &o; }
+
+  void *do_reallocate(void *p, size_t oldSz, size_t newSz, size_t alignment) override {
+    if (!IsOverAligned(alignment)) {
+      return _arena.reallocate(p, oldSz, newSz);
+    }
+    void *newPtr = do_allocate(newSz, alignment);
+    if (p) {
+      std::memcpy(newPtr, p, std::min(oldSz, newSz));
+    }
+    return newPtr;
+  }
+
+  bool do_try_expand(void *p, size_t oldSz, size_t newSz, size_t alignment) noexcept override {
+    return !IsOverAligned(alignment) && _arena.try_expand(p, oldSz, newSz);
+  }
+
+  MonotonicArena _arena;
+};
+
+/// Standard (STL conformant) allocator carrying a reference to a std::pmr::memory_resource (see MemoryResourceRef).
+/// Default constructed allocators use the default memory resource. Otherwise, containers should be given one, as in
+///   amc::vector<int, amc::pmr_allocator<int>> v{amc::pmr_allocator<int>(&resource)};
+template <class T>
+using pmr_allocator = BasicAllocatorWrapper<T, MemoryResourceRef>;
+}  // namespace amc
+
+#endif
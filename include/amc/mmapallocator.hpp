@@ -0,0 +1,197 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "allocator.hpp"
+#include "config.hpp"
+
+#define AMC_MMAP_ALLOCATOR 1
+
+namespace amc {
+
+/**
+ * Basic allocator serving each block with its own anonymous memory mapping (mmap), rounded up to whole pages.
+ *
+ * Besides the methods of the "basic" allocator concept (see BasicAllocatorWrapper), it provides:
+ *  - allocate_at_least and reallocate_at_least, returning the size of the mapping so that containers can use all its
+ *    pages,
+ *  - try_expand, which extends the mapping in place with mremap when the next pages are free.
+ *    Vectors of non trivially relocatable types attempt it before moving all their elements into a new block.
+ * 'reallocate' never copies the contents of the block, as its pages are remapped (mremap with MREMAP_MAYMOVE).
+ *
+ * Each allocation costs at least a page and system calls, so it should be reserved to large blocks
+ * (see HugeBufferAllocator for an allocator only mapping large blocks).
+ * Only available on Linux (AMC_MMAP_ALLOCATOR is then defined).
+ */
+class MmapAllocator {
+ public:
+  static size_t PageSize() {
+    static const size_t kPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return kPageSize;
+  }
+
+  /// Size of the mapping holding a block of 'n' bytes.
+  static size_t MappedSize(size_t n) {
+    const size_t pageSize = PageSize();
+    return n == 0 ? pageSize : ((n + pageSize - 1U) / pageSize) * pageSize;
+  }
+
+  void *allocate(size_t n) {
+    void *p = mmap(nullptr, MappedSize(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (AMC_UNLIKELY(p == MAP_FAILED)) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  /// Same as allocate, advising the kernel to back the block with transparent huge pages (if supported).
+  void *allocate_huge(size_t n) {
+    void *p = allocate(n);
+#ifdef MADV_HUGEPAGE
+    madvise(p, MappedSize(n), MADV_HUGEPAGE);
+#endif
+    return p;
+  }
+
+  allocation_result<void *> allocate_at_least(size_t n) { return {allocate(n), MappedSize(n)}; }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (p == nullptr) {
+      return allocate(newSz);
+    }
+    const size_t oldMappedSize = MappedSize(oldSz);
+    const size_t newMappedSize = MappedSize(newSz);
+    if (newMappedSize < oldMappedSize) {
+      munmap(static_cast<char *>(p) + newMappedSize, oldMappedSize - newMappedSize);
+      return p;
+    }
+    if (newMappedSize == oldMappedSize) {
+      return p;
+    }
+    // Pages are moved by the kernel if needed, without copying their contents
+    p = mremap(p, oldMappedSize, newMappedSize, MREMAP_MAYMOVE);
+    if (AMC_UNLIKELY(p == MAP_FAILED)) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz) {
+    return {reallocate(p, oldSz, newSz), MappedSize(newSz)};
+  }
+
+  bool try_expand(void *p, size_t oldSz, size_t newSz) {
+    const size_t oldMappedSize = MappedSize(oldSz);
+    const size_t newMappedSize = MappedSize(newSz);
+    // Without MREMAP_MAYMOVE, mremap fails if the mapping cannot be extended at the same address
+    return newMappedSize <= oldMappedSize || mremap(p, oldMappedSize, newMappedSize, 0) != MAP_FAILED;
+  }
+
+  void deallocate(void *p, size_t n) { munmap(p, MappedSize(n)); }
+};
+
+/// Standard (STL conformant) allocator mapping each block in its own pages (see MmapAllocator).
+template <class T>
+using mmap_allocator = BasicAllocatorWrapper<T, MmapAllocator>;
+
+/**
+ * Basic allocator for huge buffers (like multi-GB vectors), serving blocks of at least 'MinMappedSize' bytes with
+ * their own memory mapping (see MmapAllocator) and smaller ones with malloc (see SimpleAllocator).
+ *
+ * Reallocating a mapped block is then O(1) (page table updates with mremap), instead of a copy of the whole buffer
+ * by realloc (when it cannot be extended in place), also avoiding fragmentation of the heap.
+ * Trivially relocatable elements of vectors benefit from it, as they are grown with 'reallocate'.
+ *
+ * If 'UseHugePages' is true, mapped blocks are advised to be backed by transparent huge pages (MADV_HUGEPAGE),
+ * reducing TLB misses on random accesses, at the expense of memory usage.
+ *
+ * Blocks are classified by their size, so 'deallocate' (and 'reallocate') should be given the size of the block (or
+ * any size between the requested one and the one returned by '_at_least' methods), as for any basic allocator.
+ */
+template <size_t MinMappedSize = size_t(1) << 20, bool UseHugePages = false>
+class HugeBufferAllocator {
+ public:
+  static_assert(MinMappedSize > 0, "Minimum size of mapped blocks should be strictly positive");
+
+  static constexpr size_t kMinMappedSize = MinMappedSize;
+
+  static bool IsMapped(size_t n) { return n >= kMinMappedSize; }
+
+  void *allocate(size_t n) { return IsMapped(n) ? Map(n) : SimpleAllocator().allocate(n); }
+
+  allocation_result<void *> allocate_at_least(size_t n) {
+    if (IsMapped(n)) {
+      return {Map(n), MmapAllocator::MappedSize(n)};
+    }
+    return ClampedToHeap(SimpleAllocator().allocate_at_least(n));
+  }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (p == nullptr) {
+      return allocate(newSz);
+    }
+    if (IsMapped(oldSz)) {
+      if (IsMapped(newSz)) {
+        return MmapAllocator().reallocate(p, oldSz, newSz);
+      }
+      return Move(p, oldSz, SimpleAllocator().allocate(newSz), newSz);
+    }
+    if (IsMapped(newSz)) {
+      return Move(p, oldSz, Map(newSz), oldSz);
+    }
+    return SimpleAllocator().reallocate(p, oldSz, newSz);
+  }
+
+  allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz) {
+    if (IsMapped(newSz)) {
+      return {reallocate(p, oldSz, newSz), MmapAllocator::MappedSize(newSz)};
+    }
+    if (p == nullptr || IsMapped(oldSz)) {
+      // Usable size of the heap block is not worth an additional call
+      return {reallocate(p, oldSz, newSz), newSz};
+    }
+    return ClampedToHeap(SimpleAllocator().reallocate_at_least(p, oldSz, newSz));
+  }
+
+  bool try_expand(void *p, size_t oldSz, size_t newSz) {
+    return IsMapped(oldSz) && IsMapped(newSz) && MmapAllocator().try_expand(p, oldSz, newSz);
+  }
+
+  void deallocate(void *p, size_t n) {
+    if (IsMapped(n)) {
+      MmapAllocator().deallocate(p, n);
+    } else {
+      SimpleAllocator().deallocate(p, n);
+    }
+  }
+
+ private:
+  static void *Map(size_t n) { return UseHugePages ? MmapAllocator().allocate_huge(n) : MmapAllocator().allocate(n); }
+
+  /// Usable size of a heap block should not make it considered as a mapped one.
+  static allocation_result<void *> ClampedToHeap(allocation_result<void *> res) {
+    return {res.ptr, std::min(res.count, kMinMappedSize - 1U)};
+  }
+
+  /// Moves the first 'sz' bytes of block 'p' of 'oldSz' bytes to 'newPtr', and frees 'p'.
+  void *Move(void *p, size_t oldSz, void *newPtr, size_t sz) {
+    std::memcpy(newPtr, p, sz);
+    deallocate(p, oldSz);
+    return newPtr;
+  }
+};
+
+/// Standard (STL conformant) allocator for huge buffers (see HugeBufferAllocator).
+template <class T, size_t MinMappedSize = size_t(1) << 20, bool UseHugePages = false>
+using huge_buffer_allocator = BasicAllocatorWrapper<T, HugeBufferAllocator<MinMappedSize, UseHugePages>>;
+}  // namespace amc
+
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "allocator.hpp"
+#include "config.hpp"
+
+namespace amc {
+
+/**
+ * Monotonic arena, modeling the "basic" allocator concept (see BasicAllocatorWrapper).
+ *
+ * Blocks are carved out of chained chunks of memory with a bump pointer, and all freed at once by 'release' (or at
+ * destruction of the arena). 'deallocate' only reclaims the last allocated block, and 'reallocate' (as well as
+ * 'try_expand') extends the last allocated block in place, which is a common pattern for a growing vector.
+ * Other blocks are never reused, so it is best suited for short lived containers, like request scoped ones.
+ *
+ * Chunks are allocated with malloc, with a size doubling from 'initialChunkSize' each time a new one is needed.
+ * All blocks are aligned on kAlignment bytes.
+ *
+ * It is not thread safe, and it can be shared by containers either:
+ *  - through a thread local singleton (see monotonic_allocator), without per container state,
+ *  - through a reference to it carried by each allocator (see arena_allocator).
+ */
+class MonotonicArena {
+ public:
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+  static constexpr size_t kDefaultInitialChunkSize = 1 << 16;
+  static constexpr size_t kMaxBlockSize = std::numeric_limits<size_t>::max() / 4U;
+
+  explicit MonotonicArena(size_t initialChunkSize = kDefaultInitialChunkSize) noexcept
+      : _nextChunkSize(std::max(initialChunkSize, RoundUp(sizeof(ChunkHeader)) + kAlignment)) {}
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+  ~MonotonicArena() { release(); }
+
+  void *allocate(size_t n) {
+    if (AMC_UNLIKELY(n > kMaxBlockSize)) {
+      throw std::bad_alloc();
+    }
+    n = RoundUp(n);
+    if (AMC_UNLIKELY(static_cast<size_t>(_end - _cur) < n)) {
+      newChunk(n);
+    }
+    void *p = _cur;
+    _cur += n;
+    return p;
+  }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (p == nullptr) {
+      return allocate(newSz);
+    }
+    if (RoundUp(newSz) <= RoundUp(oldSz)) {
+      deallocateTail(p, oldSz, newSz);
+      return p;
+    }
+    if (try_expand(p, oldSz, newSz)) {
+      return p;
+    }
+    void *newPtr = allocate(newSz);
+    std::memcpy(newPtr, p, oldSz);
+    return newPtr;
+  }
+
+  bool try_expand(void *p, size_t oldSz, size_t newSz) noexcept {
+    if (RoundUp(newSz) <= RoundUp(oldSz)) {
+      return true;
+    }
+    if (isLast(p, oldSz) && newSz <= kMaxBlockSize &&
+        RoundUp(newSz) <= static_cast<size_t>(_end - static_cast<char *>(p))) {
+      _cur = static_cast<char *>(p) + RoundUp(newSz);
+      return true;
+    }
+    return false;
+  }
+
+  void deallocate(void *p, size_t n) noexcept { deallocateTail(p, n, 0); }
+
+  /// Frees all the chunks of the arena. All blocks allocated from it are invalidated.
+  void release() noexcept {
+    while (_chunks) {
+      ChunkHeader *prev = _chunks->prev;
+      SimpleAllocator().deallocate(_chunks, _chunks->size);
+      _chunks = prev;
+    }
+    _cur = nullptr;
+    _end = nullptr;
+  }
+
+  /// Total size in bytes of the chunks of the arena.
+  size_t chunksSize() const noexcept {
+    size_t sz = 0;
+    for (const ChunkHeader *chunk = _chunks; chunk; chunk = chunk->prev) {
+      sz += chunk->size;
+    }
+    return sz;
+  }
+
+ private:
+  struct ChunkHeader {
+    ChunkHeader *prev;
+    size_t size;
+  };
+
+  static constexpr size_t RoundUp(size_t n) noexcept { return ((n + kAlignment - 1U) / kAlignment) * kAlignment; }
+
+  bool isLast(void *p, size_t n) const noexcept { return p != nullptr && static_cast<char *>(p) + RoundUp(n) == _cur; }
+
+  /// Gives back the bytes of block 'p' of 'n' bytes after its first 'keptSz' ones, if it is the last allocated block.
+  void deallocateTail(void *p, size_t n, size_t keptSz) noexcept {
+    if (isLast(p, n)) {
+      _cur = static_cast<char *>(p) + RoundUp(keptSz);
+    }
+  }
+
+  void newChunk(size_t n) {
+    const size_t headerSize = RoundUp(sizeof(ChunkHeader));
+    const size_t chunkSize = std::max(_nextChunkSize, headerSize + n);
+    ChunkHeader *chunk = static_cast<ChunkHeader *>(SimpleAllocator().allocate(chunkSize));
+    chunk->prev = _chunks;
+    chunk->size = chunkSize;
+    _chunks = chunk;
+    _cur = reinterpret_cast<char *>(chunk) + headerSize;
+    _end = reinterpret_cast<char *>(chunk) + chunkSize;
+    _nextChunkSize = 2U * chunkSize;
+  }
+
+  char *_cur = nullptr;
+  char *_end = nullptr;
+  ChunkHeader *_chunks = nullptr;
+  size_t _nextChunkSize;
+};
+
+/// Singleton giving access to a thread local MonotonicArena, one per 'Tag' type.
+/// Memory is kept until the arena is released (typically at the end of each request) or at thread exit.
+template <class Tag = void>
+struct ThreadLocalMonotonicArena {
+  static MonotonicArena &instance() {
+    static thread_local MonotonicArena arena;
+    return arena;
+  }
+
+  static void release() noexcept { instance().release(); }
+};
+
+/// Basic allocator referencing a MonotonicArena, for containers to carry their arena.
+class MonotonicArenaRef {
+ public:
+  MonotonicArenaRef(MonotonicArena &arena) noexcept : _arena(&arena) {}
+
+  void *allocate(size_t n) { return _arena->allocate(n); }
+  void *reallocate(void *p, size_t oldSz, size_t newSz) { return _arena->reallocate(p, oldSz, newSz); }
+  bool try_expand(void *p, size_t oldSz, size_t newSz) noexcept { return _arena->try_expand(p, oldSz, newSz); }
+  void deallocate(void *p, size_t n) noexcept { _arena->deallocate(p, n); }
+
+  MonotonicArena &arena() const noexcept { return *_arena; }
+
+  bool operator==(const MonotonicArenaRef &o) const noexcept { return _arena == o._arena; }
+  bool operator!=(const MonotonicArenaRef &o) const noexcept { return !(*this == o); }
+
+ private:
+  MonotonicArena *_arena;
+};
+
+/// Standard (STL conformant) allocator on the thread local monotonic arena of given 'Tag'.
+/// Use ThreadLocalMonotonicArena<Tag>::release() to free all its memory once its containers are destroyed.
+template <class T, class Tag = void>
+using monotonic_allocator = BasicAllocatorWrapper<T, BasicSingletonAllocatorAdaptor<ThreadLocalMonotonicArena<Tag>>>;
+
+/// Standard (STL conformant) allocator carrying a reference to a MonotonicArena.
+/// It is not default constructible: containers should be given one, as in
+///   amc::vector<int, amc::arena_allocator<int>> v{amc::arena_allocator<int>(arena)};
+template <class T>
+using arena_allocator = BasicAllocatorWrapper<T, MonotonicArenaRef>;
+}  // namespace amc
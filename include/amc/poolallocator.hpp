@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "allocator.hpp"
+#include "config.hpp"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace amc {
+
+/**
+ * Pool allocator of small blocks, modeling the "basic" allocator concept (see BasicAllocatorWrapper).
+ * It is a singleton (see 'instance'), so that containers using it through BasicSingletonAllocatorAdaptor (see
+ * pool_allocator) do not carry any state.
+ *
+ * Blocks up to kMaxPooledSize bytes are rounded up to a size class (multiples of 16 bytes up to 128 bytes, then
+ * 4 classes per power of 2, like SizeClassGrowingPolicy), and served from free lists of the calling thread, without
+ * any synchronization. Larger blocks are served by malloc.
+ * Blocks of a size class are carved out of slabs of kSlabSize bytes, aligned on their size, whose header tells the
+ * thread owning them. A block freed by another thread is pushed to a lock-free list of its owner, which takes back
+ * all of them once its own free list of this size class is empty.
+ *
+ * 'reallocate' (and 'try_expand') keep the block in place when the new size stays in the same size class, and
+ * '_at_least' methods return the size of the size class, so that containers use all of it.
+ *
+ * Slabs are never given back to the system: memory of a thread is kept when it exits, for a future thread to reuse.
+ */
+class PoolAllocator {
+ public:
+  static constexpr size_t kMaxPooledSize = 1 << 15;
+  static constexpr size_t kSlabSize = 1 << 18;
+  static constexpr size_t kNbSizeClasses = 40;
+
+  static PoolAllocator &instance() {
+    static PoolAllocator pool;
+    return pool;
+  }
+
+  static bool IsPooled(size_t n) noexcept { return n <= kMaxPooledSize; }
+
+  /// Index of the size class of blocks of 'n' bytes (which should be pooled).
+  static size_t SizeClass(size_t n) noexcept {
+    if (n <= 128U) {
+      return n == 0 ? 0 : (n - 1U) / 16U;
+    }
+    size_t step = 32U;
+    size_t nbSteps = 0;
+    while (8U * step < n) {
+      step *= 2U;
+      ++nbSteps;
+    }
+    return 8U + 4U * nbSteps + (n - 1U) / step - 4U;
+  }
+
+  /// Size in bytes of the blocks of given size class.
+  static size_t ClassSize(size_t sizeClass) noexcept {
+    if (sizeClass < 8U) {
+      return 16U * (sizeClass + 1U);
+    }
+    const size_t step = static_cast<size_t>(32U) << ((sizeClass - 8U) / 4U);
+    return step * (5U + (sizeClass - 8U) % 4U);
+  }
+
+  void *allocate(size_t n) {
+    return IsPooled(n) ? LocalCache().allocate(SizeClass(n)) : SimpleAllocator().allocate(n);
+  }
+
+  allocation_result<void *> allocate_at_least(size_t n) {
+    if (IsPooled(n)) {
+      const size_t sizeClass = SizeClass(n);
+      return {LocalCache().allocate(sizeClass), ClassSize(sizeClass)};
+    }
+    return {SimpleAllocator().allocate(n), n};
+  }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (p == nullptr) {
+      return allocate(newSz);
+    }
+    if (!IsPooled(oldSz) && !IsPooled(newSz)) {
+      return SimpleAllocator().reallocate(p, oldSz, newSz);
+    }
+    if (try_expand(p, oldSz, newSz)) {
+      return p;
+    }
+    void *newPtr = allocate(newSz);
+    std::memcpy(newPtr, p, std::min(oldSz, newSz));
+    deallocate(p, oldSz);
+    return newPtr;
+  }
+
+  allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz) {
+    return {reallocate(p, oldSz, newSz), IsPooled(newSz) ? ClassSize(SizeClass(newSz)) : newSz};
+  }
+
+  bool try_expand(void *, size_t oldSz, size_t newSz) noexcept {
+    return IsPooled(oldSz) && IsPooled(newSz) && SizeClass(oldSz) == SizeClass(newSz);
+  }
+
+  void deallocate(void *p, size_t n) noexcept {
+    if (!IsPooled(n)) {
+      SimpleAllocator().deallocate(p, n);
+      return;
+    }
+    FreeBlock *block = static_cast<FreeBlock *>(p);
+    ThreadCache *owner = SlabOf(p)->owner;
+    if (owner == LocalCachePtr()) {
+      owner->push(SizeClass(n), block);
+    } else {
+      owner->pushRemote(SizeClass(n), block);
+    }
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  struct ThreadCache;
+
+  struct SlabHeader {
+    ThreadCache *owner;
+    SlabHeader *next;
+  };
+
+  static constexpr size_t kSlabHeaderSize = 16U;
+
+  static_assert(sizeof(SlabHeader) <= kSlabHeaderSize, "Slab header should keep blocks aligned on 16 bytes");
+
+  struct ThreadCache {
+    ThreadCache() noexcept {
+      for (std::atomic<FreeBlock *> &remoteFreeList : remoteFreeLists) {
+        remoteFreeList.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    void *allocate(size_t sizeClass) {
+      FreeBlock *block = freeLists[sizeClass];
+      if (AMC_UNLIKELY(block == nullptr)) {
+        // Take back all blocks of this size class freed by other threads
+        block = remoteFreeLists[sizeClass].exchange(nullptr, std::memory_order_acquire);
+        if (block == nullptr) {
+          return carve(sizeClass);
+        }
+      }
+      freeLists[sizeClass] = block->next;
+      return block;
+    }
+
+    void push(size_t sizeClass, FreeBlock *block) noexcept {
+      block->next = freeLists[sizeClass];
+      freeLists[sizeClass] = block;
+    }
+
+    void pushRemote(size_t sizeClass, FreeBlock *block) noexcept {
+      // Only pushes are concurrent, the owner takes the whole list at once: no ABA problem
+      std::atomic<FreeBlock *> &head = remoteFreeLists[sizeClass];
+      block->next = head.load(std::memory_order_relaxed);
+      while (!head.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+    }
+
+    void *carve(size_t sizeClass) {
+      const size_t classSize = ClassSize(sizeClass);
+      if (static_cast<size_t>(slabEnds[sizeClass] - slabCurs[sizeClass]) < classSize) {
+        SlabHeader *slab = static_cast<SlabHeader *>(AllocateSlab());
+        slab->owner = this;
+        slab->next = slabs;
+        slabs = slab;
+        slabCurs[sizeClass] = reinterpret_cast<char *>(slab) + kSlabHeaderSize;
+        slabEnds[sizeClass] = reinterpret_cast<char *>(slab) + kSlabSize;
+      }
+      void *p = slabCurs[sizeClass];
+      slabCurs[sizeClass] += classSize;
+      return p;
+    }
+
+    FreeBlock *freeLists[kNbSizeClasses]{};
+    char *slabCurs[kNbSizeClasses]{};
+    char *slabEnds[kNbSizeClasses]{};
+    SlabHeader *slabs = nullptr;
+    ThreadCache *nextOrphan = nullptr;
+    std::atomic<FreeBlock *> remoteFreeLists[kNbSizeClasses];
+  };
+
+  /// Gives back the cache of the thread to the pool at thread exit, for another thread to adopt it.
+  struct CacheGuard {
+    CacheGuard() noexcept { GuardState() = kGuardRegistered; }
+    ~CacheGuard() {
+      if (LocalCachePtr() != nullptr) {
+        instance().orphan(LocalCachePtr());
+      }
+      LocalCachePtr() = nullptr;
+      GuardState() = kGuardDestroyed;
+    }
+  };
+
+  enum : unsigned char { kNoGuard, kGuardRegistered, kGuardDestroyed };
+
+  PoolAllocator() = default;
+
+  static void *AllocateSlab() {
+    void *slab;
+#ifdef _WIN32
+    slab = _aligned_malloc(kSlabSize, kSlabSize);
+#else
+    if (posix_memalign(&slab, kSlabSize, kSlabSize) != 0) {
+      slab = nullptr;
+    }
+#endif
+    if (AMC_UNLIKELY(!slab)) {
+      throw std::bad_alloc();
+    }
+    return slab;
+  }
+
+  static SlabHeader *SlabOf(void *p) noexcept {
+    return reinterpret_cast<SlabHeader *>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(kSlabSize - 1U));
+  }
+
+  static ThreadCache *&LocalCachePtr() noexcept {
+    static thread_local ThreadCache *cache = nullptr;
+    return cache;
+  }
+
+  static unsigned char &GuardState() noexcept {
+    static thread_local unsigned char guardState = kNoGuard;
+    return guardState;
+  }
+
+  static ThreadCache &LocalCache() {
+    ThreadCache *&cache = LocalCachePtr();
+    if (AMC_UNLIKELY(cache == nullptr)) {
+      cache = instance().adopt();
+      if (GuardState() == kNoGuard) {
+        static thread_local CacheGuard guard;
+      }
+    }
+    return *cache;
+  }
+
+  ThreadCache *adopt() {
+    std::lock_guard<std::mutex> lock(_orphansMutex);
+    if (_orphans == nullptr) {
+      return new ThreadCache();
+    }
+    ThreadCache *cache = _orphans;
+    _orphans = cache->nextOrphan;
+    return cache;
+  }
+
+  void orphan(ThreadCache *cache) {
+    std::lock_guard<std::mutex> lock(_orphansMutex);
+    cache->nextOrphan = _orphans;
+    _orphans = cache;
+  }
+
+  std::mutex _orphansMutex;
+  ThreadCache *_orphans = nullptr;
+};
+
+/// Standard (STL conformant) allocator using the thread local pools of PoolAllocator for small blocks.
+/// It is a drop-in replacement of amc::allocator, without any state.
+template <class T>
+using pool_allocator = BasicAllocatorWrapper<T, BasicSingletonAllocatorAdaptor<PoolAllocator>>;
+}  // namespace amc
@@ -0,0 +1,534 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "fixedcapacityvector.hpp"
+#include "indexiterator.hpp"
+#include "memory.hpp"
+#include "smallvector.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "vectorcommon.hpp"
+
+namespace amc {
+namespace vec {
+
+/**
+ * Implementation of the ring buffers, independent from their storage.
+ * Elements are stored in a power of 2 number of slots, given by 'Derived' (with 'slots()' and 'mask()', the number of
+ * slots minus 1), starting at slot '_head' and wrapping around the end of the slots.
+ * 'Derived' is called when pushing an element to a full ring, with 'emplace_back_full' and 'emplace_front_full'.
+ */
+template <class Derived, class T, class SizeType>
+class RingImpl {
+ public:
+  using value_type = T;
+  using size_type = SizeType;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = IndexIterator<Derived, false>;
+  using const_iterator = IndexIterator<Derived, true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  /// Contiguous range of elements, as a pointer to its first element and its number of elements.
+  using array_range = std::pair<pointer, size_type>;
+  using const_array_range = std::pair<const_pointer, size_type>;
+
+  size_type size() const noexcept { return _size; }
+  bool empty() const noexcept { return _size == 0; }
+  bool full() const noexcept { return _size == derived().capacity(); }
+
+  reference operator[](size_type idx) noexcept {
+    assert(idx < _size);
+    return *slot(idx);
+  }
+  const_reference operator[](size_type idx) const noexcept {
+    assert(idx < _size);
+    return *slot(idx);
+  }
+
+  reference at(size_type idx) {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+  const_reference at(size_type idx) const {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[_size - 1U]; }
+  const_reference back() const noexcept { return (*this)[_size - 1U]; }
+
+  iterator begin() noexcept { return iterator(&derived(), 0); }
+  const_iterator begin() const noexcept { return const_iterator(&derived(), 0); }
+  iterator end() noexcept { return iterator(&derived(), _size); }
+  const_iterator end() const noexcept { return const_iterator(&derived(), _size); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  /// First contiguous range of elements, starting with front().
+  array_range array_one() noexcept { return array_range(derived().slots() + _head, sizeOne()); }
+  const_array_range array_one() const noexcept { return const_array_range(derived().slots() + _head, sizeOne()); }
+
+  /// Second contiguous range of elements (empty if elements do not wrap around the end of the slots), ending with
+  /// back().
+  array_range array_two() noexcept { return array_range(derived().slots(), static_cast<size_type>(_size - sizeOne())); }
+  const_array_range array_two() const noexcept {
+    return const_array_range(derived().slots(), static_cast<size_type>(_size - sizeOne()));
+  }
+
+  template <class... Args>
+  reference emplace_back(Args &&...args) {
+    if (AMC_UNLIKELY(full())) {
+      return derived().emplace_back_full(std::forward<Args>(args)...);
+    }
+    T *pos = slot(_size);
+    amc::construct_at(pos, std::forward<Args>(args)...);
+    ++_size;
+    return *pos;
+  }
+
+  template <class... Args>
+  reference emplace_front(Args &&...args) {
+    if (AMC_UNLIKELY(full())) {
+      return derived().emplace_front_full(std::forward<Args>(args)...);
+    }
+    const size_type head = static_cast<size_type>((_head - 1U) & derived().mask());
+    T *pos = derived().slots() + head;
+    amc::construct_at(pos, std::forward<Args>(args)...);
+    _head = head;
+    ++_size;
+    return *pos;
+  }
+
+  void push_back(const T &v) { emplace_back(v); }
+  void push_back(T &&v) { emplace_back(std::move(v)); }
+  void push_front(const T &v) { emplace_front(v); }
+  void push_front(T &&v) { emplace_front(std::move(v)); }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    --_size;
+    amc::destroy_at(slot(_size));
+  }
+
+  void pop_front() noexcept {
+    assert(!empty());
+    amc::destroy_at(derived().slots() + _head);
+    _head = static_cast<size_type>((_head + 1U) & derived().mask());
+    --_size;
+  }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Pops the front element and returns it.
+  T pop_front_val() {
+    T v(std::move(front()));
+    pop_front();
+    return v;
+  }
+#endif
+
+  void clear() noexcept {
+    amc::destroy_n(derived().slots() + _head, sizeOne());
+    amc::destroy_n(derived().slots(), static_cast<size_type>(_size - sizeOne()));
+    _head = 0;
+    _size = 0;
+  }
+
+  template <class ODerived, class OSizeType>
+  bool operator==(const RingImpl<ODerived, T, OSizeType> &o) const {
+    return _size == o.size() && std::equal(begin(), end(), o.begin());
+  }
+  template <class ODerived, class OSizeType>
+  bool operator!=(const RingImpl<ODerived, T, OSizeType> &o) const {
+    return !(*this == o);
+  }
+
+ protected:
+  RingImpl() noexcept = default;
+
+  Derived &derived() noexcept { return static_cast<Derived &>(*this); }
+  const Derived &derived() const noexcept { return static_cast<const Derived &>(*this); }
+
+  T *slot(size_type idx) noexcept { return derived().slots() + ((_head + idx) & derived().mask()); }
+  const T *slot(size_type idx) const noexcept { return derived().slots() + ((_head + idx) & derived().mask()); }
+
+  size_type sizeOne() const noexcept {
+    return _size == 0 ? 0 : static_cast<size_type>(std::min<uintmax_t>(_size, uintmax_t(derived().mask()) + 1U - _head));
+  }
+
+  /// Relocates all elements, in order, to 'dest', leaving this ring empty.
+  void relocateTo(T *dest) noexcept {
+    const size_type sizeOne = this->sizeOne();
+    (void)amc::uninitialized_relocate_n(derived().slots() + _head, sizeOne, dest);
+    (void)amc::uninitialized_relocate_n(derived().slots(), static_cast<size_type>(_size - sizeOne), dest + sizeOne);
+    _head = 0;
+    _size = 0;
+  }
+
+  void checkIndex(size_type idx) const {
+    if (idx >= _size) {
+      throw std::out_of_range("Ring index out of range");
+    }
+  }
+
+  size_type _head = 0;
+  size_type _size = 0;
+};
+
+}  // namespace vec
+
+/**
+ * Ring buffer (double ended queue) whose maximum number of elements cannot exceed N, stored inline as the elements
+ * of FixedCapacityVector, without any dynamic memory allocation.
+ * Elements can be pushed and popped at both ends in O(1). They are stored in a power of 2 number of slots (N rounded up
+ * to a power of 2), so that indexes wrap around with a mask.
+ *
+ * Elements are contiguous in at most two ranges, given by 'array_one' and 'array_two', for bulk processing.
+ *
+ * If new element is about to be pushed in a full ring, behavior is controlled by 'GrowingPolicy', as for
+ * FixedCapacityVector:
+ *  - ExceptionGrowingPolicy: throw 'std::out_of_range' exception (default)
+ *  - UncheckedGrowingPolicy: assert check (nothing is done in Release, invoking undefined behavior, abort will be
+ *                            called in Debug).
+ */
+template <class T, uintmax_t N, class GrowingPolicy = vec::ExceptionGrowingPolicy,
+          class SizeType = typename vec::SmallestSizeType<N>::type>
+class FixedCapacityRing : public vec::RingImpl<FixedCapacityRing<T, N, GrowingPolicy, SizeType>, T, SizeType> {
+  using Base = vec::RingImpl<FixedCapacityRing<T, N, GrowingPolicy, SizeType>, T, SizeType>;
+
+  static_assert(N != 0, "FixedCapacityRing should have a strictly positive capacity");
+
+  static constexpr uintmax_t kNbSlots = vec::NextPowerOf2(N);
+
+  static_assert(kNbSlots - 1U <= static_cast<uintmax_t>(std::numeric_limits<SizeType>::max()),
+                "SizeType should be able to index all slots");
+
+ public:
+  using trivially_relocatable = typename is_trivially_relocatable<T>::type;
+  using typename Base::size_type;
+
+  FixedCapacityRing() noexcept = default;
+
+  explicit FixedCapacityRing(size_type count) : FixedCapacityRing() {
+    GrowingPolicy::Check(count, N);
+    while (this->size() < count) {
+      this->emplace_back();
+    }
+  }
+
+  FixedCapacityRing(std::initializer_list<T> list) : FixedCapacityRing() {
+    GrowingPolicy::Check(list.size(), N);
+    for (const T &v : list) {
+      this->push_back(v);
+    }
+  }
+
+  FixedCapacityRing(const FixedCapacityRing &o) : FixedCapacityRing() {
+    for (const T &v : o) {
+      this->push_back(v);
+    }
+  }
+
+  FixedCapacityRing(FixedCapacityRing &&o) noexcept(vec::is_move_construct_nothrow<T>::value) {
+    this->_size = o._size;
+    o.relocateTo(slots());
+  }
+
+  FixedCapacityRing &operator=(const FixedCapacityRing &o) {
+    if (AMC_LIKELY(this != &o)) {
+      this->clear();
+      for (const T &v : o) {
+        this->push_back(v);
+      }
+    }
+    return *this;
+  }
+
+  FixedCapacityRing &operator=(FixedCapacityRing &&o) noexcept(vec::is_move_construct_nothrow<T>::value) {
+    if (AMC_LIKELY(this != &o)) {
+      this->clear();
+      this->_size = o._size;
+      o.relocateTo(slots());
+    }
+    return *this;
+  }
+
+  ~FixedCapacityRing() { this->clear(); }
+
+  static constexpr size_type capacity() noexcept { return static_cast<size_type>(N); }
+  static constexpr size_type max_size() noexcept { return capacity(); }
+
+  void swap(FixedCapacityRing &o) noexcept(vec::is_move_construct_nothrow<T>::value) {
+    FixedCapacityRing tmp(std::move(o));
+    o = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+ private:
+  friend Base;
+
+  T *slots() noexcept { return _elems[0].ptr(); }
+  const T *slots() const noexcept { return _elems[0].ptr(); }
+
+  static constexpr size_type mask() noexcept { return static_cast<size_type>(kNbSlots - 1U); }
+
+  template <class... Args>
+  T &emplace_back_full(Args &&...args) {
+    GrowingPolicy::Check(static_cast<uintmax_t>(this->size()) + 1U, N);
+    T *pos = this->slot(this->_size);
+    amc::construct_at(pos, std::forward<Args>(args)...);
+    ++this->_size;
+    return *pos;
+  }
+
+  template <class... Args>
+  T &emplace_front_full(Args &&...args) {
+    GrowingPolicy::Check(static_cast<uintmax_t>(this->size()) + 1U, N);
+    const size_type head = static_cast<size_type>((this->_head - 1U) & mask());
+    T *pos = slots() + head;
+    amc::construct_at(pos, std::forward<Args>(args)...);
+    this->_head = head;
+    ++this->_size;
+    return *pos;
+  }
+
+  vec::ElemStorage<T> _elems[kNbSlots];
+};
+
+template <class T, uintmax_t N, class G, class S>
+inline void swap(FixedCapacityRing<T, N, G, S> &lhs,
+                 FixedCapacityRing<T, N, G, S> &rhs) noexcept(vec::is_move_construct_nothrow<T>::value) {
+  lhs.swap(rhs);
+}
+
+/**
+ * Ring buffer (double ended queue) growing as needed, with a power of 2 capacity so that indexes wrap around with a
+ * mask. Elements can be pushed and popped at both ends in O(1) (amortized for pushes).
+ *
+ * When full, its capacity grows as given by 'GrowingPolicy' (1.5 factor by default, see SmallVector), rounded up to
+ * a power of 2. The two contiguous ranges of elements (see 'array_one' and 'array_two') are then relocated to the
+ * new storage, with memcpy for trivially relocatable types. As for amc::vector, the pushed element is constructed
+ * before growing, so it may refer to an element of the ring.
+ */
+template <class T, class Alloc = amc::allocator<T>, class SizeType = uint32_t,
+          class GrowingPolicy = vec::DynamicGrowingPolicy>
+class RingVector : public vec::RingImpl<RingVector<T, Alloc, SizeType, GrowingPolicy>, T, SizeType>,
+                   private Alloc {
+  using Base = vec::RingImpl<RingVector<T, Alloc, SizeType, GrowingPolicy>, T, SizeType>;
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+ public:
+  using trivially_relocatable = std::true_type;
+  using allocator_type = Alloc;
+  // Allocator is a private base as well, make sure that its types and operators are not picked up
+  using typename Base::value_type;
+  using typename Base::size_type;
+  using typename Base::difference_type;
+  using typename Base::reference;
+  using typename Base::const_reference;
+  using typename Base::pointer;
+  using typename Base::const_pointer;
+  using Base::operator==;
+  using Base::operator!=;
+
+  RingVector() noexcept(std::is_nothrow_default_constructible<Alloc>::value) = default;
+
+  explicit RingVector(const Alloc &alloc) noexcept : Alloc(alloc) {}
+
+  RingVector(std::initializer_list<T> list, const Alloc &alloc = Alloc()) : RingVector(alloc) {
+    reserve(static_cast<size_type>(list.size()));
+    for (const T &v : list) {
+      this->push_back(v);
+    }
+  }
+
+  // Allocator is propagated on copy and move construction, as for amc vectors
+  RingVector(const RingVector &o) : RingVector(o.get_allocator()) {
+    reserve(o.size());
+    for (const T &v : o) {
+      this->push_back(v);
+    }
+  }
+
+  RingVector(RingVector &&o) noexcept : Alloc(o.get_allocator()) { steal(o); }
+
+  // Allocator is not propagated on assignment, as for amc vectors
+  RingVector &operator=(const RingVector &o) {
+    if (AMC_LIKELY(this != &o)) {
+      this->clear();
+      reserve(o.size());
+      for (const T &v : o) {
+        this->push_back(v);
+      }
+    }
+    return *this;
+  }
+
+  // Storage of 'o' is stolen only if allocators are equal, otherwise elements are moved one by one
+  RingVector &operator=(RingVector &&o) noexcept(std::is_empty<Alloc>::value) {
+    if (AMC_LIKELY(this != &o)) {
+      this->clear();
+      if (vec::AreEqualAllocators(get_allocator(), o.get_allocator())) {
+        deallocate();
+        steal(o);
+      } else {
+        reserve(o.size());
+        for (T &v : o) {
+          this->push_back(std::move(v));
+        }
+      }
+    }
+    return *this;
+  }
+
+  ~RingVector() {
+    this->clear();
+    deallocate();
+  }
+
+  allocator_type get_allocator() const noexcept { return *this; }
+
+  size_type capacity() const noexcept { return _capa; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(std::numeric_limits<size_type>::max() / 2U + 1U);
+  }
+
+  /// Allocates storage for at least 'capacity' elements (rounded up to a power of 2).
+  void reserve(size_type capacity) {
+    if (_capa < capacity) {
+      reallocate(RoundCapacity(capacity));
+    }
+  }
+
+  void shrink_to_fit() {
+    const size_type capa = this->empty() ? 0 : RoundCapacity(this->size());
+    if (capa < _capa) {
+      reallocate(capa);
+    }
+  }
+
+  void swap(RingVector &o) noexcept {
+    // Allocators are not swapped: as for amc vectors, they should be equal
+    assert(vec::AreEqualAllocators(get_allocator(), o.get_allocator()));
+    std::swap(_elems, o._elems);
+    std::swap(_capa, o._capa);
+    std::swap(this->_head, o._head);
+    std::swap(this->_size, o._size);
+  }
+
+ private:
+  friend Base;
+
+  T *slots() noexcept { return _elems; }
+  const T *slots() const noexcept { return _elems; }
+
+  size_type mask() const noexcept { return static_cast<size_type>(_capa - 1U); }
+
+  static size_type RoundCapacity(uintmax_t capacity) {
+    const uintmax_t capa = vec::NextPowerOf2(capacity);
+    if (AMC_UNLIKELY(capa > static_cast<uintmax_t>(std::numeric_limits<size_type>::max()))) {
+      throw std::overflow_error("Attempt to use more elements that size_type can support. Use a larger size_type");
+    }
+    return static_cast<size_type>(capa);
+  }
+
+  void steal(RingVector &o) noexcept {
+    _elems = amc::exchange(o._elems, nullptr);
+    _capa = amc::exchange(o._capa, 0);
+    this->_head = amc::exchange(o._head, 0);
+    this->_size = amc::exchange(o._size, 0);
+  }
+
+  void deallocate() noexcept {
+    if (_elems) {
+      AllocTraits::deallocate(*this, _elems, _capa);
+    }
+  }
+
+  /// Relocates the elements, in order, to a new storage of 'capa' elements (a power of 2, or 0 if empty).
+  void reallocate(size_type capa) {
+    T *elems = capa == 0 ? nullptr : AllocTraits::allocate(*this, capa);
+    const size_type size = this->size();
+    if (size != 0) {
+      this->relocateTo(elems);
+    }
+    deallocate();
+    _elems = elems;
+    _capa = capa;
+    this->_size = size;
+  }
+
+  void growForPush() {
+    reallocate(RoundCapacity(vec::SafeNextCapacity<GrowingPolicy>(_capa, static_cast<uintmax_t>(this->size()) + 1U,
+                                                                  false, sizeof(T))));
+  }
+
+  template <class... Args>
+  T &emplace_back_full(Args &&...args) {
+    // construct before possible invalidation from grow of references in constructor arguments
+    vec::ElemStorage<T> e;
+    amc::construct_at(e.ptr(), std::forward<Args>(args)...);
+    try {
+      growForPush();
+    } catch (...) {
+      amc::destroy_at(e.ptr());
+      throw;
+    }
+    T *pos = this->slot(this->_size);
+    amc::relocate_at(e.ptr(), pos);
+    ++this->_size;
+    return *pos;
+  }
+
+  template <class... Args>
+  T &emplace_front_full(Args &&...args) {
+    vec::ElemStorage<T> e;
+    amc::construct_at(e.ptr(), std::forward<Args>(args)...);
+    try {
+      growForPush();
+    } catch (...) {
+      amc::destroy_at(e.ptr());
+      throw;
+    }
+    this->_head = mask();
+    T *pos = slots() + this->_head;
+    amc::relocate_at(e.ptr(), pos);
+    ++this->_size;
+    return *pos;
+  }
+
+  T *_elems = nullptr;
+  size_type _capa = 0;
+};
+
+template <class T, class A, class S, class G>
+inline void swap(RingVector<T, A, S, G> &lhs, RingVector<T, A, S, G> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+}  // namespace amc
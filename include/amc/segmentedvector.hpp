@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "indexiterator.hpp"
+#include "memory.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+namespace amc {
+namespace vec {
+
+constexpr unsigned Log2(std::size_t n) { return n <= 1U ? 0U : 1U + Log2(n / 2U); }
+
+}  // namespace vec
+
+/**
+ * Vector storing its elements in chunks of 'ChunkSize' elements, referenced by a table of chunks.
+ * Growing allocates a new chunk and never moves existing elements: references, pointers and iterators to the
+ * elements stay valid on push_back (as for std::deque), and there is no latency spike from relocating a huge buffer.
+ * Elements are not contiguous, but indexing stays O(1), with a shift and a mask if 'ChunkSize' is a power of 2.
+ *
+ * It is meant for append-only logs: elements can only be added and removed at the end. 'flatten' relocates all of
+ * them into a contiguous amc::vector once the log is complete.
+ *
+ * Chunks are allocated from 'Alloc' (one chunk per 'allocate' call), and kept on 'clear' and 'pop_back' to be reused.
+ * Call 'shrink_to_fit' to free unused chunks.
+ */
+template <class T, std::size_t ChunkSize, class Alloc = amc::allocator<T>>
+class SegmentedVector : private Alloc {
+  static_assert(ChunkSize != 0, "Chunks should have at least one element");
+
+  using ChunkAllocTraits = std::allocator_traits<Alloc>;
+  using ChunkTableAlloc = typename ChunkAllocTraits::template rebind_alloc<T *>;
+  using ChunkTable = amc::vector<T *, ChunkTableAlloc>;
+
+  static constexpr bool kIsChunkSizePowerOf2 = (ChunkSize & (ChunkSize - 1U)) == 0;
+  static constexpr unsigned kChunkShift = vec::Log2(ChunkSize);
+
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = vec::IndexIterator<SegmentedVector, false>;
+  using const_iterator = vec::IndexIterator<SegmentedVector, true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type kChunkSize = ChunkSize;
+
+  SegmentedVector() noexcept(std::is_nothrow_default_constructible<Alloc>::value) = default;
+
+  explicit SegmentedVector(const Alloc &alloc) noexcept : Alloc(alloc), _chunks(ChunkTableAlloc(alloc)) {}
+
+  explicit SegmentedVector(size_type count, const Alloc &alloc = Alloc()) : SegmentedVector(alloc) { resize(count); }
+
+  SegmentedVector(size_type count, const T &v, const Alloc &alloc = Alloc()) : SegmentedVector(alloc) {
+    resize(count, v);
+  }
+
+  template <class InputIt, typename std::enable_if<!std::is_integral<InputIt>::value, bool>::type = true>
+  SegmentedVector(InputIt first, InputIt last, const Alloc &alloc = Alloc()) : SegmentedVector(alloc) {
+    append(first, last);
+  }
+
+  SegmentedVector(std::initializer_list<T> list, const Alloc &alloc = Alloc()) : SegmentedVector(alloc) {
+    append(list.begin(), list.end());
+  }
+
+  // Allocator is propagated on copy and move construction, as for amc vectors
+  SegmentedVector(const SegmentedVector &o) : SegmentedVector(o.get_allocator()) {
+    reserve(o._size);
+    // Copy chunk by chunk, keeping the size up to date for the destructor if a copy throws
+    for (size_type chunkIdx = 0; _size < o._size; ++chunkIdx) {
+      const size_type n = std::min(ChunkSize, o._size - _size);
+      amc::uninitialized_copy_n(o._chunks[chunkIdx], n, _chunks[chunkIdx]);
+      _size += n;
+    }
+  }
+
+  SegmentedVector(SegmentedVector &&o) noexcept
+      : Alloc(o.get_allocator()), _chunks(std::move(o._chunks)), _size(amc::exchange(o._size, 0)) {}
+
+  SegmentedVector &operator=(const SegmentedVector &o) {
+    if (AMC_LIKELY(this != &o)) {
+      // Elements are copied into our own chunks, allocated from our allocator
+      clear();
+      reserve(o._size);
+      append(o.begin(), o.end());
+    }
+    return *this;
+  }
+
+  // Allocator is not propagated on move assignment, as for amc vectors: chunks of 'o' are stolen only if allocators
+  // are equal, otherwise elements are moved one by one into our own chunks.
+  SegmentedVector &operator=(SegmentedVector &&o) noexcept(std::is_empty<Alloc>::value) {
+    if (AMC_LIKELY(this != &o)) {
+      clear();
+      if (vec::AreEqualAllocators(get_allocator(), o.get_allocator())) {
+        freeChunks(0);
+        _chunks = std::move(o._chunks);
+        _size = amc::exchange(o._size, 0);
+      } else {
+        reserve(o._size);
+        for (T &elem : o) {
+          emplace_back(std::move(elem));
+        }
+      }
+    }
+    return *this;
+  }
+
+  SegmentedVector &operator=(std::initializer_list<T> list) {
+    clear();
+    append(list.begin(), list.end());
+    return *this;
+  }
+
+  ~SegmentedVector() {
+    clear();
+    freeChunks(0);
+  }
+
+  allocator_type get_allocator() const noexcept { return *this; }
+
+  size_type size() const noexcept { return _size; }
+  size_type capacity() const noexcept { return static_cast<size_type>(_chunks.size()) * ChunkSize; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(std::numeric_limits<typename ChunkTable::size_type>::max()) * ChunkSize;
+  }
+  bool empty() const noexcept { return _size == 0; }
+
+  reference operator[](size_type idx) noexcept {
+    assert(idx < _size);
+    return _chunks[ChunkIndex(idx)][IndexInChunk(idx)];
+  }
+  const_reference operator[](size_type idx) const noexcept {
+    assert(idx < _size);
+    return _chunks[ChunkIndex(idx)][IndexInChunk(idx)];
+  }
+
+  reference at(size_type idx) {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+  const_reference at(size_type idx) const {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[_size - 1U]; }
+  const_reference back() const noexcept { return (*this)[_size - 1U]; }
+
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  iterator end() noexcept { return iterator(this, _size); }
+  const_iterator end() const noexcept { return const_iterator(this, _size); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  /// Number of chunks, and access to their elements, for loops processing a contiguous range at a time.
+  /// Chunk 'chunkIdx' holds the elements of indexes [chunkIdx * ChunkSize, (chunkIdx + 1) * ChunkSize).
+  size_type nb_chunks() const noexcept { return (_size + ChunkSize - 1U) / ChunkSize; }
+  pointer chunk_data(size_type chunkIdx) noexcept { return _chunks[chunkIdx]; }
+  const_pointer chunk_data(size_type chunkIdx) const noexcept { return _chunks[chunkIdx]; }
+  size_type chunk_size(size_type chunkIdx) const noexcept {
+    return std::min(ChunkSize, _size - chunkIdx * ChunkSize);
+  }
+
+  /// Allocates the chunks needed to hold 'capacity' elements.
+  void reserve(size_type capacity) {
+    const size_type nbChunks = (capacity + ChunkSize - 1U) / ChunkSize;
+    if (_chunks.size() < nbChunks) {
+      if (AMC_UNLIKELY(capacity > max_size())) {
+        throw std::length_error("SegmentedVector capacity exceeds max_size()");
+      }
+      _chunks.reserve(static_cast<typename ChunkTable::size_type>(nbChunks));
+      while (_chunks.size() < nbChunks) {
+        addChunk();
+      }
+    }
+  }
+
+  /// Frees the chunks which do not hold any element.
+  void shrink_to_fit() {
+    freeChunks(nb_chunks());
+    _chunks.shrink_to_fit();
+  }
+
+  /// Destroys all elements, keeping the chunks for reuse.
+  void clear() noexcept {
+    for (size_type chunkIdx = 0, nbChunks = nb_chunks(); chunkIdx < nbChunks; ++chunkIdx) {
+      amc::destroy_n(_chunks[chunkIdx], chunk_size(chunkIdx));
+    }
+    _size = 0;
+  }
+
+  template <class... Args>
+  reference emplace_back(Args &&...args) {
+    if (_size == capacity()) {
+      addChunk();
+    }
+    T *pos = _chunks[ChunkIndex(_size)] + IndexInChunk(_size);
+    amc::construct_at(pos, std::forward<Args>(args)...);
+    ++_size;
+    return *pos;
+  }
+
+  void push_back(const T &v) { emplace_back(v); }
+  void push_back(T &&v) { emplace_back(std::move(v)); }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    --_size;
+    amc::destroy_at(_chunks[ChunkIndex(_size)] + IndexInChunk(_size));
+  }
+
+  template <class InputIt, typename std::enable_if<!std::is_integral<InputIt>::value, bool>::type = true>
+  void append(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  void resize(size_type count) {
+    if (count < _size) {
+      shrinkTo(count);
+    } else {
+      reserve(count);
+      while (_size < count) {
+        emplace_back();
+      }
+    }
+  }
+
+  void resize(size_type count, const T &v) {
+    if (count < _size) {
+      shrinkTo(count);
+    } else {
+      reserve(count);
+      while (_size < count) {
+        emplace_back(v);
+      }
+    }
+  }
+
+  /// Relocates all the elements into a contiguous vector (with one allocation), leaving this SegmentedVector empty
+  /// without any chunk.
+  amc::vector<T, Alloc> flatten() {
+    using VecType = amc::vector<T, Alloc>;
+    VecType res(get_allocator());
+    if (AMC_UNLIKELY(_size > static_cast<size_type>(std::numeric_limits<typename VecType::size_type>::max()))) {
+      throw std::overflow_error("SegmentedVector too large to be flattened into a vector");
+    }
+    res.reserve(static_cast<typename VecType::size_type>(_size));
+    T *dest = res.data();
+    for (size_type chunkIdx = 0, nbChunks = nb_chunks(); chunkIdx < nbChunks; ++chunkIdx) {
+      const size_type n = chunk_size(chunkIdx);
+      (void)amc::uninitialized_relocate_n(_chunks[chunkIdx], n, dest);
+      dest += n;
+    }
+    res.setSize(static_cast<typename VecType::size_type>(_size));
+    _size = 0;
+    freeChunks(0);
+    _chunks.shrink_to_fit();
+    return res;
+  }
+
+  void swap(SegmentedVector &o) noexcept {
+    // Allocators are not swapped: as for amc vectors, they should be equal
+    assert(vec::AreEqualAllocators(get_allocator(), o.get_allocator()));
+    _chunks.swap(o._chunks);
+    std::swap(_size, o._size);
+  }
+
+  friend void swap(SegmentedVector &lhs, SegmentedVector &rhs) noexcept { lhs.swap(rhs); }
+
+  bool operator==(const SegmentedVector &o) const { return _size == o._size && std::equal(begin(), end(), o.begin()); }
+  bool operator!=(const SegmentedVector &o) const { return !(*this == o); }
+
+ private:
+  static size_type ChunkIndex(size_type idx) noexcept {
+    return kIsChunkSizePowerOf2 ? idx >> kChunkShift : idx / ChunkSize;
+  }
+
+  static size_type IndexInChunk(size_type idx) noexcept {
+    return kIsChunkSizePowerOf2 ? idx & (ChunkSize - 1U) : idx % ChunkSize;
+  }
+
+  void checkIndex(size_type idx) const {
+    if (idx >= _size) {
+      throw std::out_of_range("SegmentedVector index out of range");
+    }
+  }
+
+  /// Appends a new chunk to the table. Its slot is added first, so that the chunk does not leak if the table cannot
+  /// grow.
+  void addChunk() {
+    _chunks.push_back(nullptr);
+    try {
+      _chunks.back() = ChunkAllocTraits::allocate(*this, ChunkSize);
+    } catch (...) {
+      _chunks.pop_back();
+      throw;
+    }
+  }
+
+  /// Frees chunks starting from 'firstChunkIdx', which should not hold any element.
+  void freeChunks(size_type firstChunkIdx) noexcept {
+    while (_chunks.size() > firstChunkIdx) {
+      ChunkAllocTraits::deallocate(*this, _chunks.back(), ChunkSize);
+      _chunks.pop_back();
+    }
+  }
+
+  void shrinkTo(size_type count) noexcept {
+    while (_size > count) {
+      pop_back();
+    }
+  }
+
+  ChunkTable _chunks;
+  size_type _size = 0;
+};
+
+}  // namespace amc
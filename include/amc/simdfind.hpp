@@ -0,0 +1,349 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "config.hpp"
+
+#if defined(__AVX2__)
+#define AMC_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AMC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if (defined(AMC_AVX2) || defined(AMC_SSE2)) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace amc {
+
+/// Searches of a value in a contiguous sequence of elements, vectorized with SSE2 / AVX2 instructions when the
+/// target supports them (selected at compile time), with a scalar fallback otherwise.
+namespace simd {
+
+/// Tells whether elements of type T can be compared with a bitwise equality: integral, enum and pointer types
+/// whose size is 1, 2, 4 or 8 bytes.
+template <class T>
+struct is_scannable
+    : std::integral_constant<bool, (std::is_integral<T>::value || std::is_enum<T>::value ||
+                                    std::is_pointer<T>::value) &&
+                                       (sizeof(T) == 1U || sizeof(T) == 2U || sizeof(T) == 4U || sizeof(T) == 8U)> {};
+
+/// Tells whether equivalence of two T according to Compare (!comp(a, b) && !comp(b, a)) is exactly bitwise equality,
+/// in which case a search by equivalence can be replaced by FindEqual.
+/// This is the case for scannable types ordered by the standard std::less and std::greater comparators.
+/// Floating point types are excluded on purpose, as NaN is equivalent to every value with std::less.
+template <class T, class Compare>
+struct is_equality_scannable
+    : std::integral_constant<bool, is_scannable<T>::value && (std::is_same<Compare, std::less<T>>::value ||
+                                                              std::is_same<Compare, std::greater<T>>::value
+#ifdef AMC_CXX14
+                                                              || std::is_same<Compare, std::less<>>::value ||
+                                                              std::is_same<Compare, std::greater<>>::value
+#endif
+                                                              )> {
+};
+
+/// Tells whether a range of T sorted according to Compare can be searched with LowerBound and UpperBound:
+/// arithmetic types (except bool) of size 4 or 8 bytes ordered by std::less.
+template <class T, class Compare>
+struct is_order_searchable
+    : std::integral_constant<bool, std::is_arithmetic<T>::value && (sizeof(T) == 4U || sizeof(T) == 8U) &&
+                                       (std::is_same<Compare, std::less<T>>::value
+#ifdef AMC_CXX14
+                                        || std::is_same<Compare, std::less<>>::value
+#endif
+                                        )> {
+};
+
+#if defined(AMC_AVX2) || defined(AMC_SSE2)
+template <std::size_t Size>
+using SizeTag = std::integral_constant<std::size_t, Size>;
+
+template <std::size_t Size>
+struct UIntOfSize;
+
+template <>
+struct UIntOfSize<1> {
+  using type = uint8_t;
+};
+template <>
+struct UIntOfSize<2> {
+  using type = uint16_t;
+};
+template <>
+struct UIntOfSize<4> {
+  using type = uint32_t;
+};
+template <>
+struct UIntOfSize<8> {
+  using type = uint64_t;
+};
+
+/// Returns the object representation of 'v' as an unsigned integer of the same size.
+template <class T>
+inline typename UIntOfSize<sizeof(T)>::type ToBits(const T &v) noexcept {
+  typename UIntOfSize<sizeof(T)>::type ret;
+  std::memcpy(&ret, &v, sizeof(T));
+  return ret;
+}
+
+/// Returns the index of the least significant set bit of 'mask', which should not be 0.
+inline unsigned FirstSetBit(uint32_t mask) noexcept {
+#if defined(__GNUC__)
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, mask);
+  return static_cast<unsigned>(idx);
+#else
+  unsigned ret = 0;
+  for (; (mask & 1U) == 0; mask >>= 1) {
+    ++ret;
+  }
+  return ret;
+#endif
+}
+#endif
+
+#ifdef AMC_SSE2
+inline __m128i Broadcast128(uint8_t v, SizeTag<1>) noexcept { return _mm_set1_epi8(static_cast<char>(v)); }
+inline __m128i Broadcast128(uint16_t v, SizeTag<2>) noexcept { return _mm_set1_epi16(static_cast<short>(v)); }
+inline __m128i Broadcast128(uint32_t v, SizeTag<4>) noexcept { return _mm_set1_epi32(static_cast<int>(v)); }
+inline __m128i Broadcast128(uint64_t v, SizeTag<8>) noexcept { return _mm_set1_epi64x(static_cast<long long>(v)); }
+
+/// Returns a mask of the bytes of 'lhs' belonging to an element equal to the corresponding element of 'rhs'.
+inline uint32_t EqualMask128(__m128i lhs, __m128i rhs, SizeTag<1>) noexcept {
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)));
+}
+inline uint32_t EqualMask128(__m128i lhs, __m128i rhs, SizeTag<2>) noexcept {
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(lhs, rhs)));
+}
+inline uint32_t EqualMask128(__m128i lhs, __m128i rhs, SizeTag<4>) noexcept {
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(lhs, rhs)));
+}
+inline uint32_t EqualMask128(__m128i lhs, __m128i rhs, SizeTag<8>) noexcept {
+  // SSE2 has no 64 bits comparison: both 32 bits halves should be equal
+  __m128i eq32 = _mm_cmpeq_epi32(lhs, rhs);
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)))));
+}
+
+enum class ArithmeticKind { kSigned, kUnsigned, kFloatingPoint };
+
+template <class T>
+using ArithmeticKindOf =
+    std::integral_constant<ArithmeticKind, std::is_floating_point<T>::value ? ArithmeticKind::kFloatingPoint
+                                           : std::is_signed<T>::value       ? ArithmeticKind::kSigned
+                                                                            : ArithmeticKind::kUnsigned>;
+
+/// Ordering of 128 bits registers of arithmetic values, for each size and kind of arithmetic type.
+/// LessMask(a, b) returns one bit per element, set when the element of 'a' is less than the one of 'b'.
+/// Unsigned integers are biased so that they can be compared with signed comparisons, the only ones of SSE2.
+template <std::size_t Size, ArithmeticKind Kind>
+struct Sse2Order;
+
+template <>
+struct Sse2Order<4, ArithmeticKind::kSigned> {
+  using Reg = __m128i;
+
+  static Reg Load(const void *p) noexcept { return _mm_loadu_si128(static_cast<const __m128i *>(p)); }
+  static Reg Broadcast(const void *p) noexcept {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return _mm_set1_epi32(v);
+  }
+  static unsigned LessMask(Reg a, Reg b) noexcept {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(b, a))));
+  }
+};
+
+template <>
+struct Sse2Order<4, ArithmeticKind::kUnsigned> : Sse2Order<4, ArithmeticKind::kSigned> {
+  static Reg Bias(Reg r) noexcept { return _mm_xor_si128(r, _mm_set1_epi32(INT32_MIN)); }
+
+  static Reg Load(const void *p) noexcept { return Bias(Sse2Order<4, ArithmeticKind::kSigned>::Load(p)); }
+  static Reg Broadcast(const void *p) noexcept { return Bias(Sse2Order<4, ArithmeticKind::kSigned>::Broadcast(p)); }
+};
+
+template <>
+struct Sse2Order<4, ArithmeticKind::kFloatingPoint> {
+  using Reg = __m128;
+
+  static Reg Load(const void *p) noexcept { return _mm_loadu_ps(static_cast<const float *>(p)); }
+  static Reg Broadcast(const void *p) noexcept { return _mm_set1_ps(*static_cast<const float *>(p)); }
+  static unsigned LessMask(Reg a, Reg b) noexcept { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(a, b))); }
+};
+
+template <>
+struct Sse2Order<8, ArithmeticKind::kSigned> {
+  using Reg = __m128i;
+
+  // Low 32 bits halves are biased to be compared as unsigned, high halves are compared as signed.
+  static Reg Bias(Reg r) noexcept { return _mm_xor_si128(r, _mm_set_epi32(0, INT32_MIN, 0, INT32_MIN)); }
+
+  static Reg Load(const void *p) noexcept { return Bias(_mm_loadu_si128(static_cast<const __m128i *>(p))); }
+  static Reg Broadcast(const void *p) noexcept {
+    int64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return Bias(_mm_set1_epi64x(static_cast<long long>(v)));
+  }
+  static unsigned LessMask(Reg a, Reg b) noexcept {
+    // SSE2 has no 64 bits comparison: b > a if high(b) > high(a), or high(b) == high(a) and low(b) > low(a)
+    __m128i gt32 = _mm_cmpgt_epi32(b, a);
+    __m128i eq32 = _mm_cmpeq_epi32(b, a);
+    __m128i gt64 = _mm_or_si128(gt32, _mm_and_si128(eq32, _mm_shuffle_epi32(gt32, _MM_SHUFFLE(2, 2, 0, 0))));
+    return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(gt64)));
+  }
+};
+
+template <>
+struct Sse2Order<8, ArithmeticKind::kUnsigned> : Sse2Order<8, ArithmeticKind::kSigned> {
+  // All 32 bits halves are biased to be compared as unsigned.
+  static Reg Bias(Reg r) noexcept { return _mm_xor_si128(r, _mm_set1_epi32(INT32_MIN)); }
+
+  static Reg Load(const void *p) noexcept { return Bias(_mm_loadu_si128(static_cast<const __m128i *>(p))); }
+  static Reg Broadcast(const void *p) noexcept {
+    int64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return Bias(_mm_set1_epi64x(static_cast<long long>(v)));
+  }
+};
+
+template <>
+struct Sse2Order<8, ArithmeticKind::kFloatingPoint> {
+  using Reg = __m128d;
+
+  static Reg Load(const void *p) noexcept { return _mm_loadu_pd(static_cast<const double *>(p)); }
+  static Reg Broadcast(const void *p) noexcept { return _mm_set1_pd(*static_cast<const double *>(p)); }
+  static unsigned LessMask(Reg a, Reg b) noexcept { return static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(a, b))); }
+};
+
+/// Returns the number of set bits of a 4 bits mask.
+inline unsigned PopCount4(unsigned mask) noexcept {
+  return (mask & 1U) + ((mask >> 1) & 1U) + ((mask >> 2) & 1U) + (mask >> 3);
+}
+#endif
+
+#ifdef AMC_AVX2
+inline __m256i Broadcast256(uint8_t v, SizeTag<1>) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+inline __m256i Broadcast256(uint16_t v, SizeTag<2>) noexcept { return _mm256_set1_epi16(static_cast<short>(v)); }
+inline __m256i Broadcast256(uint32_t v, SizeTag<4>) noexcept { return _mm256_set1_epi32(static_cast<int>(v)); }
+inline __m256i Broadcast256(uint64_t v, SizeTag<8>) noexcept {
+  return _mm256_set1_epi64x(static_cast<long long>(v));
+}
+
+inline uint32_t EqualMask256(__m256i lhs, __m256i rhs, SizeTag<1>) noexcept {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs)));
+}
+inline uint32_t EqualMask256(__m256i lhs, __m256i rhs, SizeTag<2>) noexcept {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(lhs, rhs)));
+}
+inline uint32_t EqualMask256(__m256i lhs, __m256i rhs, SizeTag<4>) noexcept {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(lhs, rhs)));
+}
+inline uint32_t EqualMask256(__m256i lhs, __m256i rhs, SizeTag<8>) noexcept {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(lhs, rhs)));
+}
+#endif
+
+/// Returns a pointer to the first element of [first, last) equal to 'v', or 'last' if there is none.
+/// Elements are processed by blocks of 32 (AVX2) or 16 (SSE2) bytes, remaining ones one by one.
+/// Memory outside of [first, last) is never read.
+template <class T>
+const T *FindEqual(const T *first, const T *last, const T &v) noexcept {
+  static_assert(is_scannable<T>::value, "FindEqual requires an integral, enum or pointer type of size 1, 2, 4 or 8");
+#if defined(AMC_AVX2) || defined(AMC_SSE2)
+  using Tag = SizeTag<sizeof(T)>;
+  const auto bits = ToBits(v);
+#endif
+#ifdef AMC_AVX2
+  constexpr std::ptrdiff_t kNbElemsPer256 = 32 / sizeof(T);
+  const __m256i needle256 = Broadcast256(bits, Tag());
+  for (; last - first >= kNbElemsPer256; first += kNbElemsPer256) {
+    uint32_t mask =
+        EqualMask256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first)), needle256, Tag());
+    if (mask != 0) {
+      return first + FirstSetBit(mask) / sizeof(T);
+    }
+  }
+#endif
+#ifdef AMC_SSE2
+  constexpr std::ptrdiff_t kNbElemsPer128 = 16 / sizeof(T);
+  const __m128i needle128 = Broadcast128(bits, Tag());
+  for (; last - first >= kNbElemsPer128; first += kNbElemsPer128) {
+    uint32_t mask = EqualMask128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), needle128, Tag());
+    if (mask != 0) {
+      return first + FirstSetBit(mask) / sizeof(T);
+    }
+  }
+#endif
+  for (; first != last; ++first) {
+    if (*first == v) {
+      break;
+    }
+  }
+  return first;
+}
+
+/// Returns the number of elements of sorted range [first, last) that are before the partition point of 'v':
+/// elements 'e' with e < v if !Upper, elements 'e' with !(v < e) if Upper.
+template <bool Upper, class T>
+std::size_t CountBefore(const T *first, const T *last, const T &v) noexcept {
+  std::size_t count = 0;
+#ifdef AMC_SSE2
+  using Order = Sse2Order<sizeof(T), ArithmeticKindOf<T>::value>;
+  constexpr std::ptrdiff_t kNbElemsPer128 = 16 / sizeof(T);
+  const auto needle = Order::Broadcast(&v);
+  for (; last - first >= kNbElemsPer128; first += kNbElemsPer128) {
+    const auto elems = Order::Load(first);
+    count += Upper ? static_cast<unsigned>(kNbElemsPer128) - PopCount4(Order::LessMask(needle, elems))
+                   : PopCount4(Order::LessMask(elems, needle));
+  }
+#endif
+  for (; first != last; ++first) {
+    count += Upper ? !(v < *first) : *first < v;
+  }
+  return count;
+}
+
+/// Branchless binary search of the partition point of 'v' in sorted range [first, last), until the remaining range
+/// fits in a cache line. This last part is then linearly scanned, in SIMD registers when available.
+template <bool Upper, class T>
+const T *SearchSorted(const T *first, const T *last, const T &v) noexcept {
+  constexpr std::size_t kLinearSearchLen = 64 / sizeof(T);
+  std::size_t len = static_cast<std::size_t>(last - first);
+  while (len > kLinearSearchLen) {
+    const std::size_t half = len / 2;
+    // Prefetch both candidates for next middle element as we do not know yet which half will be kept
+    AMC_PREFETCH(first + half / 2);
+    AMC_PREFETCH(first + half + half / 2);
+    first = (Upper ? !(v < first[half]) : first[half] < v) ? first + half : first;
+    len -= half;
+  }
+  return first + CountBefore<Upper>(first, first + len, v);
+}
+
+/// Equivalent of std::lower_bound for a sorted range of arithmetic values compared with std::less.
+template <class T>
+const T *LowerBound(const T *first, const T *last, const T &v) noexcept {
+  static_assert(is_order_searchable<T, std::less<T>>::value, "LowerBound requires an arithmetic type of size 4 or 8");
+  return SearchSorted<false>(first, last, v);
+}
+
+/// Equivalent of std::upper_bound for a sorted range of arithmetic values compared with std::less.
+template <class T>
+const T *UpperBound(const T *first, const T *last, const T &v) noexcept {
+  static_assert(is_order_searchable<T, std::less<T>>::value, "UpperBound requires an arithmetic type of size 4 or 8");
+  return SearchSorted<true>(first, last, v);
+}
+
+}  // namespace simd
+}  // namespace amc
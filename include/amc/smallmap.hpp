@@ -0,0 +1,786 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "fixedcapacityvector.hpp"
+#include "flatcommon.hpp"
+#include "istransparent.hpp"
+#include "memory.hpp"
+#include "type_traits.hpp"
+
+#ifdef AMC_CXX23
+#include <ranges>
+#endif
+
+namespace amc {
+
+/**
+ * Bidirectional iterator of SmallMap, embedding either a pointer to an element of the small vector or a MapType
+ * iterator. T is the (possibly const qualified) value type of the map.
+ * Note: std::iterator is deprecated in c++17 so let's not derive from it.
+ */
+template <class T, class MapItType>
+class SmallMapIterator {
+ private:
+  using VecItType = T *;
+  using IteratorVariant = std::variant<MapItType, VecItType>;
+
+ public:
+  // Needed types for iterators
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename std::remove_const<T>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using reference = T &;
+
+  // From C++20, an iterator must be default constructible to comply with ranges concepts.
+  SmallMapIterator() noexcept = default;
+
+  SmallMapIterator(MapItType it) noexcept : _iter(it) {}
+  SmallMapIterator(VecItType it) noexcept : _iter(it) {}
+
+  // Conversion from iterator to const_iterator
+  template <class U, class OMapItType,
+            typename std::enable_if<!std::is_same<U, T>::value && std::is_convertible<U *, T *>::value &&
+                                        std::is_convertible<OMapItType, MapItType>::value,
+                                    bool>::type = true>
+  SmallMapIterator(const SmallMapIterator<U, OMapItType> &o) noexcept
+      : _iter(o._iter.index() == 0 ? IteratorVariant(std::in_place_index<0>, std::get<0>(o._iter))
+                                   : IteratorVariant(std::in_place_index<1>, std::get<1>(o._iter))) {}
+
+  SmallMapIterator &operator++() noexcept {  // Prefix increment
+    std::visit([](auto &&it) { ++it; }, _iter);
+    return *this;
+  }
+
+  SmallMapIterator &operator--() noexcept {  // Prefix decrement
+    std::visit([](auto &&it) { --it; }, _iter);
+    return *this;
+  }
+
+  SmallMapIterator operator++(int) noexcept {  // Postfix increment
+    SmallMapIterator oldSelf = *this;
+    ++*this;
+    return oldSelf;
+  }
+
+  SmallMapIterator operator--(int) noexcept {  // Postfix decrement
+    SmallMapIterator oldSelf = *this;
+    --*this;
+    return oldSelf;
+  }
+
+  reference operator*() const noexcept {
+    return std::visit([](auto &&it) -> reference { return *it; }, _iter);
+  }
+  pointer operator->() const noexcept { return std::addressof(**this); }
+
+  // Hidden friends so that an iterator can be compared to a const_iterator
+  friend bool operator==(const SmallMapIterator &lhs, const SmallMapIterator &rhs) noexcept {
+    return lhs._iter == rhs._iter;
+  }
+  friend bool operator!=(const SmallMapIterator &lhs, const SmallMapIterator &rhs) noexcept { return !(lhs == rhs); }
+
+ private:
+  template <class, class>
+  friend class SmallMapIterator;
+  template <class, class, uintmax_t, class, class, class>
+  friend class SmallMap;
+
+  MapItType toMapIt() const noexcept { return std::get<MapItType>(_iter); }
+  VecItType toVecIt() const noexcept { return std::get<VecItType>(_iter); }
+
+  IteratorVariant _iter;
+};
+
+/**
+ * Map which is optimized for the case when number of elements is small (<= N).
+ * Like SmallSet, its behavior can be split in two steps:
+ *  - Map is small     : key-value pairs are stored unordered in a vector-like container.
+ *                       Find complexity is linear with number of elements hence N should stay small.
+ *                       In its small state SmallMap will not allocate memory.
+ *  - Map is not small : We have exceed the 'small' capacity of the underlying vector-like container.
+ *                       We now use the provided 'MapType' container for all common map operations.
+ *
+ * MapType can be configured by template parameter, it does not need to be a std::map.
+ * For instance, it could be a FlatMap, in this case, the iterator type is optimized into a RandomAccessIterator
+ * (Alloc should then be an allocator of std::pair<K, V>, which is the value_type of FlatMap).
+ *
+ * It does not allow equivalent keys.
+ * Keys a, b are equivalent if !Compare(a, b) && !Compare(b, a)
+ */
+template <class K, class V, uintmax_t N, class Compare = std::less<K>,
+          class Alloc = amc::allocator<std::pair<const K, V>>,
+          class MapType = typename std::map<K, V, Compare, Alloc>>
+class SmallMap {
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = typename MapType::value_type;
+
+ private:
+  using VecType = FixedCapacityVector<value_type, N, vec::UncheckedGrowingPolicy>;
+  using MapIt = typename MapType::iterator;
+  using MapConstIt = typename MapType::const_iterator;
+
+  static_assert(N <= 64, "N should be small as search has linear complexity for small maps");
+
+  static_assert(std::is_same<K, typename MapType::key_type>::value, "Map key type should be K");
+  static_assert(std::is_same<V, typename MapType::mapped_type>::value, "Map mapped type should be V");
+  static_assert(std::is_same<Compare, typename MapType::key_compare>::value, "Map compare type should be Compare");
+  static_assert(std::is_same<Alloc, typename MapType::allocator_type>::value, "Allocator should match map's");
+
+  // Optim: If Map iterator type is a pointer, do not use SmallMapIterator but a pointer instead.
+  // This is possible for MapType = FlatMap for instance.
+  using IsPtrIterator = std::is_same<MapIt, value_type *>;
+
+ public:
+  using difference_type = ptrdiff_t;
+  using allocator_type = Alloc;
+  using iterator = typename std::conditional<IsPtrIterator::value, value_type *,
+                                             SmallMapIterator<value_type, MapIt>>::type;
+  using const_iterator = typename std::conditional<IsPtrIterator::value, const value_type *,
+                                                   SmallMapIterator<const value_type, MapConstIt>>::type;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = typename std::conditional<sizeof(typename VecType::size_type) < sizeof(typename MapType::size_type),
+                                              typename MapType::size_type, typename VecType::size_type>::type;
+
+  using key_compare = Compare;
+  using value_compare = typename MapType::value_compare;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+
+  using node_type = flat::MapNodeHandle<K, V, Alloc>;
+
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
+  using trivially_relocatable =
+      typename std::conditional<is_trivially_relocatable<VecType>::value && is_trivially_relocatable<MapType>::value,
+                                std::true_type, std::false_type>::type;
+
+  key_compare key_comp() const { return _map.key_comp(); }
+  value_compare value_comp() const { return _map.value_comp(); }
+
+  allocator_type get_allocator() const { return _map.get_allocator(); }
+
+  SmallMap() noexcept(std::is_nothrow_default_constructible<VecType>::value &&
+                      std::is_nothrow_default_constructible<MapType>::value) = default;
+
+  explicit SmallMap(const Compare &comp, const Alloc &alloc = Alloc()) : _map(comp, alloc) {}
+
+  explicit SmallMap(const Alloc &alloc) : _map(alloc) {}
+
+  template <class InputIt>
+  SmallMap(InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : _map(comp, alloc) {
+    insert(first, last);
+  }
+
+  template <class InputIt>
+  SmallMap(InputIt first, InputIt last, const Alloc &alloc) : SmallMap(first, last, Compare(), alloc) {}
+
+  SmallMap(const SmallMap &) = default;
+  SmallMap(SmallMap &&) noexcept(std::is_nothrow_move_constructible<VecType>::value &&
+                                 std::is_nothrow_move_constructible<MapType>::value) = default;
+
+  SmallMap(const SmallMap &o, const Alloc &alloc) : _vec(o._vec), _map(o._map, alloc) {}
+
+  SmallMap(SmallMap &&o, const Alloc &alloc) : _vec(std::move(o._vec)), _map(std::move(o._map), alloc) {}
+
+  SmallMap(std::initializer_list<value_type> list, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : SmallMap(list.begin(), list.end(), comp, alloc) {}
+
+  SmallMap(std::initializer_list<value_type> list, const Alloc &alloc) : SmallMap(list, Compare(), alloc) {}
+
+  SmallMap &operator=(const SmallMap &o) {
+    if (AMC_LIKELY(this != &o)) {
+      assign_small(o._vec, std::is_copy_assignable<value_type>());
+      _map = o._map;
+    }
+    return *this;
+  }
+
+  SmallMap &operator=(SmallMap &&o) noexcept(std::is_nothrow_move_constructible<value_type>::value &&
+                                             std::is_nothrow_move_assignable<MapType>::value) {
+    if (AMC_LIKELY(this != &o)) {
+      assign_small(std::move(o._vec), std::is_move_assignable<value_type>());
+      _map = std::move(o._map);
+    }
+    return *this;
+  }
+
+  SmallMap &operator=(std::initializer_list<value_type> list) {
+    clear();
+    insert(list.begin(), list.end());
+    return *this;
+  }
+
+  iterator begin() noexcept { return isSmall() ? iterator(_vec.begin()) : iterator(_map.begin()); }
+  const_iterator begin() const noexcept {
+    return isSmall() ? const_iterator(_vec.begin()) : const_iterator(_map.begin());
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return isSmall() ? iterator(_vec.end()) : iterator(_map.end()); }
+  const_iterator end() const noexcept { return isSmall() ? const_iterator(_vec.end()) : const_iterator(_map.end()); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  bool empty() const noexcept { return _vec.empty() && _map.empty(); }
+
+  size_type size() const noexcept { return isSmall() ? _vec.size() : _map.size(); }
+
+  size_type max_size() const noexcept {
+    return std::max(static_cast<size_type>(_vec.max_size()), static_cast<size_type>(_map.max_size()));
+  }
+
+  void clear() noexcept {
+    if (isSmall()) {
+      _vec.clear();
+    } else {
+      _map.clear();
+    }
+  }
+
+  mapped_type &at(const key_type &key) {
+    iterator it = find(key);
+    if (it == end()) {
+      throw std::out_of_range("Key not found");
+    }
+    return it->second;
+  }
+
+  const mapped_type &at(const key_type &key) const {
+    const_iterator it = find(key);
+    if (it == end()) {
+      throw std::out_of_range("Key not found");
+    }
+    return it->second;
+  }
+
+  mapped_type &operator[](const key_type &key) { return try_emplace(key).first->second; }
+  mapped_type &operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+
+  std::pair<iterator, bool> insert(const value_type &v) { return isSmall() ? insert_small(v) : _map.insert(v); }
+
+  std::pair<iterator, bool> insert(value_type &&v) {
+    return isSmall() ? insert_small(std::move(v)) : _map.insert(std::move(v));
+  }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  std::pair<iterator, bool> insert(P &&v) {
+    return emplace(std::forward<P>(v));
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    // Insert elements in vector as long as we stay small
+    while (isSmall() && first != last) {
+      insert_small(*first);
+      ++first;
+    }
+    // Insert remaining elements (if any) in the map if we became large
+    if (!isSmall() && first != last) {
+      _map.insert(first, last);
+    }
+  }
+
+  // We keep elements unsorted in the vector, we cannot have any value from hint
+
+  iterator insert(const_iterator hint, const value_type &v) {
+    return isSmall() ? insert_small(v).first : iterator(_map.insert(ToMapIt(hint), v));
+  }
+
+  iterator insert(const_iterator hint, value_type &&v) {
+    return isSmall() ? insert_small(std::move(v)).first : iterator(_map.insert(ToMapIt(hint), std::move(v)));
+  }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  iterator insert(const_iterator hint, P &&v) {
+    return emplace_hint(hint, std::forward<P>(v));
+  }
+
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+  insert_return_type insert(node_type &&nh) {
+    insert_return_type irt{end(), false, std::move(nh)};
+    if (irt.node) {
+      // try_emplace does not move from its arguments if key is already present, so node keeps its value
+      std::tie(irt.position, irt.inserted) = try_emplace(std::move(irt.node.key()), std::move(irt.node.mapped()));
+      if (irt.inserted) {
+        irt.node._optV = std::nullopt;
+      }
+    }
+    return irt;
+  }
+
+  iterator insert(const_iterator, node_type &&nh) { return insert(std::move(nh)).position; }
+
+#ifdef AMC_CXX23
+  template <class R>
+  void insert_range(R &&rg) {
+    insert(std::ranges::begin(rg), std::ranges::end(rg));
+  }
+#endif
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj) {
+    return insert_or_assign_impl(key, std::forward<M>(obj));
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&obj) {
+    return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator, const key_type &key, M &&obj) {
+    return insert_or_assign_impl(key, std::forward<M>(obj)).first;
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator, key_type &&key, M &&obj) {
+    return insert_or_assign_impl(std::move(key), std::forward<M>(obj)).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    if (!isSmall()) {
+      return _map.emplace(std::forward<Args &&>(args)...);
+    }
+    if (isSmallContFull()) {
+      return insert(value_type(std::forward<Args &&>(args)...));
+    }
+    miterator elIt = std::addressof(_vec.emplace_back(std::forward<Args &&>(args)...));
+    miterator it = std::find_if(_vec.begin(), elIt, FindFunctor<K>(key_comp(), elIt->first));
+    bool isNew = it == elIt;
+    if (!isNew) {
+      _vec.pop_back();
+      elIt = it;
+    }
+    return std::pair<iterator, bool>(elIt, isNew);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    if (!isSmall()) {
+      return _map.emplace_hint(ToMapIt(hint), std::forward<Args &&>(args)...);
+    }
+    // We cannot use any hint when we are small
+    return emplace(std::forward<Args &&>(args)...).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) {
+    return try_emplace_impl(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator, const key_type &key, Args &&...args) {
+    return try_emplace_impl(key, std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator, key_type &&key, Args &&...args) {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...).first;
+  }
+
+  iterator find(const key_type &key) { return isSmall() ? iterator(mfind_small(key)) : iterator(_map.find(key)); }
+
+  const_iterator find(const key_type &key) const {
+    return isSmall() ? const_iterator(find_small(key)) : const_iterator(_map.find(key));
+  }
+
+  template <class KeyT, typename std::enable_if<!std::is_same<K, KeyT>::value && has_is_transparent<Compare>::value,
+                                                bool>::type = true>
+  iterator find(const KeyT &key) {
+    return isSmall() ? iterator(mfind_small(key)) : iterator(_map.find(key));
+  }
+
+  template <class KeyT, typename std::enable_if<!std::is_same<K, KeyT>::value && has_is_transparent<Compare>::value,
+                                                bool>::type = true>
+  const_iterator find(const KeyT &key) const {
+    return isSmall() ? const_iterator(find_small(key)) : const_iterator(_map.find(key));
+  }
+
+  bool contains(const key_type &key) const { return isSmall() ? find_small(key) != _vec.end() : _map.count(key); }
+
+  template <class KeyT, typename std::enable_if<!std::is_same<K, KeyT>::value && has_is_transparent<Compare>::value,
+                                                bool>::type = true>
+  bool contains(const KeyT &key) const {
+    return isSmall() ? find_small(key) != _vec.end() : _map.count(key);
+  }
+
+  size_type count(const key_type &key) const { return contains(key); }
+
+  template <class KeyT, typename std::enable_if<!std::is_same<K, KeyT>::value && has_is_transparent<Compare>::value,
+                                                bool>::type = true>
+  size_type count(const KeyT &key) const {
+    return contains(key);
+  }
+
+  size_type erase(const key_type &key) {
+    if (!isSmall()) {
+      return _map.erase(key);
+    }
+    miterator it = mfind_small(key);
+    if (it == _vec.end()) {
+      return 0U;
+    }
+    erase_small(it, std::next(it));
+    return 1U;
+  }
+
+  iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+  iterator erase(const_iterator pos) {
+    if (isSmall()) {
+      miterator vecIt = ToVecIt(pos);
+      return erase_small(vecIt, std::next(vecIt));
+    }
+    return _map.erase(ToMapIt(pos));
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    return isSmall() ? iterator(erase_small(ToVecIt(first), ToVecIt(last)))
+                     : iterator(_map.erase(ToMapIt(first), ToMapIt(last)));
+  }
+
+  void swap(SmallMap &o) noexcept(std::is_nothrow_move_constructible<value_type>::value &&
+                                  noexcept(std::declval<MapType>().swap(std::declval<MapType &>()))) {
+    swap_small(o._vec, std::is_move_assignable<value_type>());
+    _map.swap(o._map);
+  }
+
+  node_type extract(const_iterator position) {
+    if (isSmall()) {
+      miterator vecIt = ToVecIt(position);
+      node_type nh(NodeValue(std::move(*vecIt)), get_allocator());
+      erase_small(vecIt, std::next(vecIt));
+      return nh;
+    }
+    auto mapNh = _map.extract(ToMapIt(position));
+    return node_type(NodeValue(std::move(mapNh.key()), std::move(mapNh.mapped())), mapNh.get_allocator());
+  }
+
+  node_type extract(const key_type &key) {
+    const_iterator it = find(key);
+    return it == end() ? node_type(get_allocator()) : extract(it);
+  }
+
+  /// Merge elements from 'o' map into 'this'.
+  /// If the merge can occur without grow, 'this' will stay small.
+  /// No grow is performed on 'o'.
+  template <uintmax_t N2, class C2, class MapType2>
+  void merge(SmallMap<K, V, N2, C2, Alloc, MapType2> &o) {
+    if (!o.isSmall()) {
+      if (isSmall()) {
+        grow();
+      }
+      _map.merge(o._map);
+      return;
+    }
+    for (auto oit = o._vec.begin(); oit != o._vec.end();) {
+      if (try_emplace(oit->first, std::move(oit->second)).second) {
+        oit = o.erase_small(oit, std::next(oit));
+      } else {
+        ++oit;
+      }
+    }
+  }
+
+  template <uintmax_t N2, class C2, class MapType2>
+  void merge(SmallMap<K, V, N2, C2, Alloc, MapType2> &&o) {
+    merge(o);
+  }
+
+  bool operator==(const SmallMap &o) const {
+    if (size() != o.size()) {
+      return false;
+    }
+    if (!isSmall() && !o.isSmall()) {
+      return _map == o._map;
+    }
+    // We have at least one map that is unsorted. Use is_permutation
+    // We use equality here, not equivalence (ie using == operator instead of <)
+    return std::is_permutation(begin(), end(), o.begin(), o.end());
+  }
+
+  bool operator!=(const SmallMap &o) const { return !(*this == o); }
+
+#ifdef AMC_CXX20
+  auto operator<=>(const SmallMap &o) const {
+    struct Comp {
+      auto operator()(const_pointer pLhs, const_pointer pRhs) const { return *pLhs <=> *pRhs; }
+      auto operator()(const_pointer pLhs, const_reference rhs) const { return *pLhs <=> rhs; }
+      auto operator()(const_reference lhs, const_pointer pRhs) const { return lhs <=> *pRhs; }
+    };
+
+    if (isSmall()) {
+      auto sortedPtrs = computeSortedPtrVec();
+      if (o.isSmall()) {
+        // We are both small, we need to sort both containers
+        auto oSortedPtrs = o.computeSortedPtrVec();
+        return std::lexicographical_compare_three_way(sortedPtrs.begin(), sortedPtrs.end(), oSortedPtrs.begin(),
+                                                      oSortedPtrs.end(), Comp());
+      }
+      // we are small: as we do not order elements in the small container, we need to sort them.
+      return std::lexicographical_compare_three_way(sortedPtrs.begin(), sortedPtrs.end(), o._map.begin(), o._map.end(),
+                                                    Comp());
+    }
+    if (o.isSmall()) {
+      // other is small: as we do not order elements in the small container, we need to sort them.
+      auto oSortedPtrs = o.computeSortedPtrVec();
+      return std::lexicographical_compare_three_way(_map.begin(), _map.end(), oSortedPtrs.begin(), oSortedPtrs.end(),
+                                                    Comp());
+    }
+    return _map <=> o._map;
+  }
+
+  template <class Pred>
+  friend size_type erase_if(SmallMap &c, Pred pred) {
+    auto oldSize = c.size();
+    for (auto i = c.begin(); i != c.end();) {
+      if (pred(*i)) {
+        i = c.erase(i);
+      } else {
+        ++i;
+      }
+    }
+    return oldSize - c.size();
+  }
+
+#else
+
+  // Comparison operators are provided for compliance with std::map but could be painful for performances
+  // as we keep elements unsorted in the 'small' container.
+  bool operator<(const SmallMap &o) const {
+    struct Comp {
+      bool operator()(const_pointer pLhs, const_pointer pRhs) const { return *pLhs < *pRhs; }
+      bool operator()(const_pointer pLhs, const_reference rhs) const { return *pLhs < rhs; }
+      bool operator()(const_reference lhs, const_pointer pRhs) const { return lhs < *pRhs; }
+    };
+
+    if (isSmall()) {
+      auto sortedPtrs = computeSortedPtrVec();
+      if (o.isSmall()) {
+        // We are both small, we need to sort both containers
+        auto oSortedPtrs = o.computeSortedPtrVec();
+        return std::lexicographical_compare(sortedPtrs.begin(), sortedPtrs.end(), oSortedPtrs.begin(),
+                                            oSortedPtrs.end(), Comp());
+      }
+      // we are small: as we do not order elements in the small container, we need to sort them.
+      return std::lexicographical_compare(sortedPtrs.begin(), sortedPtrs.end(), o._map.begin(), o._map.end(), Comp());
+    }
+    if (o.isSmall()) {
+      // other is small: as we do not order elements in the small container, we need to sort them.
+      auto oSortedPtrs = o.computeSortedPtrVec();
+      return std::lexicographical_compare(_map.begin(), _map.end(), oSortedPtrs.begin(), oSortedPtrs.end(), Comp());
+    }
+    return _map < o._map;
+  }
+
+  bool operator<=(const SmallMap &o) const { return !(o < *this); }
+  bool operator>(const SmallMap &o) const { return o < *this; }
+  bool operator>=(const SmallMap &o) const { return !(*this < o); }
+#endif
+
+ private:
+  using miterator = typename VecType::iterator;  // Custom iterator to allow modification of content (when small)
+  using NodeValue = std::pair<K, V>;
+
+  static inline MapConstIt ToMapIt(MapConstIt it) { return it; }
+
+  template <class I>
+  static inline MapConstIt ToMapIt(const I &it) {
+    return it.toMapIt();
+  }
+
+  static inline miterator ToVecIt(const value_type *it) { return const_cast<miterator>(it); }
+
+  template <class I>
+  static inline miterator ToVecIt(const I &it) {
+    return const_cast<miterator>(it.toVecIt());
+  }
+
+  template <class T>
+  std::pair<iterator, bool> insert_small(T &&v) {
+    miterator insertIt = mfind_small(v.first);
+    bool newValue = insertIt == _vec.end();
+    if (newValue) {
+      if (isSmallContFull()) {
+        grow();
+        return _map.insert(std::forward<T>(v));
+      }
+      _vec.push_back(std::forward<T>(v));
+    }
+    return std::pair<iterator, bool>(insertIt, newValue);
+  }
+
+  template <class KeyT, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(KeyT &&key, Args &&...args) {
+    if (!isSmall()) {
+      return _map.try_emplace(std::forward<KeyT>(key), std::forward<Args>(args)...);
+    }
+    miterator it = mfind_small(key);
+    if (it != _vec.end()) {
+      return std::pair<iterator, bool>(it, false);
+    }
+    if (isSmallContFull()) {
+      grow();
+      return _map.try_emplace(std::forward<KeyT>(key), std::forward<Args>(args)...);
+    }
+    it = std::addressof(_vec.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<KeyT>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...)));
+    return std::pair<iterator, bool>(it, true);
+  }
+
+  template <class KeyT, class M>
+  std::pair<iterator, bool> insert_or_assign_impl(KeyT &&key, M &&obj) {
+    auto ret = try_emplace_impl(std::forward<KeyT>(key), std::forward<M>(obj));
+    if (!ret.second) {
+      ret.first->second = std::forward<M>(obj);
+    }
+    return ret;
+  }
+
+  template <class KeyT>
+  struct FindFunctor {
+    FindFunctor(Compare &&comp, const KeyT &k) : _comp(std::move(comp)), _k(k) {}
+
+    bool operator()(const_reference o) const { return !_comp(_k, o.first) && !_comp(o.first, _k); }
+
+    Compare _comp;
+    const KeyT &_k;
+  };
+
+  template <class KeyT>
+  miterator mfind_small(const KeyT &k) {
+    return std::find_if(_vec.begin(), _vec.end(), FindFunctor<KeyT>(key_comp(), k));
+  }
+
+  template <class KeyT>
+  typename VecType::const_iterator find_small(const KeyT &k) const {
+    return std::find_if(_vec.begin(), _vec.end(), FindFunctor<KeyT>(key_comp(), k));
+  }
+
+  // value_type is not assignable for a std::map (std::pair<const K, V>), so the small vector cannot be modified with
+  // the standard vector operations shifting elements. Functions below provide a fallback in this case, moving elements
+  // by destruction and re-construction.
+
+  miterator erase_small(miterator first, miterator last) {
+    return erase_small(first, last, std::is_move_assignable<value_type>());
+  }
+
+  miterator erase_small(miterator first, miterator last, std::true_type) { return _vec.erase(first, last); }
+
+  // Exceptions thrown by the move constructor of value_type cannot be recovered from, as we would lose an element.
+  miterator erase_small(miterator first, miterator last, std::false_type) noexcept {
+    if (first != last) {
+      miterator out = first;
+      for (miterator endIt = _vec.end(); last != endIt; ++last, ++out) {
+        amc::destroy_at(out);
+        amc::construct_at(out, std::move(*last));
+      }
+      while (_vec.end() != out) {
+        _vec.pop_back();
+      }
+    }
+    return first;
+  }
+
+  template <class OVecType>
+  void assign_small(OVecType &&o, std::true_type) {
+    _vec = std::forward<OVecType>(o);
+  }
+
+  void assign_small(const VecType &o, std::false_type) {
+    _vec.clear();
+    for (const_reference v : o) {
+      _vec.push_back(v);
+    }
+  }
+
+  void assign_small(VecType &&o, std::false_type) {
+    _vec.clear();
+    MoveSmall(o, _vec);
+  }
+
+  void swap_small(VecType &o, std::true_type) { _vec.swap(o); }
+
+  void swap_small(VecType &o, std::false_type) {
+    VecType tmp(std::move(_vec));
+    MoveSmall(o, _vec);
+    MoveSmall(tmp, o);
+  }
+
+  /// Moves all elements of 'from' at the end of 'to', leaving 'from' empty.
+  static void MoveSmall(VecType &from, VecType &to) {
+    for (reference v : from) {
+      to.push_back(std::move(v));
+    }
+    from.clear();
+  }
+
+  void grow() {
+    _map.insert(std::make_move_iterator(_vec.begin()), std::make_move_iterator(_vec.end()));
+    _vec.clear();
+  }
+
+  bool isSmall() const noexcept { return _map.empty(); }
+  bool isSmallContFull() const noexcept { return _vec.size() == N; }
+
+  using PtrVec = FixedCapacityVector<const_pointer, N, vec::UncheckedGrowingPolicy>;
+
+  PtrVec computeSortedPtrVec() const {
+    PtrVec sortedPtrs;
+    std::transform(_vec.begin(), _vec.end(), std::back_inserter(sortedPtrs),
+                   [](const_reference r) { return std::addressof(r); });
+    Compare comp = key_comp();
+    std::sort(sortedPtrs.begin(), sortedPtrs.end(),
+              [&comp](const_pointer p1, const_pointer p2) { return comp(p1->first, p2->first); });
+    return sortedPtrs;
+  }
+
+  template <class, class, uintmax_t, class, class, class>
+  friend class SmallMap;
+
+  VecType _vec;
+  MapType _map;
+};
+
+template <class K, class V, uintmax_t N, class Compare, class Alloc, class MapType>
+inline void swap(SmallMap<K, V, N, Compare, Alloc, MapType> &lhs, SmallMap<K, V, N, Compare, Alloc, MapType> &rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace amc
@@ -16,6 +16,7 @@
 #include "fixedcapacityvector.hpp"
 #include "istransparent.hpp"
 #include "memory.hpp"
+#include "simdfind.hpp"
 #include "type_traits.hpp"
 
 #ifdef AMC_CXX23
@@ -128,6 +129,8 @@ class SmallSetIterator : public SmallSetIteratorCommon<T, SetItType> {
  * The behavior of the set can be split in two steps:
  *  - Set is small     : elements are stored unordered in a vector-like container.
  *                       Find complexity is linear with number of elements hence N should stay small.
+ *                       For integral, enum and pointer types ordered with std::less or std::greater, the linear
+ *                       search is a plain equality scan vectorized with SSE2 / AVX2 when available.
  *                       In its small state SmallSet will not allocate memory.
  *  - Set is not small : We have exceed the 'small' capacity of the underlying vector-like container.
  *                       We now use the provided 'SetType' container for all common set operations.
@@ -356,7 +359,7 @@ class SmallSet {
       return insert(T(std::forward<Args &&>(args)...));
     }
     miterator elIt = std::addressof(_vec.emplace_back(std::forward<Args &&>(args)...));
-    miterator it = std::find_if(_vec.begin(), elIt, FindFunctor<T>(key_comp(), *elIt));
+    miterator it = const_cast<miterator>(find_small_in(_vec.begin(), elIt, *elIt));
     bool isNew = it == elIt;
     if (!isNew) {
       _vec.pop_back();
@@ -486,9 +489,8 @@ class SmallSet {
     }
     bool small = isSmall();
     for (auto oit = o._vec.begin(); oit != o._vec.end();) {
-      FindFunctor<T> fFunc(key_comp(), *oit);
       if (small) {
-        if (std::none_of(_vec.begin(), _vec.end(), fFunc)) {
+        if (find_small_in(_vec.begin(), _vec.end(), *oit) == _vec.end()) {
           if (isSmallContFull()) {
             grow();
             small = false;
@@ -642,14 +644,35 @@ class SmallSet {
     const K &_k;
   };
 
+  // Equivalence is bitwise equality for integral and pointer keys ordered with standard comparators:
+  // the search in the small container can then be vectorized.
+  template <class K>
+  using IsEqualityScannable =
+      std::integral_constant<bool, std::is_same<K, T>::value && simd::is_equality_scannable<T, Compare>::value>;
+
+  template <class K>
+  const_pointer find_small_in(const_pointer first, const_pointer last, const K &k, std::false_type) const {
+    return std::find_if(first, last, FindFunctor<K>(key_comp(), k));
+  }
+
+  template <class K>
+  const_pointer find_small_in(const_pointer first, const_pointer last, const K &k, std::true_type) const {
+    return simd::FindEqual(first, last, k);
+  }
+
+  template <class K>
+  const_pointer find_small_in(const_pointer first, const_pointer last, const K &k) const {
+    return find_small_in(first, last, k, IsEqualityScannable<K>());
+  }
+
   template <class K>
   miterator mfind_small(const K &k) {
-    return std::find_if(_vec.begin(), _vec.end(), FindFunctor<K>(key_comp(), k));
+    return const_cast<miterator>(find_small(k));
   }
 
   template <class K>
   typename VecType::const_iterator find_small(const K &k) const {
-    return std::find_if(_vec.begin(), _vec.end(), FindFunctor<K>(key_comp(), k));
+    return find_small_in(_vec.begin(), _vec.end(), k);
   }
 
   void grow() {
@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "smallvector.hpp"
+#include "type_traits.hpp"
+
+#ifdef AMC_CXX17
+#include <string_view>
+#endif
+
+namespace amc {
+
+/**
+ * String of chars stored in a SmallVector<char, N>, with a null terminating char.
+ *
+ * N is the number of inline chars, including the terminating null char: strings of up to N - 1 chars are stored
+ * without dynamic memory allocation. As SmallVector shares its dynamic pointer with its inline storage,
+ * sizeof(SmallString<8>) == 16 with uint32_t sizes (on a 64 bits system), like sizeof(amc::vector<char>).
+ *
+ * Unlike std::string (which may point to its own inline buffer), it is trivially relocatable: vectors of SmallStrings
+ * grow with realloc, without calling any move constructor.
+ *
+ * API is a subset of std::string, with conversions from and to std::string_view from C++17.
+ * Positions and counts are 'size_type' (SizeType, uint32_t by default), and 'npos' is its maximum value.
+ */
+template <uintmax_t N, class Alloc = amc::allocator<char>, class SizeType = uint32_t>
+class SmallString {
+  static_assert(N != 0, "SmallString needs inline storage for its terminating null char");
+
+  using VecType = SmallVector<char, N, Alloc, SizeType>;
+
+ public:
+  using value_type = char;
+  using allocator_type = Alloc;
+  using size_type = SizeType;
+  using difference_type = std::ptrdiff_t;
+  using reference = char &;
+  using const_reference = const char &;
+  using pointer = char *;
+  using const_pointer = const char *;
+  using iterator = char *;
+  using const_iterator = const char *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  using trivially_relocatable = typename is_trivially_relocatable<VecType>::type;
+
+  static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+  static constexpr size_type kInlineCapacity = static_cast<size_type>(N - 1U);
+
+  SmallString() noexcept : SmallString(Alloc()) {}
+
+  explicit SmallString(const Alloc &alloc) noexcept : _vec(alloc) { _vec.push_back('\0'); }
+
+  SmallString(const char *s, size_type n, const Alloc &alloc = Alloc()) : _vec(alloc) {
+    _vec.reserve(CapacityFor(n));
+    _vec.assign(s, s + n);
+    _vec.push_back('\0');
+  }
+
+  SmallString(const char *s, const Alloc &alloc = Alloc()) : SmallString(s, Length(s), alloc) {}
+
+  SmallString(size_type count, char c, const Alloc &alloc = Alloc()) : SmallString(alloc) {
+    reserve(count);
+    append(count, c);
+  }
+
+  template <class InputIt, typename std::enable_if<!std::is_integral<InputIt>::value, bool>::type = true>
+  SmallString(InputIt first, InputIt last, const Alloc &alloc = Alloc()) : SmallString(alloc) {
+    _vec.insert(_vec.begin(), first, last);
+  }
+
+#ifdef AMC_CXX17
+  explicit SmallString(std::string_view sv, const Alloc &alloc = Alloc())
+      : SmallString(sv.data(), static_cast<size_type>(sv.size()), alloc) {}
+#endif
+
+  SmallString(const SmallString &o) = default;
+
+  SmallString(SmallString &&o) noexcept : _vec(std::move(o._vec)) { o.resetMovedFrom(); }
+
+  SmallString &operator=(const SmallString &o) = default;
+
+  SmallString &operator=(SmallString &&o) noexcept {
+    if (AMC_LIKELY(this != &o)) {
+      _vec = std::move(o._vec);
+      o.resetMovedFrom();
+    }
+    return *this;
+  }
+
+  SmallString &operator=(const char *s) { return assign(s); }
+
+#ifdef AMC_CXX17
+  SmallString &operator=(std::string_view sv) { return assign(sv.data(), static_cast<size_type>(sv.size())); }
+
+  operator std::string_view() const noexcept { return std::string_view(data(), size()); }
+#endif
+
+  SmallString &assign(const char *s, size_type n) {
+    if (AMC_UNLIKELY(isInside(s))) {
+      return *this = SmallString(s, n, get_allocator());
+    }
+    clear();
+    return append(s, n);
+  }
+
+  SmallString &assign(const char *s) { return assign(s, Length(s)); }
+
+  SmallString &assign(size_type count, char c) {
+    clear();
+    return append(count, c);
+  }
+
+  allocator_type get_allocator() const noexcept { return _vec.get_allocator(); }
+
+  iterator begin() noexcept { return _vec.begin(); }
+  const_iterator begin() const noexcept { return _vec.begin(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return _vec.end() - 1; }
+  const_iterator end() const noexcept { return _vec.end() - 1; }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  size_type size() const noexcept { return static_cast<size_type>(_vec.size() - 1U); }
+  size_type length() const noexcept { return size(); }
+  bool empty() const noexcept { return size() == 0; }
+  size_type capacity() const noexcept { return static_cast<size_type>(_vec.capacity() - 1U); }
+  size_type max_size() const noexcept { return static_cast<size_type>(_vec.max_size() - 1U); }
+
+  void reserve(size_type n) { _vec.reserve(CapacityFor(n)); }
+
+  void shrink_to_fit() { _vec.shrink_to_fit(); }
+
+  const char *data() const noexcept { return _vec.data(); }
+  char *data() noexcept { return _vec.data(); }
+  const char *c_str() const noexcept { return data(); }
+
+  reference operator[](size_type pos) noexcept { return _vec[pos]; }
+  const_reference operator[](size_type pos) const noexcept { return _vec[pos]; }
+
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("SmallString index out of range");
+    }
+    return _vec[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("SmallString index out of range");
+    }
+    return _vec[pos];
+  }
+
+  reference front() noexcept { return _vec.front(); }
+  const_reference front() const noexcept { return _vec.front(); }
+  reference back() noexcept { return *(end() - 1); }
+  const_reference back() const noexcept { return *(end() - 1); }
+
+  void clear() noexcept {
+    _vec.front() = '\0';
+    _vec.erase(_vec.begin() + 1, _vec.end());
+  }
+
+  void push_back(char c) { _vec.insert(end(), c); }
+
+  void pop_back() noexcept {
+    _vec.pop_back();
+    _vec.back() = '\0';
+  }
+
+  SmallString &insert(size_type pos, const char *s, size_type n) {
+    checkPos(pos);
+    if (AMC_UNLIKELY(isInside(s))) {
+      const SmallString copy(s, n, get_allocator());
+      return insert(pos, copy.data(), n);
+    }
+    _vec.insert(_vec.begin() + pos, s, s + n);
+    return *this;
+  }
+
+  SmallString &insert(size_type pos, const char *s) { return insert(pos, s, Length(s)); }
+
+  SmallString &insert(size_type pos, size_type count, char c) {
+    checkPos(pos);
+    _vec.insert(_vec.begin() + pos, count, c);
+    return *this;
+  }
+
+  SmallString &append(const char *s, size_type n) { return insert(size(), s, n); }
+  SmallString &append(const char *s) { return append(s, Length(s)); }
+  SmallString &append(size_type count, char c) {
+    _vec.insert(end(), count, c);
+    return *this;
+  }
+  template <uintmax_t ON, class OAlloc>
+  SmallString &append(const SmallString<ON, OAlloc, SizeType> &o) {
+    return append(o.data(), o.size());
+  }
+
+  SmallString &operator+=(const char *s) { return append(s); }
+  SmallString &operator+=(char c) {
+    push_back(c);
+    return *this;
+  }
+  template <uintmax_t ON, class OAlloc>
+  SmallString &operator+=(const SmallString<ON, OAlloc, SizeType> &o) {
+    return append(o);
+  }
+
+#ifdef AMC_CXX17
+  SmallString &append(std::string_view sv) { return append(sv.data(), static_cast<size_type>(sv.size())); }
+  SmallString &operator+=(std::string_view sv) { return append(sv); }
+#endif
+
+  /// Erases min(count, size() - pos) chars starting at 'pos'.
+  SmallString &erase(size_type pos = 0, size_type count = npos) {
+    checkPos(pos);
+    const size_type n = std::min(count, static_cast<size_type>(size() - pos));
+    _vec.erase(_vec.begin() + pos, _vec.begin() + pos + n);
+    return *this;
+  }
+
+  iterator erase(const_iterator position) { return _vec.erase(position); }
+  iterator erase(const_iterator first, const_iterator last) { return _vec.erase(first, last); }
+
+  void resize(size_type count, char c = '\0') {
+    const size_type sz = size();
+    if (count < sz) {
+      _vec.erase(_vec.begin() + count, end());
+    } else {
+      append(static_cast<size_type>(count - sz), c);
+    }
+  }
+
+  void swap(SmallString &o) noexcept { _vec.swap(o._vec); }
+
+  SmallString substr(size_type pos = 0, size_type count = npos) const {
+    checkPos(pos);
+    return SmallString(data() + pos, std::min(count, static_cast<size_type>(size() - pos)), get_allocator());
+  }
+
+  /// Position of the first occurrence of the 'n' chars of 's' at or after 'pos', or npos if not found.
+  size_type find(const char *s, size_type pos, size_type n) const noexcept {
+    const size_type sz = size();
+    if (pos > sz || n > sz - pos) {
+      return npos;
+    }
+    if (n == 0) {
+      return pos;
+    }
+    const char *first = data();
+    const char *last = first + (sz - n) + 1;  // last possible start of 's', excluded
+    for (const char *p = first + pos; p != last; ++p) {
+      p = static_cast<const char *>(std::memchr(p, s[0], static_cast<std::size_t>(last - p)));
+      if (p == nullptr) {
+        break;
+      }
+      if (std::memcmp(p, s, n) == 0) {
+        return static_cast<size_type>(p - first);
+      }
+    }
+    return npos;
+  }
+
+  size_type find(const char *s, size_type pos = 0) const noexcept { return find(s, pos, Length(s)); }
+
+  size_type find(char c, size_type pos = 0) const noexcept {
+    if (pos >= size()) {
+      return npos;
+    }
+    const void *p = std::memchr(data() + pos, c, size() - pos);
+    return p == nullptr ? npos : static_cast<size_type>(static_cast<const char *>(p) - data());
+  }
+
+  /// Position of the last occurrence of the 'n' chars of 's' starting at or before 'pos', or npos if not found.
+  size_type rfind(const char *s, size_type pos, size_type n) const noexcept {
+    const size_type sz = size();
+    if (n > sz) {
+      return npos;
+    }
+    for (size_type i = std::min(pos, static_cast<size_type>(sz - n)) + 1U; i != 0; --i) {
+      if (std::memcmp(data() + i - 1U, s, n) == 0) {
+        return static_cast<size_type>(i - 1U);
+      }
+    }
+    return npos;
+  }
+
+  size_type rfind(const char *s, size_type pos = npos) const noexcept { return rfind(s, pos, Length(s)); }
+
+  size_type rfind(char c, size_type pos = npos) const noexcept { return rfind(&c, pos, 1U); }
+
+  bool starts_with(const char *s) const noexcept {
+    const size_type n = Length(s);
+    return n <= size() && std::memcmp(data(), s, n) == 0;
+  }
+
+  bool ends_with(const char *s) const noexcept {
+    const size_type n = Length(s);
+    return n <= size() && std::memcmp(end() - n, s, n) == 0;
+  }
+
+  bool contains(const char *s) const noexcept { return find(s) != npos; }
+  bool contains(char c) const noexcept { return find(c) != npos; }
+
+  /// Lexicographical comparison with the 'n' chars of 's', returning a negative value, 0 or a positive value.
+  int compare(const char *s, size_type n) const noexcept { return Compare(data(), size(), s, n); }
+  int compare(const char *s) const noexcept { return compare(s, Length(s)); }
+  template <uintmax_t ON, class OAlloc>
+  int compare(const SmallString<ON, OAlloc, SizeType> &o) const noexcept {
+    return compare(o.data(), o.size());
+  }
+
+  static int Compare(const char *lhs, std::size_t lhsSize, const char *rhs, std::size_t rhsSize) noexcept {
+    const std::size_t n = std::min(lhsSize, rhsSize);
+    const int res = n == 0 ? 0 : std::memcmp(lhs, rhs, n);
+    if (res != 0) {
+      return res;
+    }
+    return lhsSize < rhsSize ? -1 : (lhsSize > rhsSize ? 1 : 0);
+  }
+
+ private:
+  static size_type Length(const char *s) noexcept { return static_cast<size_type>(std::strlen(s)); }
+
+  /// Capacity of the underlying vector for 'n' chars and the null char.
+  static size_type CapacityFor(size_type n) {
+    if (AMC_UNLIKELY(n == npos)) {
+      throw std::length_error("SmallString cannot be larger than max_size()");
+    }
+    return static_cast<size_type>(n + 1U);
+  }
+
+  /// Tells whether 's' points to the chars of this string, which may be invalidated by a modification.
+  bool isInside(const char *s) const noexcept {
+    return std::less_equal<const char *>()(data(), s) && std::less<const char *>()(s, data() + _vec.size());
+  }
+
+  void checkPos(size_type pos) const {
+    if (pos > size()) {
+      throw std::out_of_range("SmallString position out of range");
+    }
+  }
+
+  /// Moved from vector is empty and small: adding its null char cannot throw.
+  void resetMovedFrom() noexcept {
+    if (_vec.empty()) {
+      _vec.push_back('\0');
+    }
+  }
+
+  VecType _vec;
+};
+
+template <uintmax_t N, class A, class S>
+constexpr typename SmallString<N, A, S>::size_type SmallString<N, A, S>::npos;
+
+template <uintmax_t N, class A, class S>
+constexpr typename SmallString<N, A, S>::size_type SmallString<N, A, S>::kInlineCapacity;
+
+template <uintmax_t N, class A, class S>
+inline void swap(SmallString<N, A, S> &lhs, SmallString<N, A, S> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator==(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+}
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator!=(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator<(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return lhs.compare(rhs) < 0;
+}
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator<=(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return lhs.compare(rhs) <= 0;
+}
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator>(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return lhs.compare(rhs) > 0;
+}
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline bool operator>=(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) noexcept {
+  return lhs.compare(rhs) >= 0;
+}
+
+template <uintmax_t N, class A, class S>
+inline bool operator==(const SmallString<N, A, S> &lhs, const char *rhs) noexcept {
+  return lhs.compare(rhs) == 0;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator==(const char *lhs, const SmallString<N, A, S> &rhs) noexcept {
+  return rhs.compare(lhs) == 0;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator!=(const SmallString<N, A, S> &lhs, const char *rhs) noexcept {
+  return lhs.compare(rhs) != 0;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator!=(const char *lhs, const SmallString<N, A, S> &rhs) noexcept {
+  return rhs.compare(lhs) != 0;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator<(const SmallString<N, A, S> &lhs, const char *rhs) noexcept {
+  return lhs.compare(rhs) < 0;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator<(const char *lhs, const SmallString<N, A, S> &rhs) noexcept {
+  return rhs.compare(lhs) > 0;
+}
+
+#ifdef AMC_CXX17
+template <uintmax_t N, class A, class S>
+inline bool operator==(const SmallString<N, A, S> &lhs, std::string_view rhs) noexcept {
+  return std::string_view(lhs) == rhs;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator==(std::string_view lhs, const SmallString<N, A, S> &rhs) noexcept {
+  return lhs == std::string_view(rhs);
+}
+template <uintmax_t N, class A, class S>
+inline bool operator!=(const SmallString<N, A, S> &lhs, std::string_view rhs) noexcept {
+  return std::string_view(lhs) != rhs;
+}
+template <uintmax_t N, class A, class S>
+inline bool operator!=(std::string_view lhs, const SmallString<N, A, S> &rhs) noexcept {
+  return lhs != std::string_view(rhs);
+}
+#endif
+
+template <uintmax_t N, class A, class S, uintmax_t ON, class OA>
+inline SmallString<N, A, S> operator+(const SmallString<N, A, S> &lhs, const SmallString<ON, OA, S> &rhs) {
+  SmallString<N, A, S> res(lhs.get_allocator());
+  res.reserve(static_cast<S>(lhs.size() + rhs.size()));
+  res.append(lhs).append(rhs);
+  return res;
+}
+
+template <uintmax_t N, class A, class S>
+inline SmallString<N, A, S> operator+(SmallString<N, A, S> &&lhs, const char *rhs) {
+  return std::move(lhs.append(rhs));
+}
+
+template <uintmax_t N, class A, class S>
+inline SmallString<N, A, S> operator+(const SmallString<N, A, S> &lhs, const char *rhs) {
+  return SmallString<N, A, S>(lhs) + rhs;
+}
+
+template <uintmax_t N, class A, class S>
+inline SmallString<N, A, S> operator+(SmallString<N, A, S> &&lhs, char rhs) {
+  lhs.push_back(rhs);
+  return std::move(lhs);
+}
+
+template <uintmax_t N, class A, class S>
+inline SmallString<N, A, S> operator+(const SmallString<N, A, S> &lhs, char rhs) {
+  return SmallString<N, A, S>(lhs) + rhs;
+}
+
+template <class Traits, uintmax_t N, class A, class S>
+inline std::basic_ostream<char, Traits> &operator<<(std::basic_ostream<char, Traits> &os,
+                                                    const SmallString<N, A, S> &s) {
+  return os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+}  // namespace amc
+
+#ifdef AMC_CXX17
+namespace std {
+template <uintmax_t N, class A, class S>
+struct hash<amc::SmallString<N, A, S>> {
+  size_t operator()(const amc::SmallString<N, A, S> &s) const noexcept {
+    return std::hash<std::string_view>()(std::string_view(s));
+  }
+};
+}  // namespace std
+#endif
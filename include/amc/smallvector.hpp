@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <stdexcept>
@@ -11,16 +12,16 @@
 namespace amc {
 namespace vec {
 
-template <class SizeType>
-inline SizeType SafeNextCapacity(SizeType oldCapa, uintmax_t newSize, bool exact) {
+template <class GrowingPolicy, class SizeType>
+inline SizeType SafeNextCapacity(SizeType oldCapa, uintmax_t newSize, bool exact, std::size_t elemSize) {
   if (exact) {
     // Only for reserve method. It takes a SizeType as input parameter, so it can obviously fit into a SizeType.
     return static_cast<SizeType>(newSize);
   }
-  // Realloc * 1.5 except if minimum requested size is larger (choose it in this case).
+  // Next capacity is given by the growing policy (* 1.5 by default).
   // Also make sure the new capacity can fit in SizeType
   const uintmax_t newCapa =
-      std::min(std::max(static_cast<uintmax_t>((3U * static_cast<uintmax_t>(oldCapa) + 1U) / 2U), newSize),
+      std::min(GrowingPolicy::NextCapacity(static_cast<uintmax_t>(oldCapa), newSize, elemSize),
                static_cast<uintmax_t>(std::numeric_limits<SizeType>::max()));
   if (AMC_UNLIKELY(newCapa < newSize)) {
     throw std::overflow_error("Attempt to use more elements that size_type can support. Use a larger size_type");
@@ -33,6 +34,17 @@ struct CanReallocate
     : public std::integral_constant<bool, is_trivially_relocatable<typename Alloc::value_type>::value &&
                                               has_reallocate<Alloc>::value> {};
 
+/// Attempts to expand the block 'p' of 'oldCapa' elements (if any) to 'newCapa' elements without moving it.
+template <class Alloc, class T, class SizeType, typename std::enable_if<has_try_expand<Alloc>::value, bool>::type = true>
+inline bool TryExpand(Alloc &alloc, T *p, SizeType oldCapa, SizeType newCapa) {
+  return oldCapa != 0 && newCapa > oldCapa && alloc.try_expand(p, oldCapa, newCapa);
+}
+
+template <class Alloc, class T, class SizeType, typename std::enable_if<!has_try_expand<Alloc>::value, bool>::type = true>
+inline bool TryExpand(Alloc &, T *, SizeType, SizeType) {
+  return false;
+}
+
 template <class Alloc, class T, class SizeType, typename std::enable_if<CanReallocate<Alloc>::value, bool>::type = true>
 inline T *Reallocate(Alloc &alloc, T *p, SizeType oldCapa, SizeType newCapa, SizeType size) {
   return alloc.reallocate(p, oldCapa, newCapa, size);
@@ -41,33 +53,96 @@ inline T *Reallocate(Alloc &alloc, T *p, SizeType oldCapa, SizeType newCapa, Siz
 template <class Alloc, class T, class SizeType,
           typename std::enable_if<!CanReallocate<Alloc>::value, bool>::type = true>
 inline T *Reallocate(Alloc &alloc, T *p, SizeType oldCapa, SizeType newCapa, SizeType size) {
+  if (TryExpand(alloc, p, oldCapa, newCapa)) {
+    return p;
+  }
   T *newPtr = alloc.allocate(newCapa);
   (void)amc::uninitialized_relocate_n(p, size, newPtr);
   alloc.deallocate(p, oldCapa);
   return newPtr;
 }
 
+/// Capacity to record for a block of 'count' elements returned by an '_at_least' allocation method.
+template <class SizeType, class CountType>
+inline SizeType AllocatedCapacity(CountType count) {
+  return static_cast<uintmax_t>(count) < static_cast<uintmax_t>(std::numeric_limits<SizeType>::max())
+             ? static_cast<SizeType>(count)
+             : std::numeric_limits<SizeType>::max();
+}
+
+/// Allocates a block of at least 'capa' elements, and updates 'capa' with the real number of elements of the block.
+template <class Alloc, class SizeType, typename std::enable_if<has_allocate_at_least<Alloc>::value, bool>::type = true>
+inline typename Alloc::value_type *AllocateAtLeast(Alloc &alloc, SizeType &capa) {
+  auto res = alloc.allocate_at_least(capa);
+  capa = AllocatedCapacity<SizeType>(res.count);
+  return res.ptr;
+}
+
+template <class Alloc, class SizeType,
+          typename std::enable_if<!has_allocate_at_least<Alloc>::value, bool>::type = true>
+inline typename Alloc::value_type *AllocateAtLeast(Alloc &alloc, SizeType &capa) {
+  return alloc.allocate(capa);
+}
+
+/// Same as Reallocate, but updates 'newCapa' with the real number of elements of the new block.
+template <class Alloc, class T, class SizeType,
+          typename std::enable_if<CanReallocate<Alloc>::value && has_reallocate_at_least<Alloc>::value, bool>::type =
+              true>
+inline T *ReallocateAtLeast(Alloc &alloc, T *p, SizeType oldCapa, SizeType &newCapa, SizeType size) {
+  auto res = alloc.reallocate_at_least(p, oldCapa, newCapa, size);
+  newCapa = AllocatedCapacity<SizeType>(res.count);
+  return res.ptr;
+}
+
+template <class Alloc, class T, class SizeType,
+          typename std::enable_if<CanReallocate<Alloc>::value && !has_reallocate_at_least<Alloc>::value, bool>::type =
+              true>
+inline T *ReallocateAtLeast(Alloc &alloc, T *p, SizeType oldCapa, SizeType &newCapa, SizeType size) {
+  return alloc.reallocate(p, oldCapa, newCapa, size);
+}
+
+template <class Alloc, class T, class SizeType,
+          typename std::enable_if<!CanReallocate<Alloc>::value, bool>::type = true>
+inline T *ReallocateAtLeast(Alloc &alloc, T *p, SizeType oldCapa, SizeType &newCapa, SizeType size) {
+  if (TryExpand(alloc, p, oldCapa, newCapa)) {
+    return p;
+  }
+  T *newPtr = AllocateAtLeast(alloc, newCapa);
+  (void)amc::uninitialized_relocate_n(p, size, newPtr);
+  alloc.deallocate(p, oldCapa);
+  return newPtr;
+}
+
+/// Growing records the real capacity of the allocated block (see AllocateAtLeast), except for exact requests
+/// (reserve), which keep the requested capacity.
 template <class T, class Alloc, class SizeType>
+template <class GrowingPolicy>
 void SmallVectorBase<T, Alloc, SizeType>::grow(uintmax_t minSize, bool exact) {
   SizeType newCapa;
   if (isSmall()) {
     SizeType oldCapa = _size == std::numeric_limits<SizeType>::max() ? _capa : _size;
-    newCapa = SafeNextCapacity(oldCapa, minSize, exact);
-    T *dynStorage = this->allocate(newCapa);
+    newCapa = SafeNextCapacity<GrowingPolicy>(oldCapa, minSize, exact, sizeof(T));
+    T *dynStorage = exact ? this->allocate(newCapa) : AllocateAtLeast(static_cast<Alloc &>(*this), newCapa);
     (void)amc::uninitialized_relocate_n(_storage.ptr(), _capa, dynStorage);
     _storage.setDyn(dynStorage);
     _size = _capa;
   } else {
-    newCapa = SafeNextCapacity(_capa, minSize, exact);
-    _storage.setDyn(vec::Reallocate(static_cast<Alloc &>(*this), _storage.dyn(), _capa, newCapa, _size));
+    newCapa = SafeNextCapacity<GrowingPolicy>(_capa, minSize, exact, sizeof(T));
+    Alloc &alloc = static_cast<Alloc &>(*this);
+    _storage.setDyn(exact ? vec::Reallocate(alloc, _storage.dyn(), _capa, newCapa, _size)
+                          : vec::ReallocateAtLeast(alloc, _storage.dyn(), _capa, newCapa, _size));
   }
   _capa = newCapa;
+  trackMaxSize();
 }
 
 template <class T, class Alloc, class SizeType>
+template <class GrowingPolicy>
 void StdVectorBase<T, Alloc, SizeType>::grow(uintmax_t minSize, bool exact) {
-  SizeType newCapa = SafeNextCapacity(_capa, minSize, exact);
-  _storage = vec::Reallocate(static_cast<Alloc &>(*this), _storage, _capa, newCapa, _size);
+  SizeType newCapa = SafeNextCapacity<GrowingPolicy>(_capa, minSize, exact, sizeof(T));
+  Alloc &alloc = static_cast<Alloc &>(*this);
+  _storage = exact ? vec::Reallocate(alloc, _storage, _capa, newCapa, _size)
+                   : vec::ReallocateAtLeast(alloc, _storage, _capa, newCapa, _size);
   _capa = newCapa;
 }
 
@@ -124,11 +199,23 @@ void SmallVectorBase<T, Alloc, SizeType>::freeStorage() noexcept {
  *
  * In addition, size_type can be configured and is uint32_t by default.
  *
+ * Growth of the dynamic storage can be tuned with 'GrowingPolicy' (see vec::DynamicGrowingPolicy):
+ *  - DynamicGrowingPolicy: capacity * 1.5 (default)
+ *  - DoublingGrowingPolicy: capacity * 2
+ *  - SizeClassGrowingPolicy: capacity * 1.5, rounded up to the size class of the allocator
+ *  - PageGrowingPolicy: capacity * 1.5, rounded up to a whole number of pages for large buffers
+ *
  * If 'Alloc' provides this additional optional method
  *  * T *reallocate(pointer p, size_type oldCapacity, size_type newCapacity, size_type nConstructedElems);
  *
  * then it will be able use it to optimize the growing of the container when T is trivially relocatable
  * (for amc::allocator, it will use 'realloc').
+ * Likewise, if 'Alloc' provides 'allocate_at_least' (and 'reallocate_at_least') methods returning an
+ * allocation_result, the real capacity of the allocated blocks is recorded when growing, avoiding some reallocations
+ * (for amc::allocator, the usable size given by the C library, as malloc_usable_size).
+ * If T cannot be reallocated, an optional 'try_expand(pointer p, size_type oldCapacity, size_type newCapacity)'
+ * method returning true if the block could be extended in place is attempted first, before relocating all elements
+ * into a new block (see MmapAllocator).
  *
  * Exception safety:
  *   It provides at least Basic exception safety.
@@ -138,6 +225,7 @@ void SmallVectorBase<T, Alloc, SizeType>::freeStorage() noexcept {
  *     - insert from count elements
  *   If Object movement can throw, only 'push_back' and 'emplace_back' modifiers provide strong exception warranty
  */
-template <class T, uintmax_t N, class Alloc = amc::allocator<T>, class SizeType = uint32_t>
-using SmallVector = Vector<T, Alloc, SizeType, vec::DynamicGrowingPolicy, vec::SanitizeInlineSize<N, SizeType>()>;
+template <class T, uintmax_t N, class Alloc = amc::allocator<T>, class SizeType = uint32_t,
+          class GrowingPolicy = vec::DynamicGrowingPolicy>
+using SmallVector = Vector<T, Alloc, SizeType, GrowingPolicy, vec::SanitizeInlineSize<N, SizeType>()>;
 }  // namespace amc
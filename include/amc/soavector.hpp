@@ -0,0 +1,652 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "memory.hpp"
+#include "smallvector.hpp"
+#include "type_traits.hpp"
+#include "vectorcommon.hpp"
+
+namespace amc {
+namespace soa {
+
+/// Emulation of std::index_sequence, not available in C++11.
+template <std::size_t... I>
+struct IndexSequence {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1U, N - 1U, I...> {};
+
+template <std::size_t... I>
+struct MakeIndexSequence<0, I...> {
+  using type = IndexSequence<I...>;
+};
+
+template <bool...>
+struct BoolPack {};
+
+template <bool... B>
+struct AllOf : std::is_same<BoolPack<true, B...>, BoolPack<B..., true>> {};
+
+template <class... Ts>
+struct SumSizes : std::integral_constant<std::size_t, 0> {};
+
+template <class T, class... Ts>
+struct SumSizes<T, Ts...> : std::integral_constant<std::size_t, sizeof(T) + SumSizes<Ts...>::value> {};
+
+/// Contiguous range of the elements of a column of a SoAVector.
+template <class T>
+class ColumnSpan {
+ public:
+  using element_type = T;
+  using value_type = typename std::remove_cv<T>::type;
+  using size_type = std::size_t;
+  using reference = T &;
+  using iterator = T *;
+
+  ColumnSpan(T *data, size_type size) noexcept : _data(data), _size(size) {}
+
+  T *data() const noexcept { return _data; }
+  size_type size() const noexcept { return _size; }
+  bool empty() const noexcept { return _size == 0; }
+
+  iterator begin() const noexcept { return _data; }
+  iterator end() const noexcept { return _data + _size; }
+
+  reference operator[](size_type idx) const noexcept {
+    assert(idx < _size);
+    return _data[idx];
+  }
+
+  reference front() const noexcept { return (*this)[0]; }
+  reference back() const noexcept { return (*this)[_size - 1U]; }
+
+ private:
+  T *_data;
+  size_type _size;
+};
+
+/// Proxy reference to a row of a SoAVector: tuple of references to the elements of the row, in each column.
+/// Assigning it assigns the elements, it converts to the value type (a tuple of copies), and two of them can be
+/// swapped as rvalues, swapping the elements. This way, standard algorithms moving elements through iterators
+/// (std::sort, std::rotate...) work on SoAVector rows, as for the proxy references of std::vector<bool>.
+template <class... Ts>
+class RowRef : public std::tuple<Ts &...> {
+  using Base = std::tuple<Ts &...>;
+
+ public:
+  using Base::Base;
+  using Base::operator=;
+
+  RowRef(const RowRef &) = default;
+
+  // Assignment of a row assigns the elements, it does not rebind the references
+  RowRef &operator=(const RowRef &o) {
+    Base::operator=(static_cast<const Base &>(o));
+    return *this;
+  }
+
+  friend void swap(RowRef lhs, RowRef rhs) { lhs.swapElems(rhs, typename MakeIndexSequence<sizeof...(Ts)>::type()); }
+
+ private:
+  template <std::size_t... I>
+  void swapElems(RowRef &o, IndexSequence<I...>) {
+    using std::swap;
+    (void)std::initializer_list<int>{(swap(std::get<I>(*this), std::get<I>(o)), 0)...};
+  }
+};
+
+/// Random access iterator over the rows of a SoAVector.
+/// Dereferencing it yields a proxy reference to the row (see RowRef), so it is not a true random access iterator
+/// (std::iterator_traits::reference is not a reference), but algorithms of the standard library accept it.
+template <class SoAVectorType, bool IsConst>
+class SoAIterator {
+  using Owner = typename std::conditional<IsConst, const SoAVectorType, SoAVectorType>::type;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename SoAVectorType::value_type;
+  using reference = typename std::conditional<IsConst, typename SoAVectorType::const_reference,
+                                              typename SoAVectorType::reference>::type;
+  using pointer = void;
+
+  SoAIterator() = default;
+
+  SoAIterator(Owner *owner, typename SoAVectorType::size_type idx) noexcept : _owner(owner), _idx(idx) {}
+
+  /// Conversion from iterator to const_iterator
+  template <bool OIsConst, typename std::enable_if<IsConst && !OIsConst, bool>::type = true>
+  SoAIterator(const SoAIterator<SoAVectorType, OIsConst> &o) noexcept : _owner(o._owner), _idx(o._idx) {}
+
+  reference operator*() const { return (*_owner)[_idx]; }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  /// Index of the row in the SoAVector
+  typename SoAVectorType::size_type index() const noexcept { return _idx; }
+
+  SoAIterator &operator++() noexcept {
+    ++_idx;
+    return *this;
+  }
+  SoAIterator operator++(int) noexcept {
+    SoAIterator ret(*this);
+    ++*this;
+    return ret;
+  }
+  SoAIterator &operator--() noexcept {
+    --_idx;
+    return *this;
+  }
+  SoAIterator operator--(int) noexcept {
+    SoAIterator ret(*this);
+    --*this;
+    return ret;
+  }
+
+  SoAIterator &operator+=(difference_type n) noexcept {
+    _idx = static_cast<typename SoAVectorType::size_type>(static_cast<difference_type>(_idx) + n);
+    return *this;
+  }
+  SoAIterator &operator-=(difference_type n) noexcept { return *this += -n; }
+
+  SoAIterator operator+(difference_type n) const noexcept { return SoAIterator(*this) += n; }
+  SoAIterator operator-(difference_type n) const noexcept { return SoAIterator(*this) -= n; }
+  friend SoAIterator operator+(difference_type n, const SoAIterator &it) noexcept { return it + n; }
+
+  template <bool OIsConst>
+  difference_type operator-(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return static_cast<difference_type>(_idx) - static_cast<difference_type>(o._idx);
+  }
+
+  // Iterators of the same SoAVector only differ by their index
+  template <bool OIsConst>
+  bool operator==(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx == o._idx;
+  }
+  template <bool OIsConst>
+  bool operator!=(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx != o._idx;
+  }
+  template <bool OIsConst>
+  bool operator<(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx < o._idx;
+  }
+  template <bool OIsConst>
+  bool operator<=(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx <= o._idx;
+  }
+  template <bool OIsConst>
+  bool operator>(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx > o._idx;
+  }
+  template <bool OIsConst>
+  bool operator>=(const SoAIterator<SoAVectorType, OIsConst> &o) const noexcept {
+    return _idx >= o._idx;
+  }
+
+ private:
+  template <class, bool>
+  friend class SoAIterator;
+
+  Owner *_owner = nullptr;
+  typename SoAVectorType::size_type _idx = 0;
+};
+
+}  // namespace soa
+
+/**
+ * Vector storing its elements as a structure of arrays: each of the 'Ts' types has its own contiguous column, all
+ * columns sharing the same size and capacity, and being carved out of one single allocation.
+ * Loops touching only one or two fields of a row then only bring these fields in cache, and can be vectorized.
+ *
+ * Rows are accessed with proxy references, tuples of references to the elements of each column, as in
+ *   amc::SoAVector<int, double> v;
+ *   v.emplace_back(1, 2.5);
+ *   std::get<1>(v[0]) *= 2;
+ *   for (double d : v.column<1>()) { ... }
+ *
+ * Insertions and erasures shift each column with the same relocation primitives as amc vectors (memmove for
+ * trivially relocatable types). Growing relocates each column to the new block, which is why column types should be
+ * nothrow movable (and move assignable): they typically are the fields of a small struct.
+ * As for other vectors of amc, arguments of 'emplace' (not at the end, and without reallocation) should not refer to
+ * elements of the vector.
+ */
+template <class... Ts>
+class SoAVector {
+  static constexpr std::size_t kNbColumns = sizeof...(Ts);
+
+  static_assert(kNbColumns != 0, "SoAVector should have at least one column");
+
+  using Indices = typename soa::MakeIndexSequence<kNbColumns>::type;
+  using Columns = std::tuple<Ts *...>;
+  using Expand = int[];
+
+ public:
+  using value_type = std::tuple<Ts...>;
+  using reference = soa::RowRef<Ts...>;
+  using const_reference = soa::RowRef<const Ts...>;
+  using size_type = uint32_t;
+  using difference_type = std::ptrdiff_t;
+  using iterator = soa::SoAIterator<SoAVector, false>;
+  using const_iterator = soa::SoAIterator<SoAVector, true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using trivially_relocatable = std::true_type;
+
+  template <std::size_t I>
+  using column_type = typename std::tuple_element<I, value_type>::type;
+
+  SoAVector() noexcept = default;
+
+  explicit SoAVector(size_type count) { resize(count); }
+
+  SoAVector(size_type count, const value_type &v) { resize(count, v); }
+
+  SoAVector(std::initializer_list<value_type> list) {
+    reserve(static_cast<size_type>(list.size()));
+    for (const value_type &v : list) {
+      push_back(v);
+    }
+  }
+
+  SoAVector(const SoAVector &o) : _columns(Allocate(o._size)), _capa(o._size) {
+    if (o._size != 0) {
+      try {
+        copyColumns(o, ColumnIndex<0>());
+      } catch (...) {
+        Deallocate(_columns, _capa);
+        throw;
+      }
+      _size = o._size;
+    }
+  }
+
+  SoAVector(SoAVector &&o) noexcept
+      : _columns(amc::exchange(o._columns, Columns())),
+        _size(amc::exchange(o._size, 0)),
+        _capa(amc::exchange(o._capa, 0)) {}
+
+  SoAVector &operator=(const SoAVector &o) {
+    if (this != &o) {
+      SoAVector(o).swap(*this);
+    }
+    return *this;
+  }
+
+  SoAVector &operator=(SoAVector &&o) noexcept {
+    if (this != &o) {
+      destroy(Indices());
+      Deallocate(_columns, _capa);
+      _columns = amc::exchange(o._columns, Columns());
+      _size = amc::exchange(o._size, 0);
+      _capa = amc::exchange(o._capa, 0);
+    }
+    return *this;
+  }
+
+  ~SoAVector() {
+    destroy(Indices());
+    Deallocate(_columns, _capa);
+  }
+
+  size_type size() const noexcept { return _size; }
+  size_type capacity() const noexcept { return _capa; }
+  bool empty() const noexcept { return _size == 0; }
+
+  /// Pointer to the first element of column 'I'.
+  template <std::size_t I>
+  column_type<I> *data() noexcept {
+    return std::get<I>(_columns);
+  }
+  template <std::size_t I>
+  const column_type<I> *data() const noexcept {
+    return std::get<I>(_columns);
+  }
+
+  /// Contiguous range of the elements of column 'I', invalidated as iterators.
+  template <std::size_t I>
+  soa::ColumnSpan<column_type<I>> column() noexcept {
+    return soa::ColumnSpan<column_type<I>>(data<I>(), _size);
+  }
+  template <std::size_t I>
+  soa::ColumnSpan<const column_type<I>> column() const noexcept {
+    return soa::ColumnSpan<const column_type<I>>(data<I>(), _size);
+  }
+
+  reference operator[](size_type idx) noexcept {
+    assert(idx < _size);
+    return row<reference>(*this, idx, Indices());
+  }
+  const_reference operator[](size_type idx) const noexcept {
+    assert(idx < _size);
+    return row<const_reference>(*this, idx, Indices());
+  }
+
+  reference at(size_type idx) {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+  const_reference at(size_type idx) const {
+    checkIndex(idx);
+    return (*this)[idx];
+  }
+
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[_size - 1U]; }
+  const_reference back() const noexcept { return (*this)[_size - 1U]; }
+
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  iterator end() noexcept { return iterator(this, _size); }
+  const_iterator end() const noexcept { return const_iterator(this, _size); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  void reserve(size_type capacity) {
+    if (_capa < capacity) {
+      reallocate(capacity);
+    }
+  }
+
+  void shrink_to_fit() {
+    if (_size < _capa) {
+      reallocate(_size);
+    }
+  }
+
+  void clear() noexcept {
+    destroy(Indices());
+    _size = 0;
+  }
+
+  void resize(size_type count) { resize(count, value_type()); }
+
+  void resize(size_type count, const value_type &v) {
+    if (count < _size) {
+      eraseRows(count, static_cast<size_type>(_size - count), Indices());
+    } else {
+      reserve(count);
+      while (_size < count) {
+        push_back(v);
+      }
+    }
+  }
+
+  /// Constructs a new row at the end, each column element being constructed from its argument.
+  template <class... Args>
+  reference emplace_back(Args &&...args) {
+    return *emplace(cend(), std::forward<Args>(args)...);
+  }
+
+  void push_back(const value_type &v) { emplaceTuple(_size, v, Indices()); }
+  void push_back(value_type &&v) { emplaceTuple(_size, std::move(v), Indices()); }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    --_size;
+    destroyRow(_size, Indices());
+  }
+
+  /// Constructs a new row before 'pos', each column element being constructed from its argument.
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args &&...args) {
+    static_assert(sizeof...(Args) == kNbColumns, "emplace expects one argument per column");
+    assert(pos.index() <= _size);
+    return emplaceRow(pos.index(), std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  iterator insert(const_iterator pos, const value_type &v) { return emplaceTuple(pos.index(), v, Indices()); }
+  iterator insert(const_iterator pos, value_type &&v) { return emplaceTuple(pos.index(), std::move(v), Indices()); }
+
+  iterator erase(const_iterator pos) noexcept {
+    assert(pos.index() < _size);
+    eraseRow(pos.index(), Indices());
+    return iterator(this, pos.index());
+  }
+
+  iterator erase(const_iterator first, const_iterator last) noexcept {
+    assert(first <= last && last.index() <= _size);
+    if (first != last) {
+      eraseRows(first.index(), static_cast<size_type>(last - first), Indices());
+    }
+    return iterator(this, first.index());
+  }
+
+  void swap(SoAVector &o) noexcept {
+    std::swap(_columns, o._columns);
+    std::swap(_size, o._size);
+    std::swap(_capa, o._capa);
+  }
+
+  friend void swap(SoAVector &lhs, SoAVector &rhs) noexcept { lhs.swap(rhs); }
+
+  bool operator==(const SoAVector &o) const { return _size == o._size && equalColumns(o, Indices()); }
+  bool operator!=(const SoAVector &o) const { return !(*this == o); }
+
+ private:
+  template <std::size_t... I>
+  using IndexSequence = soa::IndexSequence<I...>;
+
+  template <std::size_t I>
+  using ColumnIndex = std::integral_constant<std::size_t, I>;
+
+  static constexpr std::size_t kRowSize = soa::SumSizes<Ts...>::value;
+
+  static_assert(soa::AllOf<vec::is_shift_nothrow<Ts>::value...>::value,
+                "SoAVector column types should be nothrow movable and move assignable");
+  static_assert(soa::AllOf<(alignof(Ts) <= alignof(std::max_align_t))...>::value,
+                "Over-aligned column types are not supported");
+
+  static std::size_t AlignUp(std::size_t n, std::size_t alignment) noexcept {
+    return (n + alignment - 1U) & ~(alignment - 1U);
+  }
+
+  /// Computes the offsets of the columns in a block of 'capa' rows, and returns its size in bytes.
+  /// Columns are stored in declaration order, each one aligned for its type.
+  template <std::size_t... I>
+  static std::size_t Layout(size_type capa, std::size_t (&offsets)[kNbColumns], IndexSequence<I...>) noexcept {
+    std::size_t nbBytes = 0;
+    (void)Expand{0, (offsets[I] = AlignUp(nbBytes, alignof(Ts)), nbBytes = offsets[I] + capa * sizeof(Ts), 0)...};
+    return nbBytes;
+  }
+
+  template <std::size_t... I>
+  static void SetColumns(Columns &columns, char *block, const std::size_t (&offsets)[kNbColumns],
+                         IndexSequence<I...>) noexcept {
+    (void)Expand{0, (std::get<I>(columns) = reinterpret_cast<Ts *>(block + offsets[I]), 0)...};
+  }
+
+  static Columns Allocate(size_type capa) {
+    Columns columns;
+    if (capa != 0) {
+      std::size_t offsets[kNbColumns];
+      const std::size_t nbBytes = Layout(capa, offsets, Indices());
+      SetColumns(columns, static_cast<char *>(SimpleAllocator().allocate(nbBytes)), offsets, Indices());
+    }
+    return columns;
+  }
+
+  static void Deallocate(const Columns &columns, size_type capa) noexcept {
+    if (capa != 0) {
+      std::size_t offsets[kNbColumns];
+      SimpleAllocator().deallocate(std::get<0>(columns), Layout(capa, offsets, Indices()));
+    }
+  }
+
+  template <class Row, class Self, std::size_t... I>
+  static Row row(Self &self, size_type idx, IndexSequence<I...>) noexcept {
+    return Row(std::get<I>(self._columns)[idx]...);
+  }
+
+  void checkIndex(size_type idx) const {
+    if (idx >= _size) {
+      throw std::out_of_range("SoAVector index out of range");
+    }
+  }
+
+  template <std::size_t... I>
+  void destroy(IndexSequence<I...>) noexcept {
+    (void)Expand{0, (amc::destroy_n(std::get<I>(_columns), _size), 0)...};
+  }
+
+  template <std::size_t... I>
+  void destroyRow(size_type idx, IndexSequence<I...>) noexcept {
+    (void)Expand{0, (amc::destroy_at(std::get<I>(_columns) + idx), 0)...};
+  }
+
+  template <std::size_t... I>
+  bool equalColumns(const SoAVector &o, IndexSequence<I...>) const {
+    bool equal = true;
+    (void)Expand{0, (equal = equal && std::equal(std::get<I>(_columns), std::get<I>(_columns) + _size,
+                                                 std::get<I>(o._columns)),
+                     0)...};
+    return equal;
+  }
+
+  void copyColumns(const SoAVector &, ColumnIndex<kNbColumns>) noexcept {}
+
+  template <std::size_t I>
+  void copyColumns(const SoAVector &o, ColumnIndex<I>) {
+    column_type<I> *first = std::get<I>(_columns);
+    amc::uninitialized_copy_n(std::get<I>(o._columns), o._size, first);
+    try {
+      copyColumns(o, ColumnIndex<I + 1U>());
+    } catch (...) {
+      amc::destroy_n(first, o._size);
+      throw;
+    }
+  }
+
+  /// Relocates all rows to a new block of 'capa' rows.
+  void reallocate(size_type capa) {
+    Columns newColumns = Allocate(capa);
+    if (_size != 0) {
+      relocateColumns(newColumns, _size, Indices());
+    }
+    Deallocate(_columns, _capa);
+    _columns = newColumns;
+    _capa = capa;
+  }
+
+  /// Relocates all rows to 'newColumns', leaving a hole of one row at index 'idx' (if it is not the end).
+  template <std::size_t... I>
+  void relocateColumns(const Columns &newColumns, size_type idx, IndexSequence<I...>) noexcept {
+    (void)Expand{0, (RelocateAround(std::get<I>(_columns), _size, idx, std::get<I>(newColumns)), 0)...};
+  }
+
+  template <class T>
+  static void RelocateAround(T *first, size_type size, size_type idx, T *dest) noexcept {
+    (void)amc::uninitialized_relocate_n(first, idx, dest);
+    if (idx < size) {
+      (void)amc::uninitialized_relocate_n(first + idx, size - idx, dest + idx + 1U);
+    }
+  }
+
+  template <class Tuple, std::size_t... I>
+  iterator emplaceTuple(size_type idx, Tuple &&v, IndexSequence<I...>) {
+    return emplaceRow(idx, std::forward_as_tuple(std::get<I>(std::forward<Tuple>(v))...));
+  }
+
+  template <class ArgsTuple>
+  iterator emplaceRow(size_type idx, ArgsTuple &&args) {
+    if (_size == _capa) {
+      // Construct the new row in the new block before relocating the others, as arguments may refer to them
+      const size_type newCapa = vec::SafeNextCapacity<vec::DynamicGrowingPolicy>(
+          _capa, static_cast<uintmax_t>(_size) + 1U, false, kRowSize);
+      Columns newColumns = Allocate(newCapa);
+      try {
+        constructColumns(newColumns, idx, args, ColumnIndex<0>());
+      } catch (...) {
+        Deallocate(newColumns, newCapa);
+        throw;
+      }
+      relocateColumns(newColumns, idx, Indices());
+      Deallocate(_columns, _capa);
+      _columns = newColumns;
+      _capa = newCapa;
+    } else {
+      emplaceColumns(idx, args, ColumnIndex<0>());
+    }
+    ++_size;
+    return iterator(this, idx);
+  }
+
+  template <class ArgsTuple>
+  static void constructColumns(const Columns &, size_type, ArgsTuple &, ColumnIndex<kNbColumns>) noexcept {}
+
+  template <class ArgsTuple, std::size_t I>
+  static void constructColumns(const Columns &columns, size_type idx, ArgsTuple &args, ColumnIndex<I>) {
+    column_type<I> *pos = std::get<I>(columns) + idx;
+    amc::construct_at(pos, std::get<I>(std::move(args)));
+    try {
+      constructColumns(columns, idx, args, ColumnIndex<I + 1U>());
+    } catch (...) {
+      amc::destroy_at(pos);
+      throw;
+    }
+  }
+
+  template <class ArgsTuple>
+  void emplaceColumns(size_type, ArgsTuple &, ColumnIndex<kNbColumns>) noexcept {}
+
+  /// Emplaces the element of column 'I' at 'idx' (and the next columns), shifting the next ones to the right.
+  template <class ArgsTuple, std::size_t I>
+  void emplaceColumns(size_type idx, ArgsTuple &args, ColumnIndex<I>) {
+    column_type<I> *pos = std::get<I>(_columns) + idx;
+    const size_type nElemsToShift = _size - idx;
+    vec::emplace_n(pos, nElemsToShift, std::get<I>(std::move(args)));
+    try {
+      emplaceColumns(idx, args, ColumnIndex<I + 1U>());
+    } catch (...) {
+      vec::erase_at(pos, nElemsToShift);
+      throw;
+    }
+  }
+
+  template <std::size_t... I>
+  void eraseRow(size_type idx, IndexSequence<I...>) noexcept {
+    --_size;
+    (void)Expand{0, (vec::erase_at(std::get<I>(_columns) + idx, _size - idx), 0)...};
+  }
+
+  template <std::size_t... I>
+  void eraseRows(size_type idx, size_type count, IndexSequence<I...>) noexcept {
+    _size -= count;
+    (void)Expand{0, (vec::erase_n(std::get<I>(_columns) + idx, count, _size - idx), 0)...};
+  }
+
+  Columns _columns{};
+  size_type _size = 0;
+  size_type _capa = 0;
+};
+
+}  // namespace amc
+
+namespace std {
+/// Rows of SoAVector can be decomposed with structured bindings, as tuples.
+template <class... Ts>
+struct tuple_size<amc::soa::RowRef<Ts...>> : tuple_size<tuple<Ts &...>> {};
+
+template <std::size_t I, class... Ts>
+struct tuple_element<I, amc::soa::RowRef<Ts...>> : tuple_element<I, tuple<Ts &...>> {};
+}  // namespace std
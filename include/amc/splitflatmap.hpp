@@ -0,0 +1,641 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "flatcommon.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+#ifdef AMC_CXX14
+#include "istransparent.hpp"
+#ifdef AMC_CXX20
+#include <compare>
+#endif
+#endif
+namespace amc {
+namespace flat {
+
+/// Pointer-like object returned by operator-> of iterators yielding references by value.
+template <class Reference>
+class ArrowProxy {
+ public:
+  explicit ArrowProxy(Reference r) : _r(r) {}
+
+  Reference *operator->() noexcept { return &_r; }
+
+ private:
+  Reference _r;
+};
+
+/// Random access iterator over two parallel ranges of keys and mapped values.
+/// Dereferencing it yields a pair of references to the key and its mapped value.
+template <class KeyIt, class MappedIt>
+class SplitIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<typename std::iterator_traits<KeyIt>::value_type,
+                               typename std::iterator_traits<MappedIt>::value_type>;
+  using reference =
+      std::pair<typename std::iterator_traits<KeyIt>::reference, typename std::iterator_traits<MappedIt>::reference>;
+  using pointer = ArrowProxy<reference>;
+
+  SplitIterator() = default;
+
+  SplitIterator(KeyIt keyIt, MappedIt mappedIt) : _keyIt(keyIt), _mappedIt(mappedIt) {}
+
+  /// Conversion from iterator to const_iterator
+  template <class OMappedIt, typename std::enable_if<!std::is_same<MappedIt, OMappedIt>::value &&
+                                                         std::is_convertible<OMappedIt, MappedIt>::value,
+                                                     bool>::type = true>
+  SplitIterator(const SplitIterator<KeyIt, OMappedIt> &o) : _keyIt(o._keyIt), _mappedIt(o._mappedIt) {}
+
+  reference operator*() const { return reference(*_keyIt, *_mappedIt); }
+  pointer operator->() const { return pointer(**this); }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  KeyIt key_iterator() const { return _keyIt; }
+  MappedIt mapped_iterator() const { return _mappedIt; }
+
+  SplitIterator &operator++() {
+    ++_keyIt;
+    ++_mappedIt;
+    return *this;
+  }
+  SplitIterator operator++(int) {
+    SplitIterator ret(*this);
+    ++*this;
+    return ret;
+  }
+  SplitIterator &operator--() {
+    --_keyIt;
+    --_mappedIt;
+    return *this;
+  }
+  SplitIterator operator--(int) {
+    SplitIterator ret(*this);
+    --*this;
+    return ret;
+  }
+
+  SplitIterator &operator+=(difference_type n) {
+    _keyIt += n;
+    _mappedIt += n;
+    return *this;
+  }
+  SplitIterator &operator-=(difference_type n) { return *this += -n; }
+
+  SplitIterator operator+(difference_type n) const { return SplitIterator(*this) += n; }
+  SplitIterator operator-(difference_type n) const { return SplitIterator(*this) -= n; }
+  friend SplitIterator operator+(difference_type n, const SplitIterator &it) { return it + n; }
+
+  template <class OMappedIt>
+  difference_type operator-(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt - o._keyIt;
+  }
+
+  // Both ranges are parallel, comparing key iterators is sufficient
+  template <class OMappedIt>
+  bool operator==(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt == o._keyIt;
+  }
+  template <class OMappedIt>
+  bool operator!=(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt != o._keyIt;
+  }
+  template <class OMappedIt>
+  bool operator<(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt < o._keyIt;
+  }
+  template <class OMappedIt>
+  bool operator<=(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt <= o._keyIt;
+  }
+  template <class OMappedIt>
+  bool operator>(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt > o._keyIt;
+  }
+  template <class OMappedIt>
+  bool operator>=(const SplitIterator<KeyIt, OMappedIt> &o) const {
+    return _keyIt >= o._keyIt;
+  }
+
+ private:
+  template <class, class>
+  friend class SplitIterator;
+
+  KeyIt _keyIt{};
+  MappedIt _mappedIt{};
+};
+
+}  // namespace flat
+
+/**
+ * Map with unique keys, storing its keys and its mapped values in two parallel vectors, keys being sorted.
+ * Compared to FlatMap, lookups only touch the keys vector, which is much more cache friendly when mapped values are
+ * large: a binary search over 100k entries only brings keys in cache, and not the mapped values.
+ * Insertions and erasures shift both vectors (with relocation if types are trivially relocatable).
+ *
+ * Its interface is close to C++23 std::flat_map:
+ * - iterators are random access iterators yielding a std::pair<const Key &, T &> by value (operator-> returns a proxy)
+ * - keys() and values() give access to underlying vectors.
+ * Node handles are not supported.
+ *
+ * Keys a, b are considered the same if !Compare(a, b) && !Compare(b, a)
+ */
+template <class Key, class T, class Compare = std::less<Key>, class KeyVecType = amc::vector<Key>,
+          class MappedVecType = amc::vector<T>>
+class SplitFlatMap : private Compare {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using key_compare = Compare;
+  using reference = std::pair<const Key &, T &>;
+  using const_reference = std::pair<const Key &, const T &>;
+  using size_type = typename KeyVecType::size_type;
+  using difference_type = std::ptrdiff_t;
+  using iterator = flat::SplitIterator<typename KeyVecType::const_iterator, typename MappedVecType::iterator>;
+  using const_iterator =
+      flat::SplitIterator<typename KeyVecType::const_iterator, typename MappedVecType::const_iterator>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using key_container_type = KeyVecType;
+  using mapped_container_type = MappedVecType;
+
+  static_assert(std::is_same<Key, typename KeyVecType::value_type>::value, "Key vector value type should be Key");
+  static_assert(std::is_same<T, typename MappedVecType::value_type>::value, "Mapped vector value type should be T");
+
+  class value_compare {
+   public:
+    bool operator()(const_reference lhs, const_reference rhs) const { return comp(lhs.first, rhs.first); }
+
+   protected:
+    friend class SplitFlatMap;
+
+    explicit value_compare(Compare c) : comp(c) {}
+
+    Compare comp;
+  };
+
+  using trivially_relocatable =
+      typename std::conditional<is_trivially_relocatable<Compare>::value &&
+                                    is_trivially_relocatable<KeyVecType>::value &&
+                                    is_trivially_relocatable<MappedVecType>::value,
+                                std::true_type, std::false_type>::type;
+
+  key_compare key_comp() const { return compRef(); }
+  value_compare value_comp() const { return value_compare(compRef()); }
+
+  SplitFlatMap() noexcept(std::is_nothrow_default_constructible<Compare>::value &&
+                          std::is_nothrow_default_constructible<KeyVecType>::value &&
+                          std::is_nothrow_default_constructible<MappedVecType>::value) = default;
+
+  explicit SplitFlatMap(const Compare &comp) : Compare(comp) {}
+
+  template <class InputIt>
+  SplitFlatMap(InputIt first, InputIt last, const Compare &comp = Compare()) : Compare(comp) {
+    append(first, last);
+    sortAndEraseDuplicates();
+  }
+
+  SplitFlatMap(std::initializer_list<value_type> list, const Compare &comp = Compare())
+      : SplitFlatMap(list.begin(), list.end(), comp) {}
+
+  /// Constructs a map from a vector of keys and a vector of mapped values of the same size, stealing their memory.
+  SplitFlatMap(key_container_type &&keys, mapped_container_type &&values, const Compare &comp = Compare())
+      : Compare(comp), _keys(std::move(keys)), _values(std::move(values)) {
+    if (_keys.size() != _values.size()) {
+      throw std::invalid_argument("Keys and values should have the same size");
+    }
+    sortAndEraseDuplicates();
+  }
+
+  SplitFlatMap &operator=(std::initializer_list<value_type> list) {
+    clear();
+    insert(list.begin(), list.end());
+    return *this;
+  }
+
+  const key_container_type &keys() const noexcept { return _keys; }
+  const mapped_container_type &values() const noexcept { return _values; }
+
+  iterator begin() noexcept { return iterator(_keys.cbegin(), _values.begin()); }
+  const_iterator begin() const noexcept { return const_iterator(_keys.cbegin(), _values.cbegin()); }
+  iterator end() noexcept { return iterator(_keys.cend(), _values.end()); }
+  const_iterator end() const noexcept { return const_iterator(_keys.cend(), _values.cend()); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+  const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+#ifdef AMC_NONSTD_FEATURES
+  size_type capacity() const noexcept { return _keys.capacity(); }
+  void reserve(size_type size) {
+    _keys.reserve(size);
+    _values.reserve(size);
+  }
+
+  void shrink_to_fit() {
+    _keys.shrink_to_fit();
+    _values.shrink_to_fit();
+  }
+#endif
+
+  bool empty() const noexcept { return _keys.empty(); }
+  size_type size() const noexcept { return _keys.size(); }
+  size_type max_size() const noexcept { return std::min<size_type>(_keys.max_size(), _values.max_size()); }
+
+  void clear() noexcept {
+    _keys.clear();
+    _values.clear();
+  }
+
+  mapped_type &at(const key_type &key) {
+    size_type pos = findPos(key);
+    if (pos == size()) throw std::out_of_range("Key not found");
+    return _values[pos];
+  }
+
+  const mapped_type &at(const key_type &key) const {
+    size_type pos = findPos(key);
+    if (pos == size()) throw std::out_of_range("Key not found");
+    return _values[pos];
+  }
+
+  mapped_type &operator[](const key_type &key) { return try_emplace(key).first->second; }
+  mapped_type &operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+
+  std::pair<iterator, bool> insert(const value_type &v) { return try_emplace(v.first, v.second); }
+
+  std::pair<iterator, bool> insert(value_type &&v) { return try_emplace(std::move(v.first), std::move(v.second)); }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  std::pair<iterator, bool> insert(P &&v) {
+    return insert(value_type(std::forward<P>(v)));
+  }
+
+  iterator insert(const_iterator hint, const value_type &v) { return try_emplace(hint, v.first, v.second); }
+
+  iterator insert(const_iterator hint, value_type &&v) {
+    return try_emplace(hint, std::move(v.first), std::move(v.second));
+  }
+
+  template <class P, typename std::enable_if<std::is_constructible<value_type, P &&>::value, bool>::type = true>
+  iterator insert(const_iterator hint, P &&v) {
+    return insert(hint, value_type(std::forward<P>(v)));
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    append(first, last);
+    sortAndEraseDuplicates();
+  }
+
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj) {
+    return insert_or_assign_key(key, std::forward<M>(obj));
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&obj) {
+    return insert_or_assign_key(std::move(key), std::forward<M>(obj));
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator hint, const key_type &key, M &&obj) {
+    return insert_or_assign_hint(hint, key, std::forward<M>(obj));
+  }
+
+  template <class M>
+  iterator insert_or_assign(const_iterator hint, key_type &&key, M &&obj) {
+    return insert_or_assign_hint(hint, std::move(key), std::forward<M>(obj));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return insert(hint, value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, const key_type &key, Args &&...args) {
+    return try_emplace_hint(hint, key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, key_type &&key, Args &&...args) {
+    return try_emplace_hint(hint, std::move(key), std::forward<Args>(args)...);
+  }
+
+  iterator find(const key_type &key) { return begin() + findPos(key); }
+  const_iterator find(const key_type &key) const { return begin() + findPos(key); }
+
+  bool contains(const key_type &key) const { return findPos(key) != size(); }
+
+  size_type count(const key_type &key) const { return contains(key); }
+
+  std::pair<iterator, iterator> equal_range(const key_type &key) {
+    iterator first = find(key);
+    return std::pair<iterator, iterator>(first, first == end() ? first : std::next(first));
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+    const_iterator first = find(key);
+    return std::pair<const_iterator, const_iterator>(first, first == end() ? first : std::next(first));
+  }
+
+  iterator lower_bound(const key_type &key) { return begin() + lowerBoundPos(key); }
+  const_iterator lower_bound(const key_type &key) const { return begin() + lowerBoundPos(key); }
+
+  iterator upper_bound(const key_type &key) { return begin() + upperBoundPos(key); }
+  const_iterator upper_bound(const key_type &key) const { return begin() + upperBoundPos(key); }
+
+#ifdef AMC_CXX14
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator find(const K &key) {
+    return begin() + findPos(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator find(const K &key) const {
+    return begin() + findPos(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  bool contains(const K &key) const {
+    return findPos(key) != size();
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  size_type count(const K &key) const {
+    return contains(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator lower_bound(const K &key) {
+    return begin() + lowerBoundPos(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator lower_bound(const K &key) const {
+    return begin() + lowerBoundPos(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  iterator upper_bound(const K &key) {
+    return begin() + upperBoundPos(key);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<Key, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator upper_bound(const K &key) const {
+    return begin() + upperBoundPos(key);
+  }
+#endif
+
+  size_type erase(const key_type &key) {
+    size_type pos = findPos(key);
+    if (pos == size()) {
+      return 0U;
+    }
+    eraseAt(pos, pos + 1U);
+    return 1U;
+  }
+
+  iterator erase(iterator position) { return erase(const_iterator(position)); }
+  iterator erase(const_iterator position) { return erase(position, std::next(position)); }
+  iterator erase(const_iterator first, const_iterator last) {
+    size_type pos = static_cast<size_type>(first - cbegin());
+    eraseAt(pos, static_cast<size_type>(last - cbegin()));
+    return begin() + pos;
+  }
+
+  bool operator==(const SplitFlatMap &o) const { return _keys == o._keys && _values == o._values; }
+  bool operator!=(const SplitFlatMap &o) const { return !(*this == o); }
+
+  bool operator<(const SplitFlatMap &o) const {
+    return std::lexicographical_compare(begin(), end(), o.begin(), o.end());
+  }
+  bool operator<=(const SplitFlatMap &o) const { return !(o < *this); }
+  bool operator>(const SplitFlatMap &o) const { return o < *this; }
+  bool operator>=(const SplitFlatMap &o) const { return !(*this < o); }
+
+  void swap(SplitFlatMap &o) noexcept(noexcept(std::declval<KeyVecType>().swap(std::declval<KeyVecType &>())) &&
+                                      noexcept(std::declval<MappedVecType>().swap(std::declval<MappedVecType &>())) &&
+                                      amc::is_nothrow_swappable<Compare>::value) {
+    std::swap(static_cast<Compare &>(*this), static_cast<Compare &>(o));
+    _keys.swap(o._keys);
+    _values.swap(o._values);
+  }
+
+  /// Moves elements of 'o' whose key is not present in this map, leaving the others in 'o'.
+  void merge(SplitFlatMap &o) {
+    size_type oPos = 0;
+    while (oPos < o.size()) {
+      size_type pos = lowerBoundPos(o._keys[oPos]);
+      if (pos == size() || compRef()(o._keys[oPos], _keys[pos])) {
+        insertAt(pos, std::move(o._keys[oPos]), std::move(o._values[oPos]));
+        o.eraseAt(oPos, oPos + 1U);
+      } else {
+        ++oPos;
+      }
+    }
+  }
+
+  void merge(SplitFlatMap &&o) { merge(o); }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Get the underlying vectors of keys and mapped values of this map, leaving it empty.
+  std::pair<key_container_type, mapped_container_type> steal_vectors() {
+    std::pair<key_container_type, mapped_container_type> ret(std::move(_keys), std::move(_values));
+    clear();
+    return ret;
+  }
+#endif
+
+#ifdef AMC_CXX20
+  template <class Pred>
+  friend size_type erase_if(SplitFlatMap &c, Pred pred) {
+    const size_type oldSize = c.size();
+    size_type newSize = 0;
+    for (size_type pos = 0; pos < oldSize; ++pos) {
+      if (!pred(const_reference(c._keys[pos], c._values[pos]))) {
+        if (newSize != pos) {
+          c._keys[newSize] = std::move(c._keys[pos]);
+          c._values[newSize] = std::move(c._values[pos]);
+        }
+        ++newSize;
+      }
+    }
+    c.eraseAt(newSize, oldSize);
+    return oldSize - newSize;
+  }
+#endif
+
+ private:
+  template <class K>
+  size_type lowerBoundPos(const K &key) const {
+    return static_cast<size_type>(std::lower_bound(_keys.begin(), _keys.end(), key, compRef()) - _keys.begin());
+  }
+
+  template <class K>
+  size_type upperBoundPos(const K &key) const {
+    return static_cast<size_type>(std::upper_bound(_keys.begin(), _keys.end(), key, compRef()) - _keys.begin());
+  }
+
+  /// Returns the position of 'key', or size() if not found
+  template <class K>
+  size_type findPos(const K &key) const {
+    size_type pos = lowerBoundPos(key);
+    return pos == size() || compRef()(key, _keys[pos]) ? size() : pos;
+  }
+
+  /// Emplaces a new key and its mapped value constructed from 'args' at position 'pos' in both vectors
+  template <class K, class... Args>
+  void insertAt(size_type pos, K &&key, Args &&...args) {
+    _keys.emplace(_keys.begin() + pos, std::forward<K>(key));
+    try {
+      _values.emplace(_values.begin() + pos, std::forward<Args>(args)...);
+    } catch (...) {
+      _keys.erase(_keys.begin() + pos);
+      throw;
+    }
+  }
+
+  void eraseAt(size_type first, size_type last) {
+    _keys.erase(_keys.begin() + first, _keys.begin() + last);
+    _values.erase(_values.begin() + first, _values.begin() + last);
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&key, Args &&...args) {
+    size_type pos = lowerBoundPos(key);
+    if (pos != size() && !compRef()(key, _keys[pos])) {
+      return std::pair<iterator, bool>(begin() + pos, false);
+    }
+    insertAt(pos, std::forward<K>(key), std::forward<Args>(args)...);
+    return std::pair<iterator, bool>(begin() + pos, true);
+  }
+
+  template <class K, class... Args>
+  iterator try_emplace_hint(const_iterator hint, K &&key, Args &&...args) {
+    auto keyPos = flat::HintPosition(_keys.cbegin(), _keys.cend(), hint.key_iterator(), compRef(), key);
+    size_type pos = static_cast<size_type>(keyPos.first - _keys.cbegin());
+    if (keyPos.second) {
+      insertAt(pos, std::forward<K>(key), std::forward<Args>(args)...);
+    }
+    return begin() + pos;
+  }
+
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign_key(K &&key, M &&obj) {
+    size_type pos = lowerBoundPos(key);
+    if (pos != size() && !compRef()(key, _keys[pos])) {
+      _values[pos] = std::forward<M>(obj);
+      return std::pair<iterator, bool>(begin() + pos, false);
+    }
+    insertAt(pos, std::forward<K>(key), std::forward<M>(obj));
+    return std::pair<iterator, bool>(begin() + pos, true);
+  }
+
+  template <class K, class M>
+  iterator insert_or_assign_hint(const_iterator hint, K &&key, M &&obj) {
+    auto keyPos = flat::HintPosition(_keys.cbegin(), _keys.cend(), hint.key_iterator(), compRef(), key);
+    size_type pos = static_cast<size_type>(keyPos.first - _keys.cbegin());
+    if (keyPos.second) {
+      insertAt(pos, std::forward<K>(key), std::forward<M>(obj));
+    } else {
+      _values[pos] = std::forward<M>(obj);
+    }
+    return begin() + pos;
+  }
+
+  template <class InputIt>
+  void append(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      const auto &v = *first;
+      _keys.push_back(v.first);
+      _values.push_back(v.second);
+    }
+  }
+
+  /// Sorts both vectors according to the keys, keeping the first element of equivalent keys.
+  void sortAndEraseDuplicates() {
+    const size_type n = size();
+    if (std::adjacent_find(_keys.begin(), _keys.end(), [this](const Key &lhs, const Key &rhs) {
+          return !compRef()(lhs, rhs);
+        }) == _keys.end()) {
+      return;  // already sorted without duplicates
+    }
+    // Sort a permutation of positions and move elements in their final order, only once
+    amc::vector<size_type> perm(n);
+    std::iota(perm.begin(), perm.end(), size_type());
+    std::stable_sort(perm.begin(), perm.end(),
+                     [this](size_type lhs, size_type rhs) { return compRef()(_keys[lhs], _keys[rhs]); });
+    KeyVecType keys;
+    MappedVecType values;
+    keys.reserve(n);
+    values.reserve(n);
+    for (size_type pos : perm) {
+      if (keys.empty() || compRef()(keys.back(), _keys[pos])) {
+        keys.push_back(std::move(_keys[pos]));
+        values.push_back(std::move(_values[pos]));
+      }
+    }
+    _keys.swap(keys);
+    _values.swap(values);
+  }
+
+  Compare &compRef() { return static_cast<Compare &>(*this); }
+  const Compare &compRef() const { return static_cast<const Compare &>(*this); }
+
+  KeyVecType _keys;
+  MappedVecType _values;
+};
+
+template <class Key, class T, class Compare, class KeyVecType, class MappedVecType>
+inline void swap(SplitFlatMap<Key, T, Compare, KeyVecType, MappedVecType> &lhs,
+                 SplitFlatMap<Key, T, Compare, KeyVecType, MappedVecType> &rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace amc
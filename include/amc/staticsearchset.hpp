@@ -0,0 +1,457 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#include "allocator.hpp"
+#include "config.hpp"
+#include "flatcommon.hpp"
+#include "flatset.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+#ifdef AMC_CXX14
+#include "istransparent.hpp"
+#endif
+#ifdef AMC_CXX20
+#include <bit>
+#include <compare>
+#endif
+
+namespace amc {
+
+/// Helpers to navigate in the Eytzinger layout of a sorted sequence of 'n' elements.
+/// The Eytzinger layout stores a complete binary search tree in breadth first order: with 1-based indexes,
+/// children of node 'k' are '2k' and '2k + 1'. Index 0 is used as the 'end' position.
+namespace eytzinger {
+
+/// Returns the number of trailing zero bits of 'x', which should not be 0.
+inline unsigned CountTrailingZeros(std::size_t x) noexcept {
+#ifdef AMC_CXX20
+  return static_cast<unsigned>(std::countr_zero(x));
+#elif defined(__GNUC__)
+  return static_cast<unsigned>(__builtin_ctzll(static_cast<unsigned long long>(x)));
+#else
+  unsigned ret = 0;
+  for (; (x & 1U) == 0; x >>= 1) {
+    ++ret;
+  }
+  return ret;
+#endif
+}
+
+/// Given the index 'k' of a leaf's child (that is, the index reached at the end of a descent, which is greater than
+/// 'n'), returns the index of the last ancestor from which we went left, or 0 if we always went right.
+inline std::size_t ResolveDescent(std::size_t k) noexcept { return k >> (CountTrailingZeros(~k) + 1U); }
+
+/// Returns the index of the first element in sorted order, or 0 if 'n' is 0.
+inline std::size_t First(std::size_t n) noexcept {
+  if (n == 0) {
+    return 0;
+  }
+  std::size_t k = 1;
+  while (2 * k <= n) {
+    k *= 2;
+  }
+  return k;
+}
+
+/// Returns the index of the last element in sorted order, or 0 if 'n' is 0.
+inline std::size_t Last(std::size_t n) noexcept {
+  if (n == 0) {
+    return 0;
+  }
+  std::size_t k = 1;
+  while (2 * k + 1 <= n) {
+    k = 2 * k + 1;
+  }
+  return k;
+}
+
+/// Returns the index of the element following 'k' in sorted order, or 0 if 'k' is the last one.
+inline std::size_t Next(std::size_t k, std::size_t n) noexcept {
+  if (2 * k + 1 <= n) {
+    // leftmost element of right sub tree
+    k = 2 * k + 1;
+    while (2 * k <= n) {
+      k *= 2;
+    }
+    return k;
+  }
+  // go up as long as we are a right child, and once more
+  return ResolveDescent(k);
+}
+
+/// Returns the index of the element preceding 'k' in sorted order, or 0 if 'k' is the first one.
+/// Previous element of 0 (the end position) is the last element.
+inline std::size_t Prev(std::size_t k, std::size_t n) noexcept {
+  if (k == 0) {
+    return Last(n);
+  }
+  if (2 * k <= n) {
+    // rightmost element of left sub tree
+    k = 2 * k;
+    while (2 * k + 1 <= n) {
+      k = 2 * k + 1;
+    }
+    return k;
+  }
+  // go up as long as we are a left child, and once more
+  return k >> (CountTrailingZeros(k) + 1U);
+}
+
+/**
+ * Bidirectional iterator over elements stored in Eytzinger layout, visiting them in sorted order.
+ * Note: std::iterator is deprecated in c++17 so let's not derive from it.
+ */
+template <class T>
+class Iterator {
+ public:
+  // Needed types for iterators
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = const T &;
+
+  // From C++20, an iterator must be default constructible to comply with ranges concepts.
+  Iterator() noexcept = default;
+
+  Iterator(const T *data, std::size_t n, std::size_t k) noexcept : _data(data), _n(n), _k(k) {}
+
+  Iterator &operator++() noexcept {  // Prefix increment
+    _k = Next(_k, _n);
+    return *this;
+  }
+
+  Iterator &operator--() noexcept {  // Prefix decrement
+    _k = Prev(_k, _n);
+    return *this;
+  }
+
+  Iterator operator++(int) noexcept {  // Postfix increment
+    Iterator oldSelf = *this;
+    ++*this;
+    return oldSelf;
+  }
+
+  Iterator operator--(int) noexcept {  // Postfix decrement
+    Iterator oldSelf = *this;
+    --*this;
+    return oldSelf;
+  }
+
+  reference operator*() const noexcept { return _data[_k - 1]; }
+  pointer operator->() const noexcept { return _data + (_k - 1); }
+
+  bool operator==(const Iterator &o) const noexcept { return _k == o._k; }
+  bool operator!=(const Iterator &o) const noexcept { return !(*this == o); }
+
+ private:
+  const T *_data = nullptr;
+  std::size_t _n = 0;
+  std::size_t _k = 0;
+};
+
+}  // namespace eytzinger
+
+/**
+ * Immutable set optimized for lookups, built from a sorted range of unique elements (typically a FlatSet).
+ * Elements are laid out in Eytzinger (breadth first) order instead of sorted order:
+ *  - the first levels of the implicit binary search tree are packed together at the beginning of the storage
+ *    and stay hot in cache
+ *  - the search loop is branchless (the comparison result is used to compute the next index)
+ *  - as the descendants of a node at a given depth are contiguous in memory, the cache line of the
+ *    descendants a few levels below is prefetched while comparing with the current node.
+ *
+ * In exchange, iteration in sorted order is slower (bidirectional iterators, no random access)
+ * and the set cannot be modified once constructed, apart from being cleared, assigned or swapped.
+ *
+ * Consider it for large sets (not fitting in L2 cache) built once and then mostly queried.
+ *
+ * It does not allow duplicated elements.
+ * Elements a, b are considered the same if !Compare(a, b) && !Compare(b, a)
+ */
+template <class T, class Compare = std::less<T>, class Alloc = amc::allocator<T>, class VecType = amc::vector<T, Alloc>>
+class StaticSearchSet : private Compare {
+ public:
+  using key_type = T;
+  using value_type = T;
+  using difference_type = ptrdiff_t;
+  using size_type = typename VecType::size_type;
+  using iterator = eytzinger::Iterator<T>;
+  using const_iterator = iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = reverse_iterator;
+  using const_reference = typename VecType::const_reference;
+  using reference = const_reference;
+  using pointer = typename VecType::const_pointer;
+  using const_pointer = typename VecType::const_pointer;
+  using key_compare = Compare;
+  using value_compare = Compare;
+  using allocator_type = Alloc;
+  using flat_set_type = FlatSet<T, Compare, Alloc, VecType>;
+
+  static_assert(std::is_same<T, typename VecType::value_type>::value, "Vector value type should be T");
+  static_assert(std::is_same<Alloc, typename VecType::allocator_type>::value, "Allocator should match vector's");
+
+  using trivially_relocatable =
+      typename std::conditional<is_trivially_relocatable<Compare>::value && is_trivially_relocatable<VecType>::value,
+                                std::true_type, std::false_type>::type;
+
+  key_compare key_comp() const { return *this; }
+  value_compare value_comp() const { return *this; }
+  allocator_type get_allocator() const { return _vec.get_allocator(); }
+
+  StaticSearchSet() noexcept(std::is_nothrow_default_constructible<Compare>::value &&
+                             std::is_nothrow_default_constructible<VecType>::value) = default;
+
+  explicit StaticSearchSet(const Compare &comp, const Alloc &alloc = Alloc()) : Compare(comp), _vec(alloc) {}
+
+  explicit StaticSearchSet(const Alloc &alloc) : _vec(alloc) {}
+
+  template <class InputIt>
+  StaticSearchSet(InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _vec(alloc) {
+    VecType sorted(first, last, alloc);
+    std::sort(sorted.begin(), sorted.end(), comp);
+    flat::EraseDuplicates(sorted, compRef());
+    layout(sorted);
+  }
+
+  template <class InputIt>
+  StaticSearchSet(InputIt first, InputIt last, const Alloc &alloc) : StaticSearchSet(first, last, Compare(), alloc) {}
+
+  StaticSearchSet(std::initializer_list<value_type> list, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : StaticSearchSet(list.begin(), list.end(), comp, alloc) {}
+
+  StaticSearchSet(std::initializer_list<value_type> list, const Alloc &alloc)
+      : StaticSearchSet(list, Compare(), alloc) {}
+
+  /// Builds a StaticSearchSet from the elements of given FlatSet, which are already sorted.
+  explicit StaticSearchSet(const flat_set_type &s) : Compare(s.key_comp()), _vec(s.get_allocator()) {
+    VecType sorted(s.begin(), s.end(), s.get_allocator());
+    layout(sorted);
+  }
+
+  StaticSearchSet(const StaticSearchSet &o, const Alloc &alloc) : Compare(o.key_comp()), _vec(o._vec, alloc) {}
+
+  StaticSearchSet(StaticSearchSet &&o, const Alloc &alloc) : Compare(o.key_comp()), _vec(std::move(o._vec), alloc) {}
+
+#ifdef AMC_NONSTD_FEATURES
+  using vector_type = VecType;
+
+  /// Non standard constructor of a StaticSearchSet from a FlatSet, stealing its elements.
+  explicit StaticSearchSet(flat_set_type &&s) : Compare(s.key_comp()), _vec(s.get_allocator()) {
+    VecType sorted = s.steal_vector();
+    layout(sorted);
+  }
+
+  /// Non standard constructor of a StaticSearchSet from a Vector.
+  explicit StaticSearchSet(vector_type &&v, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+      : Compare(comp), _vec(alloc) {
+    if (std::adjacent_find(v.begin(), v.end(), [&comp](const T &lhs, const T &rhs) { return !comp(lhs, rhs); }) !=
+        v.end()) {
+      std::sort(v.begin(), v.end(), comp);
+      flat::EraseDuplicates(v, compRef());
+    }
+    layout(v);
+  }
+#endif
+
+  StaticSearchSet &operator=(std::initializer_list<value_type> list) {
+    *this = StaticSearchSet(list, key_comp(), get_allocator());
+    return *this;
+  }
+
+  const_iterator begin() const noexcept { return const_iterator(_vec.data(), n(), eytzinger::First(n())); }
+  const_iterator end() const noexcept { return const_iterator(_vec.data(), n(), 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+#ifdef AMC_NONSTD_FEATURES
+  /// Elements in Eytzinger order.
+  const_pointer data() const noexcept { return _vec.data(); }
+#endif
+
+  bool empty() const noexcept { return _vec.empty(); }
+  size_type size() const noexcept { return _vec.size(); }
+  size_type max_size() const noexcept { return _vec.max_size(); }
+
+  void clear() noexcept { _vec.clear(); }
+
+  const_iterator find(const_reference k) const { return const_iterator(_vec.data(), n(), findIdx(k)); }
+
+  bool contains(const_reference k) const { return findIdx(k) != 0; }
+
+  size_type count(const_reference k) const { return contains(k); }
+
+  const_iterator lower_bound(const_reference k) const { return const_iterator(_vec.data(), n(), lowerBoundIdx(k)); }
+  const_iterator upper_bound(const_reference k) const { return const_iterator(_vec.data(), n(), upperBoundIdx(k)); }
+
+  std::pair<const_iterator, const_iterator> equal_range(const_reference k) const { return equalRange(k); }
+
+#ifdef AMC_CXX14
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator find(const K &k) const {
+    return const_iterator(_vec.data(), n(), findIdx(k));
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  bool contains(const K &k) const {
+    return findIdx(k) != 0;
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  size_type count(const K &k) const {
+    return contains(k);
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator lower_bound(const K &k) const {
+    return const_iterator(_vec.data(), n(), lowerBoundIdx(k));
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  const_iterator upper_bound(const K &k) const {
+    return const_iterator(_vec.data(), n(), upperBoundIdx(k));
+  }
+
+  template <class K, typename std::enable_if<!std::is_same<T, K>::value && has_is_transparent<Compare>::value,
+                                             bool>::type = true>
+  std::pair<const_iterator, const_iterator> equal_range(const K &k) const {
+    return equalRange(k);
+  }
+#endif
+
+  /// Returns a FlatSet with the same elements.
+  flat_set_type to_flat_set() const { return flat_set_type(begin(), end(), key_comp(), get_allocator()); }
+
+  // Same elements give the same layout, so equality can be checked directly on the underlying vectors.
+  bool operator==(const StaticSearchSet &o) const { return _vec == o._vec; }
+  bool operator!=(const StaticSearchSet &o) const { return !(*this == o); }
+
+#ifdef AMC_CXX20
+  auto operator<=>(const StaticSearchSet &o) const {
+    return std::lexicographical_compare_three_way(begin(), end(), o.begin(), o.end());
+  }
+#else
+  bool operator<(const StaticSearchSet &o) const {
+    return std::lexicographical_compare(begin(), end(), o.begin(), o.end());
+  }
+  bool operator<=(const StaticSearchSet &o) const { return !(o < *this); }
+  bool operator>(const StaticSearchSet &o) const { return o < *this; }
+  bool operator>=(const StaticSearchSet &o) const { return !(*this < o); }
+#endif
+
+  void swap(StaticSearchSet &o) noexcept(noexcept(std::declval<VecType>().swap(std::declval<VecType &>())) &&
+                                         amc::is_nothrow_swappable<Compare>::value) {
+    std::swap(static_cast<Compare &>(*this), static_cast<Compare &>(o));
+    _vec.swap(o._vec);
+  }
+
+ private:
+  /// Number of elements fitting in a cache line, rounded down to a power of two (and at least 2).
+  /// Descendants of node k (1-based), log2(kPrefetchStride) levels below, are nodes
+  /// [k * kPrefetchStride, (k + 1) * kPrefetchStride), stored at 0-based positions shifted by one.
+  /// As the storage is not aligned on cache lines, this block of at most 64 bytes generally spans two cache lines.
+  static constexpr std::size_t kPrefetchStride =
+      sizeof(T) <= 4 ? 16 : (sizeof(T) <= 8 ? 8 : (sizeof(T) <= 16 ? 4 : 2));
+
+  const Compare &compRef() const noexcept { return *this; }
+
+  std::size_t n() const noexcept { return static_cast<std::size_t>(_vec.size()); }
+
+  /// Under this size (in bytes), elements are expected to stay in cache and prefetching would only cost instructions.
+  static constexpr std::size_t kPrefetchMinBytes = 64UL * 1024UL;
+
+  /// Branchless descent: 'Less' tells whether we should go right at current node.
+  /// Returns the Eytzinger index of the first element for which 'Less' is false, or 0 if there is none.
+  template <class Less>
+  std::size_t descend(Less less) const {
+    const T *data = _vec.data();
+    const std::size_t nbElems = n();
+    std::size_t k = 1;
+    if (nbElems * sizeof(T) < kPrefetchMinBytes) {
+      while (k <= nbElems) {
+        k = 2 * k + static_cast<std::size_t>(less(data[k - 1]));
+      }
+      return eytzinger::ResolveDescent(k);
+    }
+    while (k <= nbElems) {
+      // Prefetch both cache lines holding the descendants block (the same one if it does not cross a line)
+      AMC_PREFETCH(data + (std::min(k * kPrefetchStride, nbElems) - 1U));
+      AMC_PREFETCH(data + (std::min((k + 1U) * kPrefetchStride, nbElems + 1U) - 2U));
+      k = 2 * k + static_cast<std::size_t>(less(data[k - 1]));
+    }
+    return eytzinger::ResolveDescent(k);
+  }
+
+  template <class K>
+  std::size_t lowerBoundIdx(const K &k) const {
+    const Compare &comp = compRef();
+    return descend([&comp, &k](const T &v) { return comp(v, k); });
+  }
+
+  template <class K>
+  std::size_t upperBoundIdx(const K &k) const {
+    const Compare &comp = compRef();
+    return descend([&comp, &k](const T &v) { return !comp(k, v); });
+  }
+
+  template <class K>
+  std::size_t findIdx(const K &k) const {
+    std::size_t idx = lowerBoundIdx(k);
+    return idx == 0 || compRef()(k, _vec[static_cast<size_type>(idx - 1U)]) ? 0 : idx;
+  }
+
+  template <class K>
+  std::pair<const_iterator, const_iterator> equalRange(const K &k) const {
+    const_iterator first(_vec.data(), n(), lowerBoundIdx(k));
+    const_iterator last = first;
+    if (last != end() && !compRef()(k, *last)) {
+      ++last;
+    }
+    return std::pair<const_iterator, const_iterator>(first, last);
+  }
+
+  /// Fills the underlying vector with the elements of 'sorted' (sorted & unique), in Eytzinger order.
+  void layout(VecType &sorted) {
+    const std::size_t nbElems = static_cast<std::size_t>(sorted.size());
+    // Compute for each Eytzinger position the rank in sorted order thanks to an in-order traversal
+    amc::vector<std::size_t> ranks(nbElems);
+    std::size_t k = eytzinger::First(nbElems);
+    for (std::size_t rank = 0; rank < nbElems; ++rank, k = eytzinger::Next(k, nbElems)) {
+      ranks[static_cast<uint32_t>(k - 1U)] = rank;
+    }
+    _vec.clear();
+    _vec.reserve(sorted.size());
+    for (std::size_t rank : ranks) {
+      _vec.push_back(std::move(sorted[static_cast<size_type>(rank)]));
+    }
+  }
+
+  VecType _vec;
+};
+
+template <class T, class Compare, class Alloc, class VecType>
+inline void swap(StaticSearchSet<T, Compare, Alloc, VecType> &lhs, StaticSearchSet<T, Compare, Alloc, VecType> &rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace amc
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "config.hpp"
+
+namespace amc {
+
+/// Copy of the allocation statistics of a tag at some point in time (see AllocationStats).
+/// Histograms count sizes in bytes by power of 2: bucket i counts sizes in [2^i, 2^(i+1)) (and 0 in bucket 0).
+struct AllocationStatsSnapshot {
+  static constexpr size_t kNbBuckets = 64;
+
+  uint64_t nbReallocations() const noexcept { return nbInPlaceReallocations + nbMovedReallocations; }
+
+  /// Ratio of reallocations (and expansions) keeping the block in place, in [0, 1].
+  double inPlaceReallocationRatio() const noexcept {
+    return nbReallocations() == 0 ? 0.0 : static_cast<double>(nbInPlaceReallocations) / nbReallocations();
+  }
+
+  uint64_t nbAllocations;
+  uint64_t nbDeallocations;
+  uint64_t nbInPlaceReallocations;
+  uint64_t nbMovedReallocations;
+  uint64_t allocatedBytes;  ///< Cumulated size of allocations and growths of reallocated blocks
+  uint64_t liveBytes;       ///< Size of the blocks not freed yet
+  uint64_t peakLiveBytes;
+  uint64_t allocationSizes[kNbBuckets];    ///< Sizes of allocated blocks
+  uint64_t reallocationSizes[kNbBuckets];  ///< New sizes of reallocated blocks (growth of containers)
+  uint64_t deallocationSizes[kNbBuckets];  ///< Sizes of freed blocks (final capacities of containers)
+};
+
+/**
+ * Allocation counters, updated with relaxed atomics so that they can be shared by all threads at low cost.
+ * They are only eventually consistent with each other, which is fine for statistics.
+ */
+class AllocationCounters {
+ public:
+  static constexpr size_t kNbBuckets = AllocationStatsSnapshot::kNbBuckets;
+
+  /// Index of the histogram bucket of 'n' bytes.
+  static size_t SizeBucket(size_t n) noexcept {
+#ifdef __GNUC__
+    return n == 0 ? 0 : 63 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(n)));
+#else
+    size_t bucket = 0;
+    for (; n > 1; n /= 2) {
+      ++bucket;
+    }
+    return bucket;
+#endif
+  }
+
+  void recordAllocation(size_t n) noexcept {
+    Incr(_nbAllocations);
+    Incr(_allocationSizes[SizeBucket(n)]);
+    _allocatedBytes.fetch_add(n, std::memory_order_relaxed);
+    addLiveBytes(n);
+  }
+
+  void recordReallocation(size_t oldSz, size_t newSz, bool inPlace) noexcept {
+    Incr(inPlace ? _nbInPlaceReallocations : _nbMovedReallocations);
+    Incr(_reallocationSizes[SizeBucket(newSz)]);
+    if (newSz > oldSz) {
+      _allocatedBytes.fetch_add(newSz - oldSz, std::memory_order_relaxed);
+    }
+    // Unsigned wrap around subtracts the shrunk bytes
+    addLiveBytes(static_cast<uint64_t>(newSz) - static_cast<uint64_t>(oldSz));
+  }
+
+  /// A block could not be expanded in place to 'newSz' bytes: it will be moved to a new block, whose allocation (and
+  /// deallocation of the old one) are recorded separately.
+  void recordExpansionFailure(size_t newSz) noexcept {
+    Incr(_nbMovedReallocations);
+    Incr(_reallocationSizes[SizeBucket(newSz)]);
+  }
+
+  void recordDeallocation(size_t n) noexcept {
+    Incr(_nbDeallocations);
+    Incr(_deallocationSizes[SizeBucket(n)]);
+    _liveBytes.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  AllocationStatsSnapshot snapshot() const noexcept {
+    AllocationStatsSnapshot res;
+    res.nbAllocations = Load(_nbAllocations);
+    res.nbDeallocations = Load(_nbDeallocations);
+    res.nbInPlaceReallocations = Load(_nbInPlaceReallocations);
+    res.nbMovedReallocations = Load(_nbMovedReallocations);
+    res.allocatedBytes = Load(_allocatedBytes);
+    res.liveBytes = Load(_liveBytes);
+    res.peakLiveBytes = Load(_peakLiveBytes);
+    for (size_t bucket = 0; bucket < kNbBuckets; ++bucket) {
+      res.allocationSizes[bucket] = Load(_allocationSizes[bucket]);
+      res.reallocationSizes[bucket] = Load(_reallocationSizes[bucket]);
+      res.deallocationSizes[bucket] = Load(_deallocationSizes[bucket]);
+    }
+    return res;
+  }
+
+  /// Resets all counters, typically at the start of a profiling window.
+  /// Live bytes are reset as well, so they may wrap around if blocks allocated before are freed after.
+  void reset() noexcept {
+    for (std::atomic<uint64_t> *counter :
+         {&_nbAllocations, &_nbDeallocations, &_nbInPlaceReallocations, &_nbMovedReallocations, &_allocatedBytes,
+          &_liveBytes, &_peakLiveBytes}) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+    for (size_t bucket = 0; bucket < kNbBuckets; ++bucket) {
+      _allocationSizes[bucket].store(0, std::memory_order_relaxed);
+      _reallocationSizes[bucket].store(0, std::memory_order_relaxed);
+      _deallocationSizes[bucket].store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static void Incr(std::atomic<uint64_t> &counter) noexcept { counter.fetch_add(1, std::memory_order_relaxed); }
+
+  static uint64_t Load(const std::atomic<uint64_t> &counter) noexcept {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  void addLiveBytes(uint64_t n) noexcept {
+    const uint64_t liveBytes = _liveBytes.fetch_add(n, std::memory_order_relaxed) + n;
+    uint64_t peak = _peakLiveBytes.load(std::memory_order_relaxed);
+    while (liveBytes > peak && liveBytes < (uint64_t(1) << 63) &&
+           !_peakLiveBytes.compare_exchange_weak(peak, liveBytes, std::memory_order_relaxed)) {
+    }
+  }
+
+  std::atomic<uint64_t> _nbAllocations{0};
+  std::atomic<uint64_t> _nbDeallocations{0};
+  std::atomic<uint64_t> _nbInPlaceReallocations{0};
+  std::atomic<uint64_t> _nbMovedReallocations{0};
+  std::atomic<uint64_t> _allocatedBytes{0};
+  std::atomic<uint64_t> _liveBytes{0};
+  std::atomic<uint64_t> _peakLiveBytes{0};
+  std::atomic<uint64_t> _allocationSizes[kNbBuckets]{};
+  std::atomic<uint64_t> _reallocationSizes[kNbBuckets]{};
+  std::atomic<uint64_t> _deallocationSizes[kNbBuckets]{};
+};
+
+/// Singleton giving access to the allocation counters of containers using StatsAllocator of given 'Tag' type.
+template <class Tag = void>
+struct AllocationStats {
+  static AllocationCounters &instance() {
+    static AllocationCounters counters;
+    return counters;
+  }
+
+  static AllocationStatsSnapshot snapshot() noexcept { return instance().snapshot(); }
+
+  static void reset() noexcept { instance().reset(); }
+};
+
+/**
+ * Basic allocator recording statistics of the allocations of 'BasicAllocator' in AllocationStats<Tag>.
+ * Tags identify the containers to profile, like a type per container kind, so that real traffic tells how many
+ * allocations they make and the sizes they reach (to size inline capacities of SmallVector, for instance).
+ *
+ * It provides the optional methods of 'BasicAllocator' ('_at_least' ones recording the real size of the blocks), and
+ * always provides 'try_expand' (failing if 'BasicAllocator' does not provide it), so that vectors of non trivially
+ * relocatable types report their reallocations as well: moved ones then also count an allocation and a deallocation.
+ *
+ * See stats_allocator, which can be compiled out with AMC_NO_ALLOCATION_STATS.
+ */
+template <class Tag = void, class BasicAllocator = SimpleAllocator>
+class StatsAllocator : private BasicAllocator {
+ public:
+  StatsAllocator() = default;
+
+  explicit StatsAllocator(const BasicAllocator &basicAlloc) : BasicAllocator(basicAlloc) {}
+
+  const BasicAllocator &basic_allocator() const noexcept { return *this; }
+
+  void *allocate(size_t n) {
+    void *p = BasicAllocator::allocate(n);
+    Counters().recordAllocation(n);
+    return p;
+  }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    void *newPtr = BasicAllocator::reallocate(p, oldSz, newSz);
+    RecordReallocation(p, oldSz, newPtr, newSz);
+    return newPtr;
+  }
+
+  /// Only whole elements of 'elemSize' bytes are used from the block (and then freed), so the returned usable size is
+  /// rounded down to a multiple of it, to record the same number of bytes as the following deallocation.
+  template <class B = BasicAllocator>
+  auto allocate_at_least(size_t n, size_t elemSize = 1) -> decltype(std::declval<B &>().allocate_at_least(n)) {
+    auto res = BasicAllocator::allocate_at_least(n);
+    res.count -= res.count % elemSize;
+    Counters().recordAllocation(res.count);
+    return res;
+  }
+
+  template <class B = BasicAllocator>
+  auto reallocate_at_least(void *p, size_t oldSz, size_t newSz, size_t elemSize = 1)
+      -> decltype(std::declval<B &>().reallocate_at_least(p, oldSz, newSz)) {
+    auto res = BasicAllocator::reallocate_at_least(p, oldSz, newSz);
+    res.count -= res.count % elemSize;
+    RecordReallocation(p, oldSz, res.ptr, res.count);
+    return res;
+  }
+
+  bool try_expand(void *p, size_t oldSz, size_t newSz) {
+    if (TryExpand(static_cast<BasicAllocator &>(*this), p, oldSz, newSz)) {
+      Counters().recordReallocation(oldSz, newSz, true);
+      return true;
+    }
+    Counters().recordExpansionFailure(newSz);
+    return false;
+  }
+
+  void deallocate(void *p, size_t n) {
+    BasicAllocator::deallocate(p, n);
+    if (p) {
+      Counters().recordDeallocation(n);
+    }
+  }
+
+  friend bool operator==(const StatsAllocator &lhs, const StatsAllocator &rhs) noexcept {
+    return memory_details::AreEqualBasicAllocators(lhs.basic_allocator(), rhs.basic_allocator());
+  }
+  friend bool operator!=(const StatsAllocator &lhs, const StatsAllocator &rhs) noexcept { return !(lhs == rhs); }
+
+ private:
+  static AllocationCounters &Counters() { return AllocationStats<Tag>::instance(); }
+
+  static void RecordReallocation(void *p, size_t oldSz, void *newPtr, size_t newSz) {
+    if (p) {
+      Counters().recordReallocation(oldSz, newSz, newPtr == p);
+    } else {
+      Counters().recordAllocation(newSz);
+    }
+  }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<memory_details::has_basic_try_expand<B>::value, bool>::type TryExpand(
+      BasicAllocator &basicAlloc, void *p, size_t oldSz, size_t newSz) {
+    return basicAlloc.try_expand(p, oldSz, newSz);
+  }
+
+  template <class B = BasicAllocator>
+  static typename std::enable_if<!memory_details::has_basic_try_expand<B>::value, bool>::type TryExpand(
+      BasicAllocator &, void *, size_t, size_t) {
+    return false;
+  }
+};
+
+/// Standard (STL conformant) allocator recording statistics of its allocations in AllocationStats<Tag>, on top of
+/// 'BasicAllocator'. If AMC_NO_ALLOCATION_STATS is defined, it is the standard allocator of 'BasicAllocator', without
+/// any overhead (statistics then stay empty).
+#ifdef AMC_NO_ALLOCATION_STATS
+template <class T, class Tag = void, class BasicAllocator = SimpleAllocator>
+using stats_allocator = BasicAllocatorWrapper<T, BasicAllocator>;
+#else
+template <class T, class Tag = void, class BasicAllocator = SimpleAllocator>
+using stats_allocator = BasicAllocatorWrapper<T, StatsAllocator<Tag, BasicAllocator>>;
+#endif
+}  // namespace amc
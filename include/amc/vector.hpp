@@ -16,13 +16,16 @@ namespace amc {
  *           all combinations are possible between the 3 types of vectors.
  *           Note that implementation is not noexcept, adjust capacity needs to be called for both operands.
  *
- * In addition, size_type can be configured and is uint32_t by default.
+ * In addition, size_type can be configured and is uint32_t by default, as well as the growth of the capacity with
+ * 'GrowingPolicy' (1.5 factor by default, see SmallVector).
  *
  * If 'Alloc' provides this additional optional method
  *  * T *reallocate(pointer p, size_type oldCapacity, size_type newCapacity, size_type nConstructedElems);
  *
  * then it will be able use it to optimize the growing of the container when T is trivially relocatable
  * (for amc::allocator, it will use 'realloc').
+ * Optional 'allocate_at_least' and 'reallocate_at_least' methods are used as well when growing, to record the real
+ * capacity of the allocated blocks (see SmallVector).
  *
  * Exception safety:
  *   It provides at least Basic exception safety.
@@ -32,6 +35,7 @@ namespace amc {
  *     - insert from count elements
  *   If Object movement can throw, only 'push_back' and 'emplace_back' modifiers provide strong exception warranty
  */
-template <class T, class Alloc = amc::allocator<T>, class SizeType = uint32_t>
-using vector = SmallVector<T, 0U, Alloc, SizeType>;
+template <class T, class Alloc = amc::allocator<T>, class SizeType = uint32_t,
+          class GrowingPolicy = vec::DynamicGrowingPolicy>
+using vector = SmallVector<T, 0U, Alloc, SizeType, GrowingPolicy>;
 }  // namespace amc
@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <cstring>
 #include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <stdexcept>
 
@@ -21,7 +22,20 @@
 #endif
 #endif
 
+#ifdef AMC_SMALLVECTOR_PROFILING
+#include "inlinecapacityadvisor.hpp"
+#endif
+
 namespace amc {
+
+#ifdef AMC_SMALLVECTOR_PROFILING
+template <class T, class Alloc, class SizeType, class GrowingPolicy, SizeType N>
+class Vector;
+#endif
+
+template <class T, std::size_t ChunkSize, class Alloc>
+class SegmentedVector;
+
 namespace vec {
 template <class T>
 struct is_swap_noexcept : std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value &&
@@ -34,6 +48,11 @@ template <class T>
 struct is_move_construct_nothrow : std::integral_constant<bool, amc::is_trivially_relocatable<T>::value ||
                                                                     std::is_nothrow_move_constructible<T>::value> {};
 
+/// Smallest power of 2 greater or equal to 'n'.
+constexpr uintmax_t NextPowerOf2(uintmax_t n, uintmax_t pow2 = 1U) {
+  return pow2 >= n ? pow2 : NextPowerOf2(n, 2U * pow2);
+}
+
 /// Shift 'n' elements starting at 'first' one slot to the right
 /// Requirements: n != 0, with uninitialized memory starting at 'first + n'
 /// Warning: no destroy is called for elements which has been moved from.
@@ -414,6 +433,25 @@ void SwapDynStorage(T *&lhs, T *&rhs) {
 
 struct EmptyAlloc {};
 
+/// Tells whether dynamic storage allocated by 'lhs' can be freed by 'rhs' (and vice versa).
+/// Stateless allocators are always equal, without requiring a comparison operator (like EmptyAlloc).
+template <class Alloc>
+constexpr typename std::enable_if<std::is_empty<Alloc>::value, bool>::type AreEqualAllocators(const Alloc &,
+                                                                                             const Alloc &) noexcept {
+  return true;
+}
+
+template <class Alloc>
+typename std::enable_if<!std::is_empty<Alloc>::value, bool>::type AreEqualAllocators(const Alloc &lhs,
+                                                                                    const Alloc &rhs) noexcept {
+  return lhs == rhs;
+}
+
+template <class Alloc, class OAlloc>
+constexpr bool AreEqualAllocators(const Alloc &, const OAlloc &) noexcept {
+  return false;
+}
+
 template <class T, class SizeType>
 class StaticVectorBase {
  public:
@@ -438,6 +476,10 @@ class StaticVectorBase {
 
   StaticVectorBase(SizeType inplaceCapa, const EmptyAlloc &) noexcept : _capa(inplaceCapa), _size(0) {}
 
+#ifdef AMC_SMALLVECTOR_PROFILING
+  void setInlineSizeProfile(InlineSizeCounters &) noexcept {}
+#endif
+
   void swap_impl(StaticVectorBase &o) noexcept(is_swap_noexcept<T>::value) {
     swap_deep(begin(), _size, o.begin(), o._size);
     std::swap(_size, o._size);
@@ -503,7 +545,13 @@ class StdVectorBase : private Alloc {
 
   StdVectorBase(SizeType, const Alloc &alloc) noexcept : Alloc(alloc) {}
 
+#ifdef AMC_SMALLVECTOR_PROFILING
+  void setInlineSizeProfile(InlineSizeCounters &) noexcept {}
+#endif
+
   void swap_impl(StdVectorBase &o) noexcept {
+    // Allocators are not swapped: as for standard containers, they should be equal
+    assert(AreEqualAllocators(get_allocator(), o.get_allocator()));
     std::swap(_storage, o._storage);
     std::swap(_capa, o._capa);
     std::swap(_size, o._size);
@@ -525,6 +573,7 @@ class StdVectorBase : private Alloc {
     _size = amc::exchange(o._size, 0);
   }
 
+  template <class GrowingPolicy>
   void grow(uintmax_t minSize, bool exact = false);
 
   void shrink_impl(SizeType) noexcept {
@@ -547,8 +596,8 @@ class StdVectorBase : private Alloc {
   bool canSwapDynStorage(SmallVectorBase<T, OAlloc, OSizeType> &o) const noexcept;
 
   template <class OSizeType, class OAlloc>
-  bool canSwapDynStorage(StdVectorBase<T, OAlloc, OSizeType> &) const noexcept {
-    return std::is_same<OAlloc, Alloc>::value;
+  bool canSwapDynStorage(StdVectorBase<T, OAlloc, OSizeType> &o) const noexcept {
+    return AreEqualAllocators(get_allocator(), o.get_allocator());
   }
 
   template <class VectorType>
@@ -607,6 +656,11 @@ class SmallVectorBase : private Alloc {
   }
 
   ~SmallVectorBase() {
+#ifdef AMC_SMALLVECTOR_PROFILING
+    if (_inlineSizeProfile && _recorded) {
+      _inlineSizeProfile->record(_maxSize, _leftSmall);
+    }
+#endif
     if (!isSmall()) {
       freeStorage();
     }
@@ -626,12 +680,44 @@ class SmallVectorBase : private Alloc {
 
   SmallVectorBase(SizeType inplaceCapa, const Alloc &alloc) noexcept : Alloc(alloc), _capa(0), _size(inplaceCapa) {}
 
+#ifdef AMC_SMALLVECTOR_PROFILING
+  /// Maximum size and whether dynamic storage has been used are recorded in 'profile' at destruction.
+  void setInlineSizeProfile(InlineSizeCounters &profile) noexcept { _inlineSizeProfile = &profile; }
+
+  void trackMaxSize() noexcept {
+    if (size() > _maxSize) {
+      _maxSize = size();
+      // A moved-from vector holding elements again is a real instance again
+      _recorded = true;
+    }
+    if (!isSmall()) {
+      _leftSmall = true;
+    }
+  }
+
+  /// On move, the history of 'o' follows its elements, and 'o' becomes an empty shell not recorded at destruction.
+  void takeSizeProfile(SmallVectorBase &o) noexcept {
+    if (o._maxSize > _maxSize) {
+      _maxSize = o._maxSize;
+    }
+    _leftSmall |= o._leftSmall;
+    o._maxSize = 0;
+    o._leftSmall = false;
+    o._recorded = false;
+  }
+#else
+  void trackMaxSize() noexcept {}
+  void takeSizeProfile(SmallVectorBase &) noexcept {}
+#endif
+
   /// As explained above, if _capa == _size == SizeType::max() then it's necessarily in a large state.
   bool isSmall() const noexcept { return _capa < _size; }
 
   /// swap_impl is called by public method 'swap' for same SmallVector (same number of inplace elements).
   /// No need to check / adjust capacity for small states then (no throw guaranteed).
   void swap_impl(SmallVectorBase &o) noexcept(is_swap_noexcept<T>::value) {
+    // Allocators are not swapped: as for standard containers, they should be equal if a dynamic storage is swapped
+    assert((isSmall() && o.isSmall()) || AreEqualAllocators(get_allocator(), o.get_allocator()));
     if (isSmall()) {
       if (o.isSmall()) {
         swap_deep(_storage.ptr(), _capa, o._storage.ptr(), o._capa);
@@ -647,6 +733,8 @@ class SmallVectorBase : private Alloc {
     }
     std::swap(_capa, o._capa);
     std::swap(_size, o._size);
+    trackMaxSize();
+    o.trackMaxSize();
   }
 
   void move_construct(SmallVectorBase &o, SizeType inplaceCapa) noexcept(is_move_construct_nothrow<T>::value) {
@@ -657,6 +745,8 @@ class SmallVectorBase : private Alloc {
     }
     _capa = amc::exchange(o._capa, 0);
     _size = amc::exchange(o._size, inplaceCapa);
+    takeSizeProfile(o);
+    trackMaxSize();
   }
 
   void move_construct(StdVectorBase<T, Alloc, SizeType> &o) noexcept {
@@ -666,6 +756,7 @@ class SmallVectorBase : private Alloc {
       o._storage = nullptr;
       _capa = amc::exchange(o._capa, 0);
       _size = amc::exchange(o._size, 0);
+      trackMaxSize();
     }
   }
 
@@ -691,8 +782,11 @@ class SmallVectorBase : private Alloc {
       _capa = amc::exchange(o._capa, 0);
       _size = amc::exchange(o._size, inplaceCapa);
     }
+    takeSizeProfile(o);
+    trackMaxSize();
   }
 
+  template <class GrowingPolicy>
   void grow(uintmax_t minSize, bool exact = false);
 
   void shrink_impl(SizeType inplaceCapa) {
@@ -712,8 +806,8 @@ class SmallVectorBase : private Alloc {
   friend class StdVectorBase;
 
   template <class OAlloc, class OSizeType>
-  bool canSwapDynStorage(StdVectorBase<T, OAlloc, OSizeType> &) const noexcept {
-    return std::is_same<OAlloc, Alloc>::value && !isSmall();
+  bool canSwapDynStorage(StdVectorBase<T, OAlloc, OSizeType> &o) const noexcept {
+    return !isSmall() && AreEqualAllocators(get_allocator(), o.get_allocator());
   }
   template <class OSizeType>
   bool canSwapDynStorage(StaticVectorBase<T, OSizeType> &) const noexcept {
@@ -721,7 +815,7 @@ class SmallVectorBase : private Alloc {
   }
   template <class OSizeType, class OAlloc>
   bool canSwapDynStorage(SmallVectorBase<T, OAlloc, OSizeType> &o) const noexcept {
-    return std::is_same<OAlloc, Alloc>::value && !isSmall() && !o.isSmall();
+    return !isSmall() && !o.isSmall() && AreEqualAllocators(get_allocator(), o.get_allocator());
   }
 
   template <class VectorType>
@@ -741,6 +835,7 @@ class SmallVectorBase : private Alloc {
     } else {
       (void)++_size;
     }
+    trackMaxSize();
   }
   void decrSize() noexcept {
     if (isSmall()) {
@@ -765,6 +860,7 @@ class SmallVectorBase : private Alloc {
     } else {
       _size = s;
     }
+    trackMaxSize();
   }
 
   /// Access to 'real' size member reference.
@@ -787,14 +883,21 @@ class SmallVectorBase : private Alloc {
   void resetToSmall(SizeType);
   void freeStorage() noexcept;
 
+#ifdef AMC_SMALLVECTOR_PROFILING
+  InlineSizeCounters *_inlineSizeProfile = nullptr;
+  SizeType _maxSize = 0;
+  bool _leftSmall = false;
+  bool _recorded = true;
+#endif
   SizeType _capa, _size;
+  // Should stay last, as inline elements of derived class follow it
   ElemWithPtrStorage<T> _storage;
 };
 
 template <class T, class Alloc, class SizeType>
 template <class OSizeType, class OAlloc>
 bool StdVectorBase<T, Alloc, SizeType>::canSwapDynStorage(SmallVectorBase<T, OAlloc, OSizeType> &o) const noexcept {
-  return std::is_same<OAlloc, Alloc>::value && !o.isSmall();
+  return !o.isSmall() && AreEqualAllocators(get_allocator(), o.get_allocator());
 }
 
 template <class T, class SizeType, class GrowingPolicy>
@@ -889,7 +992,7 @@ class StaticVector : public StaticVectorBase<T, SizeType> {
   template <class, class, class>
   friend class StaticVector;
 
-  template <class, class, class, bool>
+  template <class, class, class, bool, class>
   friend class DynamicVector;
 
   template <class VectorType>
@@ -929,7 +1032,7 @@ struct DynamicVectorBaseTypeDispatcher {
                                          StdVectorBase<T, Alloc, SizeType> >::type;
 };
 
-template <class T, class Alloc, class SizeType, bool WithInlineElements>
+template <class T, class Alloc, class SizeType, bool WithInlineElements, class GrowingPolicy>
 class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType, WithInlineElements>::type {
  public:
   using reference = T &;
@@ -942,7 +1045,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
 
   void reserve(size_type capacity) {
     if (this->capacity() < capacity) {
-      this->grow(capacity, true);  // Reserve with exact capacity
+      this->template grow<GrowingPolicy>(capacity, true);  // Reserve with exact capacity
     }
   }
 
@@ -956,7 +1059,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
       ElemStorage<T> e;
       amc::construct_at(e.ptr(), std::forward<Args &&>(args)...);
       SizeType idx = static_cast<SizeType>(position - this->begin());
-      this->grow(this->size() + 1U);
+      this->template grow<GrowingPolicy>(this->size() + 1U);
       pos = this->begin() + idx;
       if (nElemsToShift == 0) {
         amc::relocate_at(e.ptr(), pos);
@@ -984,7 +1087,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
       // construct before possible iterator invalidation from grow in constructor arguments
       ElemStorage<T> e;
       amc::construct_at(e.ptr(), std::forward<Args &&>(args)...);
-      this->grow(this->size() + 1U);
+      this->template grow<GrowingPolicy>(this->size() + 1U);
       endIt = this->dynStorage() + this->size();
       amc::relocate_at(e.ptr(), endIt);
     } else {
@@ -1003,7 +1106,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
   template <class, class, class>
   friend class StaticVector;
 
-  template <class, class, class, bool>
+  template <class, class, class, bool, class>
   friend class DynamicVector;
 
   template <class OSizeType, class OGrowingPolicy>
@@ -1013,8 +1116,8 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
     swap_sizetype(this->msize(), o.msize());
   }
 
-  template <class OAlloc, class OSizeType, bool OWithInlineElems>
-  void swap2_impl(DynamicVector<T, OAlloc, OSizeType, OWithInlineElems> &o) noexcept(is_swap_noexcept<T>::value) {
+  template <class OAlloc, class OSizeType, bool OWithInlineElems, class OGrowingPolicy>
+  void swap2_impl(DynamicVector<T, OAlloc, OSizeType, OWithInlineElems, OGrowingPolicy> &o) noexcept(is_swap_noexcept<T>::value) {
     if (this->canSwapDynStorage(o)) {
       this->swapDynStorage(o);
       swap_sizetype(this->mcapacity(), o.mcapacity());
@@ -1027,14 +1130,14 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
   // Adjust capacity methods take uintmax_t as parameter to check for size_type overflow
   inline void adjustCapacity(uintmax_t neededCapacity) {
     if (static_cast<uintmax_t>(this->capacity()) < neededCapacity) {
-      this->grow(neededCapacity);
+      this->template grow<GrowingPolicy>(neededCapacity);
     }
   }
 
   inline T *adjustCapacity(uintmax_t neededCapacity, const T *position) {
     if (static_cast<uintmax_t>(this->capacity()) < neededCapacity) {
       SizeType idx = static_cast<SizeType>(position - this->begin());  // pos will be invalidated
-      this->grow(neededCapacity);
+      this->template grow<GrowingPolicy>(neededCapacity);
       return this->begin() + idx;
     }
     return const_cast<T *>(position);
@@ -1044,7 +1147,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
     if (static_cast<uintmax_t>(this->capacity()) < neededCapacity) {
       const T *ptr = std::addressof(v);
       ptrdiff_t idx = ptr >= this->begin() && ptr < this->begin() + this->size() ? ptr - this->begin() : -1;
-      this->grow(neededCapacity);
+      this->template grow<GrowingPolicy>(neededCapacity);
       if (idx != -1) {
         return this->begin()[idx];
       }
@@ -1057,7 +1160,7 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
       const T *ptr = std::addressof(v);
       ptrdiff_t idx = ptr >= this->begin() && ptr < this->begin() + this->size() ? ptr - this->begin() : -1;
       SizeType itIdx = static_cast<SizeType>(*position - this->begin());  // pos will be invalidated
-      this->grow(neededCapacity);
+      this->template grow<GrowingPolicy>(neededCapacity);
       *position = this->begin() + itIdx;
       if (idx != -1) {
         return this->begin()[idx];
@@ -1079,13 +1182,68 @@ class DynamicVector : public DynamicVectorBaseTypeDispatcher<T, Alloc, SizeType,
   }
 };
 
-/// Standard growing policy which allows SmallVector to use dynamic memory
-struct DynamicGrowingPolicy {};
+/// Standard growing policy which allows SmallVector to use dynamic memory.
+/// Capacity grows by a factor 1.5, except if the minimum requested size is larger (it is chosen in this case).
+///
+/// Other growing policies of dynamic vectors derive from it and hide 'NextCapacity', which returns the new capacity
+/// (at least 'minSize') of a vector of elements of 'elemSize' bytes that needs to grow from capacity 'oldCapa'.
+struct DynamicGrowingPolicy {
+  static uintmax_t NextCapacity(uintmax_t oldCapa, uintmax_t minSize, std::size_t) {
+    return std::max(static_cast<uintmax_t>((3U * oldCapa + 1U) / 2U), minSize);
+  }
+};
+
+/// Capacity is doubled, for vectors known to grow large where the number of reallocations matters more than memory.
+struct DoublingGrowingPolicy : DynamicGrowingPolicy {
+  static uintmax_t NextCapacity(uintmax_t oldCapa, uintmax_t minSize, std::size_t) {
+    return std::max(2U * oldCapa, minSize);
+  }
+};
+
+/// Capacity grows by a factor 1.5, and is then rounded up to fill the size class of malloc implementations like
+/// jemalloc or tcmalloc (4 classes per power of 2, multiples of 16 bytes for small ones), as the rounding bytes would be
+/// lost otherwise.
+struct SizeClassGrowingPolicy : DynamicGrowingPolicy {
+  static uintmax_t NextCapacity(uintmax_t oldCapa, uintmax_t minSize, std::size_t elemSize) {
+    const uintmax_t capa = DynamicGrowingPolicy::NextCapacity(oldCapa, minSize, elemSize);
+    if (capa > std::numeric_limits<uintmax_t>::max() / 2U / elemSize) {
+      return capa;
+    }
+    const uintmax_t nbBytes = capa * elemSize;
+    uintmax_t sizeClassStep = 16U;
+    while (8U * sizeClassStep < nbBytes) {
+      sizeClassStep *= 2U;
+    }
+    return ((nbBytes + sizeClassStep - 1U) / sizeClassStep) * sizeClassStep / elemSize;
+  }
+};
+
+/// Capacity grows by a factor 1.5, and buffers larger than a page are rounded up to a whole number of pages, as large
+/// allocations are directly mapped by malloc implementations.
+struct PageGrowingPolicy : DynamicGrowingPolicy {
+  static constexpr uintmax_t kPageSize = 4096U;
+
+  static uintmax_t NextCapacity(uintmax_t oldCapa, uintmax_t minSize, std::size_t elemSize) {
+    const uintmax_t capa = DynamicGrowingPolicy::NextCapacity(oldCapa, minSize, elemSize);
+    if (capa > (std::numeric_limits<uintmax_t>::max() - kPageSize) / elemSize) {
+      return capa;
+    }
+    const uintmax_t nbBytes = capa * elemSize;
+    if (nbBytes <= kPageSize) {
+      return capa;
+    }
+    return ((nbBytes + kPageSize - 1U) / kPageSize) * kPageSize / elemSize;
+  }
+};
+
+/// Tells whether 'GrowingPolicy' is a growing policy of dynamic vectors (SmallVector, vector).
+template <class GrowingPolicy>
+struct is_dynamic_growing_policy : std::is_base_of<DynamicGrowingPolicy, GrowingPolicy> {};
 
 template <class T, class Alloc, class SizeType, bool WithInlineElements, class GrowingPolicy>
 struct VectorBaseTypeDispatcher {
-  using type = typename std::conditional<std::is_same<GrowingPolicy, DynamicGrowingPolicy>::value,
-                                         DynamicVector<T, Alloc, SizeType, WithInlineElements>,
+  using type = typename std::conditional<is_dynamic_growing_policy<GrowingPolicy>::value,
+                                         DynamicVector<T, Alloc, SizeType, WithInlineElements, GrowingPolicy>,
                                          StaticVector<T, SizeType, GrowingPolicy> >::type;
 };
 
@@ -1476,15 +1634,19 @@ class VectorWithInplaceStorage : public VectorImpl<T, Alloc, SizeType, true, Gro
  protected:
   template <class... Args>
   explicit VectorWithInplaceStorage(Args &&...args) noexcept
-      : VectorImpl<T, Alloc, SizeType, true, GrowingPolicy>(std::forward<Args &&>(args)...) {}
+      : VectorImpl<T, Alloc, SizeType, true, GrowingPolicy>(std::forward<Args &&>(args)...) {
+#ifdef AMC_SMALLVECTOR_PROFILING
+    this->setInlineSizeProfile(InlineSizeProfile<Vector<T, Alloc, SizeType, GrowingPolicy, N>>::instance());
+#endif
+  }
 
  private:
   ElemStorage<T>
-      _elems[N - (std::is_same<GrowingPolicy, DynamicGrowingPolicy>::value ? ElemWithPtrStorage<T>::kNbSlots : 1)];
+      _elems[N - (is_dynamic_growing_policy<GrowingPolicy>::value ? ElemWithPtrStorage<T>::kNbSlots : 1)];
 };
 
 template <class T, class GrowingPolicy, uintmax_t N>
-struct NoInlineStorage : std::integral_constant<bool, std::is_same<GrowingPolicy, DynamicGrowingPolicy>::value &&
+struct NoInlineStorage : std::integral_constant<bool, is_dynamic_growing_policy<GrowingPolicy>::value &&
                                                           (N <= ElemWithPtrStorage<T>::kNbSlots)> {};
 
 template <class T, class GrowingPolicy>
@@ -1500,7 +1662,11 @@ class VectorWithInplaceStorage<T, Alloc, SizeType, GrowingPolicy, N,
  protected:
   template <class... Args>
   explicit VectorWithInplaceStorage(Args &&...args) noexcept
-      : VectorImpl<T, Alloc, SizeType, (N != 0), GrowingPolicy>(std::forward<Args &&>(args)...) {}
+      : VectorImpl<T, Alloc, SizeType, (N != 0), GrowingPolicy>(std::forward<Args &&>(args)...) {
+#ifdef AMC_SMALLVECTOR_PROFILING
+    this->setInlineSizeProfile(InlineSizeProfile<Vector<T, Alloc, SizeType, GrowingPolicy, N>>::instance());
+#endif
+  }
 };
 
 template <uintmax_t N, class SizeType>
@@ -1517,12 +1683,12 @@ class Vector : public vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingP
   using Base = vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingPolicy, N>;
 
   /// Static checks to make sure of correct usage of this class
-  static_assert(!std::is_same<GrowingPolicy, vec::DynamicGrowingPolicy>::value ||
+  static_assert(!vec::is_dynamic_growing_policy<GrowingPolicy>::value ||
                     N < std::numeric_limits<SizeType>::max(),
                 "Invalid Vector: cannot grow, could be FixedCapacityVector. Use larger size_type or decrease "
                 "number of inline elements.");
 
-  static_assert(std::is_same<GrowingPolicy, vec::DynamicGrowingPolicy>::value ==
+  static_assert(vec::is_dynamic_growing_policy<GrowingPolicy>::value ==
                     !std::is_same<Alloc, vec::EmptyAlloc>::value,
                 "FixedCapacityVector should use EmptyAlloc");
 
@@ -1545,11 +1711,12 @@ class Vector : public vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingP
 
   Vector(size_type count, const_reference v, const Alloc &alloc = Alloc()) : Base(N, alloc) { this->append(count, v); }
 
-  Vector(const Vector &o) : Base(N) { this->append(o.begin(), o.end()); }
+  // Allocator is propagated on copy and move construction, for stateful allocators (like arena_allocator)
+  Vector(const Vector &o) : Base(N, o.get_allocator()) { this->append(o.begin(), o.end()); }
 
   Vector(const Vector &o, const Alloc &alloc) : Base(N, alloc) { this->append(o.begin(), o.end()); }
 
-  Vector(Vector &&o) noexcept(N == 0 || vec::is_move_construct_nothrow<T>::value) : Base(N) {
+  Vector(Vector &&o) noexcept(N == 0 || vec::is_move_construct_nothrow<T>::value) : Base(N, o.get_allocator()) {
     this->move_construct(o, N);
   }
 
@@ -1557,13 +1724,20 @@ class Vector : public vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingP
   template <SizeType ON = N, class OGrowingPolicy = GrowingPolicy>
   Vector(
       Vector<T, Alloc, SizeType, OGrowingPolicy, 0> &&o,
-      typename std::enable_if<std::is_same<OGrowingPolicy, vec::DynamicGrowingPolicy>::value && (ON > 0)>::type * = 0)
-      : Base(N) {
+      typename std::enable_if<vec::is_dynamic_growing_policy<OGrowingPolicy>::value && (ON > 0)>::type * = 0)
+      : Base(N, o.get_allocator()) {
     this->move_construct(o);
   }
 
-  Vector(Vector &&o, const Alloc &alloc) noexcept(N == 0 || vec::is_move_construct_nothrow<T>::value) : Base(N, alloc) {
-    this->move_construct(o, N);
+  /// Elements of 'o' are moved one by one if its dynamic storage cannot be freed by 'alloc'.
+  Vector(Vector &&o, const Alloc &alloc) noexcept((N == 0 || vec::is_move_construct_nothrow<T>::value) &&
+                                                  std::is_empty<Alloc>::value)
+      : Base(N, alloc) {
+    if (vec::AreEqualAllocators(this->get_allocator(), o.get_allocator())) {
+      this->move_construct(o, N);
+    } else {
+      this->append(std::make_move_iterator(o.begin()), std::make_move_iterator(o.end()));
+    }
   }
 
   Vector(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : Base(N, alloc) {
@@ -1577,10 +1751,15 @@ class Vector : public vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingP
     return *this;
   }
 
-  // Move assignment operator only defined here as it requires same N
-  Vector &operator=(Vector &&o) noexcept(N == 0 || vec::is_shift_nothrow<T>::value) {
+  // Move assignment operator only defined here as it requires same N.
+  // Allocator is not propagated: elements of 'o' are moved one by one if allocators are not equal.
+  Vector &operator=(Vector &&o) noexcept((N == 0 || vec::is_shift_nothrow<T>::value) && std::is_empty<Alloc>::value) {
     if (AMC_LIKELY(this != &o)) {
-      this->move_assign(o, N);
+      if (vec::AreEqualAllocators(this->get_allocator(), o.get_allocator())) {
+        this->move_assign(o, N);
+      } else {
+        this->assign(std::make_move_iterator(o.begin()), std::make_move_iterator(o.end()));
+      }
     }
     return *this;
   }
@@ -1607,6 +1786,11 @@ class Vector : public vec::VectorWithInplaceStorage<T, Alloc, SizeType, GrowingP
     return static_cast<size_type>(r);
   }
 #endif
+
+ private:
+  // Relocates its chunks into a vector in 'flatten'
+  template <class, std::size_t, class>
+  friend class SegmentedVector;
 };
 
 template <class T, class A, class S, class G, S N>
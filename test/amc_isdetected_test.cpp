@@ -6,6 +6,12 @@
 namespace amc {
 static_assert(vec::has_reallocate<amc::allocator<int>>::value, "amc::allocator should provide reallocate method");
 static_assert(!vec::has_reallocate<std::allocator<int>>::value, "std::allocator does not provide reallocate method");
+static_assert(vec::has_allocate_at_least<amc::allocator<int>>::value,
+              "amc::allocator should provide allocate_at_least method");
+static_assert(vec::has_reallocate_at_least<amc::allocator<int>>::value,
+              "amc::allocator should provide reallocate_at_least method");
+static_assert(!vec::has_reallocate_at_least<std::allocator<int>>::value,
+              "std::allocator does not provide reallocate_at_least method");
 
 struct Meow {
   using pointer = const char *;
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#define AMC_SMALLVECTOR_PROFILING 1
+
+#include <amc/fixedcapacityvector.hpp>
+#include <amc/inlinecapacityadvisor.hpp>
+#include <amc/smallvector.hpp>
+#include <amc/vector.hpp>
+#include <string>
+
+namespace amc {
+
+TEST(InlineCapacityAdvisorTest, SizeBuckets) {
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(0), 0U);
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(63), 63U);
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(64), 64U);
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(127), 64U);
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(128), 65U);
+  EXPECT_EQ(InlineSizeSnapshot::SizeBucket(UINT64_MAX), InlineSizeSnapshot::kNbBuckets - 1U);
+  for (size_t bucket = 0; bucket < InlineSizeSnapshot::kNbBuckets; ++bucket) {
+    EXPECT_EQ(InlineSizeSnapshot::SizeBucket(InlineSizeSnapshot::BucketMaxSize(bucket)), bucket);
+  }
+}
+
+TEST(InlineCapacityAdvisorTest, SuggestInlineCapacity) {
+  using IntSmallVector = SmallVector<int, 4>;
+  InlineCapacityAdvisor<IntSmallVector>::reset();
+  for (int i = 0; i < 100; ++i) {
+    IntSmallVector v;
+    // 90 % of instances reach 6 elements at most, the others 20
+    const int maxSize = i < 90 ? 6 : 20;
+    for (int j = 0; j < maxSize; ++j) {
+      v.push_back(j);
+    }
+    v.resize(1);
+  }
+  InlineCapacityReport report = InlineCapacityAdvisor<IntSmallVector>::report(0.9);
+  EXPECT_EQ(report.nbInstances, 100U);
+  EXPECT_EQ(report.nbInstancesLeftSmall, 100U);
+  EXPECT_EQ(report.inlineCapacity, 4U);
+  EXPECT_EQ(report.inlineCapacityCoverage, 0.0);
+  EXPECT_EQ(report.suggestedInlineCapacity, 6U);
+  EXPECT_EQ(InlineCapacityAdvisor<IntSmallVector>::report(0.95).suggestedInlineCapacity, 20U);
+
+  // Other SmallVector types are profiled separately
+  using OtherSmallVector = SmallVector<int, 8>;
+  EXPECT_EQ(InlineCapacityAdvisor<OtherSmallVector>::snapshot().nbInstances, 0U);
+  InlineCapacityAdvisor<IntSmallVector>::reset();
+  EXPECT_EQ(InlineCapacityAdvisor<IntSmallVector>::snapshot().nbInstances, 0U);
+}
+
+TEST(InlineCapacityAdvisorTest, TaggedSmallVectors) {
+  struct SiteTag : vec::DynamicGrowingPolicy {};
+  using TaggedVector = SmallVector<std::string, 3, amc::allocator<std::string>, uint32_t, SiteTag>;
+  {
+    TaggedVector v1{"a", "b"};
+    TaggedVector v2(v1);
+    v2.reserve(10);
+    TaggedVector v3(std::move(v2));
+    TaggedVector v4;
+    v4 = v1;
+    v4.swap(v3);
+    v4.push_back("c");
+  }
+  InlineSizeSnapshot stats = InlineCapacityAdvisor<TaggedVector>::snapshot();
+  // Moved-from v2 is not an instance on its own, its history is carried by v3
+  EXPECT_EQ(stats.nbInstances, 3U);
+  // v3 (moved storage of v2) and v4 (swapped storage) left small state
+  EXPECT_EQ(stats.nbInstancesLeftSmall, 2U);
+  EXPECT_EQ(stats.maxSizes[2], 2U);
+  EXPECT_EQ(stats.maxSizes[3], 1U);
+  EXPECT_EQ(InlineCapacityAdvisor<TaggedVector>::report().inlineCapacityCoverage, 1.0);
+
+  // Vectors without inline elements are not profiled
+  { vector<int> v(10); }
+  { FixedCapacityVector<int, 10> v(10); }
+  EXPECT_EQ(InlineCapacityAdvisor<vector<int>>::snapshot().nbInstances, 0U);
+}
+
+TEST(InlineCapacityAdvisorTest, MovedSmallVectors) {
+  using StrSmallVector = SmallVector<std::string, 2>;
+  InlineCapacityAdvisor<StrSmallVector>::reset();
+  {
+    // Growth of the outer vector relocates the SmallVectors by move construction
+    vector<StrSmallVector> outer;
+    for (int i = 0; i < 100; ++i) {
+      StrSmallVector v;
+      for (int j = 0; j < 5; ++j) {
+        v.emplace_back(1, 'a');
+      }
+      v.resize(1);
+      outer.push_back(std::move(v));
+    }
+  }
+  InlineSizeSnapshot stats = InlineCapacityAdvisor<StrSmallVector>::snapshot();
+  EXPECT_EQ(stats.nbInstances, 100U);
+  EXPECT_EQ(stats.nbInstancesLeftSmall, 100U);
+  EXPECT_EQ(stats.maxSizes[5], 100U);
+
+  InlineCapacityReport report = InlineCapacityAdvisor<StrSmallVector>::report(0.95);
+  EXPECT_EQ(report.suggestedInlineCapacity, 5U);
+
+  // A moved-from SmallVector filled again is a real instance
+  InlineCapacityAdvisor<StrSmallVector>::reset();
+  {
+    StrSmallVector v1{"a", "b", "c"};
+    StrSmallVector v2(std::move(v1));
+    v1.push_back("d");
+  }
+  stats = InlineCapacityAdvisor<StrSmallVector>::snapshot();
+  EXPECT_EQ(stats.nbInstances, 2U);
+  EXPECT_EQ(stats.maxSizes[1], 1U);
+  EXPECT_EQ(stats.maxSizes[3], 1U);
+}
+
+}  // namespace amc
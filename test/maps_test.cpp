@@ -0,0 +1,803 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <amc/config.hpp>
+#include <amc/flatmap.hpp>
+#include <amc/smallvector.hpp>
+#include <amc/splitflatmap.hpp>
+#include <map>
+#ifdef AMC_SMALLMAP
+#include <amc/smallmap.hpp>
+#endif
+#include <string>
+#include <vector>
+
+#include "testtypes.hpp"
+
+namespace amc {
+
+TypeStats TypeStats::_stats;
+
+template <typename T>
+class MapListTest : public ::testing::Test {
+ public:
+  using Map = T;
+  using value_type = typename T::value_type;
+};
+
+typedef ::testing::Types<
+    FlatMap<int, int>, FlatMap<uint32_t, char, std::greater<uint32_t>>,
+    FlatMap<char, int64_t, std::less<char>, std::allocator<std::pair<char, int64_t>>>,
+    FlatMap<int, int, std::less<int>, amc::allocator<std::pair<int, int>>, SmallVector<std::pair<int, int>, 4>>,
+    FlatMap<int16_t, ComplexTriviallyRelocatableType>,
+    FlatMap<uint8_t, ComplexNonTriviallyRelocatableType, std::greater<uint8_t>>,
+    FlatMap<int, int64_t, std::less<int>, std::allocator<std::pair<int, int64_t>>,
+            std::vector<std::pair<int, int64_t>>>,
+    SplitFlatMap<int, int>, SplitFlatMap<uint32_t, ComplexTriviallyRelocatableType, std::greater<uint32_t>>,
+    SplitFlatMap<int16_t, ComplexNonTriviallyRelocatableType, std::less<int16_t>, SmallVector<int16_t, 4>,
+                 SmallVector<ComplexNonTriviallyRelocatableType, 4>>,
+    SplitFlatMap<char, int64_t, std::less<char>, std::vector<char>, std::vector<int64_t>>>
+    MapsType;
+TYPED_TEST_SUITE(MapListTest, MapsType, );
+
+TYPED_TEST(MapListTest, DefaultConstructor) {
+  TypeParam m;
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.size(), 0U);
+  EXPECT_EQ(m.begin(), m.end());
+}
+
+TYPED_TEST(MapListTest, InsertAndFind) {
+  using value_type = typename TestFixture::value_type;
+  TypeParam m;
+  EXPECT_TRUE(m.insert(value_type(8, 0)).second);
+  EXPECT_TRUE(m.insert(value_type(15, 1)).second);
+  auto ret = m.insert(value_type(8, 2));
+  EXPECT_FALSE(ret.second);
+  EXPECT_EQ(ret.first, m.find(8));
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_TRUE(m.contains(15));
+  EXPECT_FALSE(m.contains(16));
+  EXPECT_EQ(m.find(16), m.end());
+  EXPECT_EQ(m.count(8), 1U);
+  EXPECT_EQ(m.count(9), 0U);
+  EXPECT_EQ(m.find(8)->second, typename TypeParam::mapped_type(0U));
+}
+
+TYPED_TEST(MapListTest, Sorted) {
+  TypeParam m{{4, 0}, {8, 0}, {1, 0}, {7, 0}, {4, 1}};
+  EXPECT_EQ(m.size(), 4U);
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end(), m.value_comp()));
+  EXPECT_TRUE(std::is_sorted(m.rbegin(), m.rend(), [&m](const typename TypeParam::value_type &lhs,
+                                                         const typename TypeParam::value_type &rhs) {
+    return m.key_comp()(rhs.first, lhs.first);
+  }));
+}
+
+TYPED_TEST(MapListTest, SubscriptOperator) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m;
+  m[3] = mapped_type(7);
+  m[1] = mapped_type(2);
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_EQ(m[3], mapped_type(7));
+  EXPECT_EQ(m[5], mapped_type());
+  EXPECT_EQ(m.size(), 3U);
+}
+
+TYPED_TEST(MapListTest, At) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m{{3, 7}};
+  EXPECT_EQ(m.at(3), mapped_type(7));
+  const TypeParam &cm = m;
+  EXPECT_EQ(cm.at(3), mapped_type(7));
+  EXPECT_THROW(m.at(4), std::out_of_range);
+  EXPECT_THROW(cm.at(2), std::out_of_range);
+}
+
+TYPED_TEST(MapListTest, TryEmplace) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m;
+  EXPECT_TRUE(m.try_emplace(4, 1).second);
+  EXPECT_FALSE(m.try_emplace(4, 2).second);
+  EXPECT_EQ(m[4], mapped_type(1));
+  auto it = m.try_emplace(m.end(), 6, 3);
+  EXPECT_EQ(it->second, mapped_type(3));
+  it = m.try_emplace(m.begin(), 6, 4);
+  EXPECT_EQ(it->second, mapped_type(3));
+  it = m.try_emplace(m.end(), 2, 5);
+  EXPECT_EQ(it, m.find(2));
+  EXPECT_EQ(it->second, mapped_type(5));
+  EXPECT_EQ(m.size(), 3U);
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end(), m.value_comp()));
+}
+
+TYPED_TEST(MapListTest, InsertOrAssign) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m;
+  EXPECT_TRUE(m.insert_or_assign(4, mapped_type(1)).second);
+  EXPECT_FALSE(m.insert_or_assign(4, mapped_type(2)).second);
+  EXPECT_EQ(m[4], mapped_type(2));
+  auto it = m.insert_or_assign(m.begin(), 4, mapped_type(3));
+  EXPECT_EQ(it->second, mapped_type(3));
+  it = m.insert_or_assign(m.begin(), 9, mapped_type(4));
+  EXPECT_EQ(it->second, mapped_type(4));
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end(), m.value_comp()));
+}
+
+TYPED_TEST(MapListTest, InsertHint) {
+  using value_type = typename TestFixture::value_type;
+  TypeParam m{{1, 0}, {3, 0}, {5, 0}};
+  for (int i = 0; i < 7; ++i) {
+    for (std::size_t hintPos = 0; hintPos <= m.size(); ++hintPos) {
+      TypeParam c = m;
+      auto it = c.insert(std::next(c.begin(), hintPos), value_type(i, 1));
+      EXPECT_EQ(it->first, static_cast<typename TypeParam::key_type>(i));
+      EXPECT_EQ(c.size(), m.size() + (m.contains(i) ? 0U : 1U));
+      EXPECT_TRUE(std::is_sorted(c.begin(), c.end(), c.value_comp()));
+    }
+  }
+}
+
+TYPED_TEST(MapListTest, InsertRange) {
+  using value_type = typename TestFixture::value_type;
+  TypeParam m{{1, 0}, {3, 0}};
+  std::vector<value_type> toInsert{value_type(4, 1), value_type(1, 1), value_type(0, 1), value_type(4, 2)};
+  m.insert(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(m.size(), 4U);
+  EXPECT_EQ(m[1], typename TypeParam::mapped_type(0U));
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end(), m.value_comp()));
+  TypeParam fromRange(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(fromRange.size(), 3U);
+}
+
+TYPED_TEST(MapListTest, Erase) {
+  TypeParam m{{1, 0}, {3, 0}, {5, 0}, {7, 0}};
+  EXPECT_EQ(m.erase(3), 1U);
+  EXPECT_EQ(m.erase(3), 0U);
+  auto it = m.erase(m.find(5));
+  EXPECT_EQ(it, m.find(m.key_comp()(1, 7) ? 7 : 1));
+  m.erase(m.begin(), m.end());
+  EXPECT_TRUE(m.empty());
+}
+
+TYPED_TEST(MapListTest, ModifyMappedThroughIterator) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m{{1, 0}, {3, 0}};
+  for (auto &&p : m) {
+    p.second = mapped_type(42);
+  }
+  EXPECT_EQ(m[1], mapped_type(42));
+  EXPECT_EQ(m[3], mapped_type(42));
+}
+
+TYPED_TEST(MapListTest, SwapAndComparisons) {
+  TypeParam m1{{1, 0}, {3, 0}};
+  TypeParam m2{{2, 0}};
+  TypeParam m1Copy = m1;
+  EXPECT_EQ(m1, m1Copy);
+  EXPECT_NE(m1, m2);
+  m1.swap(m2);
+  EXPECT_EQ(m2, m1Copy);
+  swap(m1, m2);
+  EXPECT_EQ(m1, m1Copy);
+  EXPECT_FALSE(m1 < m1Copy);
+  EXPECT_LE(m1, m1Copy);
+}
+
+TYPED_TEST(MapListTest, Merge) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m1{{1, 0}, {3, 0}, {5, 0}};
+  TypeParam m2{{0, 1}, {3, 1}, {4, 1}, {8, 1}};
+  m1.merge(m2);
+  EXPECT_EQ(m1.size(), 6U);
+  EXPECT_EQ(m1[3], mapped_type(0U));
+  TypeParam expected{{3, 1}};
+  EXPECT_EQ(m2, expected);
+  EXPECT_TRUE(std::is_sorted(m1.begin(), m1.end(), m1.value_comp()));
+}
+
+
+#ifdef AMC_CXX20
+TYPED_TEST(MapListTest, EraseIf) {
+  TypeParam m{{1, 0}, {2, 0}, {3, 0}, {4, 0}};
+  EXPECT_EQ(erase_if(m, [](const auto &p) { return p.first % 2 == 0; }), 2U);
+  EXPECT_EQ(m.size(), 2U);
+}
+#endif
+
+#ifdef AMC_CXX17
+template <typename T>
+class MapListExtractTest : public ::testing::Test {};
+
+using MapsExtractType = ::testing::Types<FlatMap<int, int>, FlatMap<uint32_t, char, std::greater<uint32_t>>,
+                                         FlatMap<int16_t, ComplexTriviallyRelocatableType>>;
+TYPED_TEST_SUITE(MapListExtractTest, MapsExtractType, );
+
+TYPED_TEST(MapListExtractTest, Extract) {
+  using mapped_type = typename TypeParam::mapped_type;
+  TypeParam m{{1, 0}, {3, 4}, {5, 0}};
+  auto nh = m.extract(3);
+  ASSERT_FALSE(nh.empty());
+  EXPECT_EQ(nh.key(), static_cast<typename TypeParam::key_type>(3));
+  EXPECT_EQ(nh.mapped(), mapped_type(4));
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_TRUE(m.extract(3).empty());
+  nh.key() = 2;
+  auto irt = m.insert(std::move(nh));
+  EXPECT_TRUE(irt.inserted);
+  EXPECT_TRUE(irt.node.empty());
+  EXPECT_EQ(irt.position->second, mapped_type(4));
+
+  nh = m.extract(m.find(1));
+  nh.mapped() = mapped_type(7);
+  m[1] = mapped_type(8);
+  irt = m.insert(std::move(nh));
+  EXPECT_FALSE(irt.inserted);
+  EXPECT_FALSE(irt.node.empty());
+  EXPECT_EQ(irt.node.mapped(), mapped_type(7));
+}
+#endif
+
+TEST(FlatMapTest, Relocatability) {
+  static_assert(is_trivially_relocatable<FlatMap<int, int>>::value, "");
+  static_assert(is_trivially_relocatable<FlatMap<int, ComplexNonTriviallyRelocatableType>>::value, "");
+  static_assert(sizeof(FlatMap<int, int>) == sizeof(vector<std::pair<int, int>>), "");
+}
+
+TEST(FlatMapTest, NonCopyableMapped) {
+  FlatMap<int, NonCopyableType> m;
+  m.emplace(3, NonCopyableType(3));
+  m.try_emplace(1, 1);
+  m.insert_or_assign(3, NonCopyableType(4));
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_EQ(m.begin()->second, NonCopyableType(1));
+  EXPECT_EQ(m.find(3)->second, NonCopyableType(4));
+}
+
+TEST(FlatMapTest, MergeDifferentCompare) {
+  FlatMap<int, char> m1{{1, 'a'}, {3, 'b'}};
+  FlatMap<int, char, std::greater<int>> m2{{0, 'c'}, {3, 'd'}, {4, 'e'}};
+  m1.merge(m2);
+  EXPECT_EQ(m1, (FlatMap<int, char>{{0, 'c'}, {1, 'a'}, {3, 'b'}, {4, 'e'}}));
+  EXPECT_EQ(m2, (FlatMap<int, char, std::greater<int>>{{3, 'd'}}));
+}
+
+TEST(FlatMapTest, MergeFromMultiMap) {
+  FlatMap<int, char> m{{1, 'a'}};
+  FlatMultiMap<int, char> mm{{1, 'b'}, {2, 'c'}, {2, 'd'}};
+  m.merge(mm);
+  EXPECT_EQ(m, (FlatMap<int, char>{{1, 'a'}, {2, 'c'}}));
+  EXPECT_EQ(mm, (FlatMultiMap<int, char>{{1, 'b'}, {2, 'd'}}));
+}
+
+#ifdef AMC_CXX14
+TEST(FlatMapTest, TransparentLookup) {
+  FlatMap<std::string, int, std::less<>> m{{"abc", 1}, {"def", 2}};
+  EXPECT_NE(m.find("abc"), m.end());
+  EXPECT_TRUE(m.contains("def"));
+  EXPECT_FALSE(m.contains("ghi"));
+  EXPECT_EQ(m.count("def"), 1U);
+  EXPECT_EQ(m.lower_bound("b")->second, 2);
+}
+#endif
+
+#ifdef AMC_NONSTD_FEATURES
+TEST(FlatMapTest, CreateFromVectorAndSteal) {
+  using MapType = FlatMap<int, char>;
+  MapType::vector_type v{{3, 'a'}, {1, 'b'}, {3, 'c'}, {2, 'd'}};
+  MapType m(std::move(v));
+  EXPECT_EQ(m.size(), 3U);
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end(), m.value_comp()));
+  const MapType::value_type *pData = m.data();
+  MapType::vector_type stolen = m.steal_vector();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(stolen.data(), pData);
+  EXPECT_EQ(stolen.size(), 3U);
+}
+#endif
+
+TEST(FlatMultiMapTest, InsertKeepsOrderOfEquivalentKeys) {
+  FlatMultiMap<int, char> m;
+  m.insert(std::make_pair(2, 'a'));
+  m.insert(std::make_pair(1, 'b'));
+  m.insert(std::make_pair(2, 'c'));
+  m.emplace(2, 'd');
+  m.insert(m.begin(), std::make_pair(2, 'e'));
+  EXPECT_EQ(m.size(), 5U);
+  EXPECT_EQ(m.count(2), 4U);
+  auto range = m.equal_range(2);
+  std::string mapped;
+  for (auto it = range.first; it != range.second; ++it) {
+    mapped.push_back(it->second);
+  }
+  EXPECT_EQ(mapped, "eacd");
+}
+
+TEST(FlatMultiMapTest, InsertRangeAndErase) {
+  FlatMultiMap<int, char> m{{3, 'a'}, {1, 'b'}, {3, 'c'}};
+  std::vector<std::pair<int, char>> toInsert{{3, 'd'}, {0, 'e'}, {3, 'f'}};
+  m.insert(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(m.size(), 6U);
+  EXPECT_EQ(m.count(3), 4U);
+  EXPECT_EQ(m.erase(3), 4U);
+  EXPECT_EQ(m, (FlatMultiMap<int, char>{{0, 'e'}, {1, 'b'}}));
+}
+
+TEST(FlatMultiMapTest, InsertRangeKeepsInsertionOrder) {
+  FlatMultiMap<int, char> m{{1, 'a'}, {2, 'b'}, {2, 'c'}, {4, 'd'}};
+  std::vector<std::pair<int, char>> toInsert{{2, 'e'}, {5, 'f'}, {2, 'g'}, {4, 'h'}};
+  m.insert(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(m, (FlatMultiMap<int, char>{
+                   {1, 'a'}, {2, 'b'}, {2, 'c'}, {2, 'e'}, {2, 'g'}, {4, 'd'}, {4, 'h'}, {5, 'f'}}));
+  // Already sorted range
+  toInsert = {{0, 'i'}, {2, 'j'}, {6, 'k'}};
+  m.insert(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(m.size(), 11U);
+  EXPECT_EQ(m.begin()->second, 'i');
+  EXPECT_EQ(std::prev(m.upper_bound(2))->second, 'j');
+}
+
+TEST(FlatMapTest, InsertRangeKeepsExistingValues) {
+  FlatMap<int, char> m{{1, 'a'}, {3, 'b'}};
+  std::vector<std::pair<int, char>> toInsert{{3, 'c'}, {2, 'd'}, {1, 'e'}, {4, 'f'}};
+  m.insert(toInsert.begin(), toInsert.end());
+  EXPECT_EQ(m, (FlatMap<int, char>{{1, 'a'}, {2, 'd'}, {3, 'b'}, {4, 'f'}}));
+}
+
+TEST(FlatMapTest, DuplicatedKeysKeepFirstOccurrence) {
+  // Enough unsorted elements for the sort not to take advantage of sorted runs
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < 1000; ++i) {
+    pairs.emplace_back((i * 37) % 50, i);
+  }
+  const std::map<int, int> stdMap(pairs.begin(), pairs.end());
+  const FlatMap<int, int> expected(stdMap.begin(), stdMap.end());
+
+  FlatMap<int, int> fromRange(pairs.begin(), pairs.end());
+  EXPECT_EQ(fromRange, expected);
+
+  FlatMap<int, int> inserted{{10, -1}};
+  inserted.insert(pairs.begin(), pairs.end());
+  EXPECT_EQ(inserted[10], -1);
+  inserted[10] = stdMap.at(10);
+  EXPECT_EQ(inserted, expected);
+
+  FlatMap<int, char> fromList{{3, 'a'}, {1, 'b'}, {3, 'c'}, {2, 'd'}, {1, 'e'}};
+  EXPECT_EQ(fromList, (FlatMap<int, char>{{1, 'b'}, {2, 'd'}, {3, 'a'}}));
+}
+
+TEST(FlatMultiMapTest, Merge) {
+  FlatMultiMap<int, char> m{{1, 'a'}, {2, 'b'}};
+  FlatMap<int, char> o{{1, 'c'}, {3, 'd'}};
+  m.merge(o);
+  EXPECT_TRUE(o.empty());
+  EXPECT_EQ(m, (FlatMultiMap<int, char>{{1, 'a'}, {1, 'c'}, {2, 'b'}, {3, 'd'}}));
+}
+
+#ifdef AMC_CXX17
+TEST(FlatMultiMapTest, ExtractAndInsertNode) {
+  FlatMultiMap<int, char> m{{1, 'a'}, {1, 'b'}};
+  auto nh = m.extract(1);
+  EXPECT_EQ(nh.mapped(), 'a');
+  auto it = m.insert(std::move(nh));
+  EXPECT_EQ(it->second, 'a');
+  EXPECT_EQ(m, (FlatMultiMap<int, char>{{1, 'b'}, {1, 'a'}}));
+}
+#endif
+
+TEST(FlatMapTest, CompareWithStdMap) {
+  std::map<int, int> ref;
+  FlatMap<int, int> m;
+  uint32_t seed = 42;
+  for (int i = 0; i < 500; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    int key = static_cast<int>((seed >> 16) % 64U);
+    switch (seed % 4U) {
+      case 0:
+        ref[key] = i;
+        m[key] = i;
+        break;
+      case 1:
+        EXPECT_EQ(ref.erase(key), m.erase(key));
+        break;
+      case 2:
+        EXPECT_EQ(ref.count(key) == 0, m.insert_or_assign(key, i).second);
+        ref[key] = i;
+        break;
+      default:
+        EXPECT_EQ(ref.emplace(key, i).second, m.emplace(key, i).second);
+        break;
+    }
+    ASSERT_EQ(ref.size(), m.size());
+  }
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), m.begin(),
+                         [](const std::pair<const int, int> &lhs, const std::pair<int, int> &rhs) {
+                           return lhs.first == rhs.first && lhs.second == rhs.second;
+                         }));
+}
+
+TEST(SplitFlatMapTest, KeysAndValuesAreStoredSeparately) {
+  SplitFlatMap<int, char> m{{3, 'c'}, {1, 'a'}, {2, 'b'}};
+  EXPECT_EQ(m.keys(), vector<int>({1, 2, 3}));
+  EXPECT_EQ(m.values(), vector<char>({'a', 'b', 'c'}));
+  m.erase(2);
+  m[0] = 'z';
+  EXPECT_EQ(m.keys(), vector<int>({0, 1, 3}));
+  EXPECT_EQ(m.values(), vector<char>({'z', 'a', 'c'}));
+  auto it = m.find(3);
+  EXPECT_EQ(it->first, 3);
+  EXPECT_EQ((*it).second, 'c');
+  EXPECT_EQ(it - m.begin(), 2);
+  EXPECT_EQ(m.cend() - it, 1);
+  SplitFlatMap<int, char>::const_iterator cit = it;
+  EXPECT_EQ(cit, it);
+  EXPECT_EQ(it[-1].second, 'a');
+}
+
+TEST(SplitFlatMapTest, ConstructFromVectors) {
+  using MapType = SplitFlatMap<int, char>;
+  MapType m(MapType::key_container_type{4, 2, 4, 1}, MapType::mapped_container_type{'a', 'b', 'c', 'd'});
+  EXPECT_EQ(m.keys(), vector<int>({1, 2, 4}));
+  EXPECT_EQ(m.values(), vector<char>({'d', 'b', 'a'}));
+  EXPECT_THROW(MapType(MapType::key_container_type{1, 2}, MapType::mapped_container_type{'a'}), std::invalid_argument);
+}
+
+#ifdef AMC_NONSTD_FEATURES
+TEST(SplitFlatMapTest, StealVectors) {
+  SplitFlatMap<int, char> m{{3, 'c'}, {1, 'a'}};
+  const int *pKeys = m.keys().data();
+  auto vectors = m.steal_vectors();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(vectors.first.data(), pKeys);
+  EXPECT_EQ(vectors.second, vector<char>({'a', 'c'}));
+}
+#endif
+
+TEST(SplitFlatMapTest, Relocatability) {
+  static_assert(is_trivially_relocatable<SplitFlatMap<int, ComplexNonTriviallyRelocatableType>>::value, "");
+  static_assert(sizeof(SplitFlatMap<int, int>) == 2 * sizeof(vector<int>), "");
+}
+
+TEST(SplitFlatMapTest, CompareWithFlatMap) {
+  FlatMap<uint32_t, uint32_t> ref;
+  SplitFlatMap<uint32_t, uint32_t> m;
+  uint32_t seed = 7;
+  for (uint32_t i = 0; i < 500; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    uint32_t key = (seed >> 16) % 64U;
+    auto hint = m.lower_bound(key % 8U);
+    auto refHint = ref.lower_bound(key % 8U);
+    switch (seed % 4U) {
+      case 0:
+        EXPECT_EQ(ref.try_emplace(refHint, key, i)->second, m.try_emplace(hint, key, i)->second);
+        break;
+      case 1:
+        EXPECT_EQ(ref.erase(key), m.erase(key));
+        break;
+      case 2:
+        EXPECT_EQ(ref.insert_or_assign(refHint, key, i)->second, m.insert_or_assign(hint, key, i)->second);
+        break;
+      default:
+        EXPECT_EQ(ref.emplace(key, i).second, m.emplace(key, i).second);
+        break;
+    }
+    ASSERT_EQ(ref.size(), m.size());
+  }
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), m.begin(),
+                         [](const std::pair<uint32_t, uint32_t> &lhs, std::pair<const uint32_t &, uint32_t &> rhs) {
+                           return lhs.first == rhs.first && lhs.second == rhs.second;
+                         }));
+}
+
+#ifdef AMC_SMALLMAP
+template <typename T>
+class SmallMapListTest : public ::testing::Test {
+ public:
+  using Map = T;
+  using key_type = typename T::key_type;
+  using mapped_type = typename T::mapped_type;
+  using value_type = typename T::value_type;
+
+  /// Returns a map with keys in [first, last) and mapped values equal to keys, inserted in reverse order
+  static Map Create(int first, int last) {
+    Map m;
+    for (int i = last - 1; i >= first; --i) {
+      m.emplace(key_type(i), mapped_type(i));
+    }
+    return m;
+  }
+
+  /// Checks that content of 'm' is the same as the one of 'ref' (in any order)
+  static void ExpectSameContent(const Map &m, const std::map<int, int> &ref) {
+    ASSERT_EQ(m.size(), ref.size());
+    EXPECT_EQ(static_cast<std::size_t>(std::distance(m.begin(), m.end())), ref.size());
+    for (const auto &p : ref) {
+      auto it = m.find(key_type(p.first));
+      ASSERT_NE(it, m.end());
+      EXPECT_EQ(it->second, mapped_type(p.second));
+    }
+  }
+};
+
+typedef ::testing::Types<
+    SmallMap<int, int, 2>, SmallMap<int, int, 8>, SmallMap<uint32_t, char, 3, std::greater<uint32_t>>,
+    SmallMap<int16_t, ComplexNonTriviallyRelocatableType, 4>,
+    SmallMap<char, ComplexTriviallyRelocatableType, 3, std::less<char>,
+             std::allocator<std::pair<const char, ComplexTriviallyRelocatableType>>>,
+    SmallMap<int, int64_t, 2, std::less<int>, amc::allocator<std::pair<int, int64_t>>, FlatMap<int, int64_t>>,
+    SmallMap<uint8_t, int, 4, std::greater<uint8_t>, amc::allocator<std::pair<uint8_t, int>>,
+             FlatMap<uint8_t, int, std::greater<uint8_t>>>>
+    SmallMapsType;
+TYPED_TEST_SUITE(SmallMapListTest, SmallMapsType, );
+
+TYPED_TEST(SmallMapListTest, InsertAndGrow) {
+  using value_type = typename TestFixture::value_type;
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  TypeParam m;
+  std::map<int, int> ref;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(m.insert(value_type(key_type(i), mapped_type(i))).second);
+    ref.emplace(i, i);
+    auto ret = m.insert(value_type(key_type(i), mapped_type(i + 1)));
+    EXPECT_FALSE(ret.second);
+    EXPECT_EQ(ret.first, m.find(key_type(i)));
+    TestFixture::ExpectSameContent(m, ref);
+  }
+  EXPECT_FALSE(m.contains(key_type(10)));
+  EXPECT_EQ(m.count(key_type(9)), 1U);
+  EXPECT_GE(m.max_size(), 10U);
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.begin(), m.end());
+}
+
+TYPED_TEST(SmallMapListTest, SubscriptAndAt) {
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  TypeParam m;
+  for (int i = 0; i < 6; ++i) {
+    m[key_type(i)] = mapped_type(2 * i);
+    EXPECT_EQ(m.at(key_type(i)), mapped_type(2 * i));
+  }
+  EXPECT_EQ(m[key_type(1)], mapped_type(2));
+  const TypeParam &cm = m;
+  EXPECT_EQ(cm.at(key_type(5)), mapped_type(10));
+  EXPECT_THROW(m.at(key_type(6)), std::out_of_range);
+  EXPECT_THROW(cm.at(key_type(7)), std::out_of_range);
+  EXPECT_EQ(m.size(), 6U);
+}
+
+TYPED_TEST(SmallMapListTest, TryEmplaceAndInsertOrAssign) {
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  TypeParam m;
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(m.try_emplace(key_type(i), mapped_type(i)).second);
+    EXPECT_FALSE(m.try_emplace(key_type(i), mapped_type(i + 1)).second);
+    EXPECT_FALSE(m.insert_or_assign(key_type(i), mapped_type(i + 2)).second);
+    EXPECT_EQ(m.at(key_type(i)), mapped_type(i + 2));
+    auto it = m.insert_or_assign(m.begin(), key_type(i + 10), mapped_type(i));
+    EXPECT_EQ(it->second, mapped_type(i));
+  }
+  EXPECT_EQ(m.try_emplace(m.end(), key_type(42), mapped_type(3))->second, mapped_type(3));
+  EXPECT_EQ(m.emplace_hint(m.begin(), key_type(42), mapped_type(4))->second, mapped_type(3));
+  EXPECT_EQ(m.size(), 13U);
+}
+
+TYPED_TEST(SmallMapListTest, Erase) {
+  using key_type = typename TestFixture::key_type;
+  for (int nbElems = 1; nbElems < 8; ++nbElems) {
+    TypeParam m = TestFixture::Create(0, nbElems);
+    std::map<int, int> ref;
+    for (int i = 0; i < nbElems; ++i) {
+      ref.emplace(i, i);
+    }
+    EXPECT_EQ(m.erase(key_type(nbElems)), 0U);
+    EXPECT_EQ(m.erase(key_type(0)), 1U);
+    ref.erase(0);
+    TestFixture::ExpectSameContent(m, ref);
+    // erase every other element while iterating
+    bool eraseIt = true;
+    for (auto it = m.begin(); it != m.end(); eraseIt = !eraseIt) {
+      if (eraseIt) {
+        ref.erase(static_cast<int>(it->first));
+        it = m.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    TestFixture::ExpectSameContent(m, ref);
+    m.erase(m.cbegin(), m.cend());
+    EXPECT_TRUE(m.empty());
+  }
+}
+
+TYPED_TEST(SmallMapListTest, EraseRange) {
+  TypeParam m = TestFixture::Create(0, 3);
+  auto it = m.erase(m.begin(), std::next(m.begin(), 2));
+  EXPECT_EQ(m.size(), 1U);
+  EXPECT_EQ(it, m.begin());
+  EXPECT_EQ(m.erase(m.begin(), m.begin()), m.begin());
+  EXPECT_EQ(m.size(), 1U);
+}
+
+TYPED_TEST(SmallMapListTest, CopyMoveAndSwap) {
+  std::map<int, int> smallRef{{0, 0}, {1, 1}}, largeRef;
+  for (int i = 0; i < 10; ++i) {
+    largeRef.emplace(i, i);
+  }
+  TypeParam small = TestFixture::Create(0, 2);
+  TypeParam large = TestFixture::Create(0, 10);
+  TypeParam c(small);
+  TestFixture::ExpectSameContent(c, smallRef);
+  c = large;
+  TestFixture::ExpectSameContent(c, largeRef);
+  c = small;
+  TestFixture::ExpectSameContent(c, smallRef);
+  TypeParam m(std::move(c));
+  TestFixture::ExpectSameContent(m, smallRef);
+  c = std::move(large);
+  TestFixture::ExpectSameContent(c, largeRef);
+  c.swap(m);
+  TestFixture::ExpectSameContent(c, smallRef);
+  TestFixture::ExpectSameContent(m, largeRef);
+  TypeParam other = TestFixture::Create(2, 3);
+  swap(c, other);
+  TestFixture::ExpectSameContent(c, std::map<int, int>{{2, 2}});
+  TestFixture::ExpectSameContent(other, smallRef);
+}
+
+TYPED_TEST(SmallMapListTest, Comparisons) {
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  for (int nbElems = 1; nbElems < 8; ++nbElems) {
+    TypeParam m1 = TestFixture::Create(0, nbElems);
+    TypeParam m2;
+    for (int i = 0; i < nbElems; ++i) {
+      m2.emplace(key_type(i), mapped_type(i));
+    }
+    EXPECT_EQ(m1, m2);
+    EXPECT_FALSE(m1 < m2);
+    EXPECT_LE(m1, m2);
+    m2[key_type(0)] = mapped_type(nbElems);
+    EXPECT_NE(m1, m2);
+    EXPECT_LT(m1, m2);
+    EXPECT_GT(m2, m1);
+  }
+}
+
+TYPED_TEST(SmallMapListTest, Merge) {
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  for (int nbElems = 0; nbElems < 8; ++nbElems) {
+    TypeParam m1 = TestFixture::Create(0, nbElems);
+    TypeParam m2;
+    std::map<int, int> ref, expectedRemaining;
+    for (int i = 0; i < nbElems; ++i) {
+      ref.emplace(i, i);
+    }
+    for (int i = nbElems / 2; i < nbElems + 3; ++i) {
+      m2.emplace(key_type(i), mapped_type(i + 100));
+      if (!ref.emplace(i, i + 100).second) {
+        expectedRemaining.emplace(i, i + 100);
+      }
+    }
+    m1.merge(m2);
+    TestFixture::ExpectSameContent(m1, ref);
+    TestFixture::ExpectSameContent(m2, expectedRemaining);
+  }
+}
+
+TYPED_TEST(SmallMapListTest, ExtractAndInsertNode) {
+  using key_type = typename TestFixture::key_type;
+  using mapped_type = typename TestFixture::mapped_type;
+  for (int nbElems = 2; nbElems < 8; ++nbElems) {
+    TypeParam m = TestFixture::Create(0, nbElems);
+    auto nh = m.extract(key_type(1));
+    ASSERT_FALSE(nh.empty());
+    EXPECT_EQ(nh.key(), key_type(1));
+    EXPECT_EQ(nh.mapped(), mapped_type(1));
+    EXPECT_TRUE(m.extract(key_type(1)).empty());
+    EXPECT_EQ(m.size(), static_cast<std::size_t>(nbElems - 1));
+    nh.key() = key_type(0);
+    auto irt = m.insert(std::move(nh));
+    EXPECT_FALSE(irt.inserted);
+    ASSERT_FALSE(irt.node.empty());
+    EXPECT_EQ(irt.position, m.find(key_type(0)));
+    irt.node.key() = key_type(50);
+    irt = m.insert(std::move(irt.node));
+    EXPECT_TRUE(irt.inserted);
+    EXPECT_TRUE(irt.node.empty());
+    EXPECT_EQ(irt.position->second, mapped_type(1));
+    nh = m.extract(m.find(key_type(0)));
+    EXPECT_EQ(nh.mapped(), mapped_type(0U));
+    EXPECT_EQ(m.size(), static_cast<std::size_t>(nbElems - 1));
+    EXPECT_FALSE(m.contains(key_type(0)));
+  }
+}
+
+#ifdef AMC_CXX20
+TYPED_TEST(SmallMapListTest, EraseIf) {
+  for (int nbElems = 1; nbElems < 8; ++nbElems) {
+    TypeParam m = TestFixture::Create(0, nbElems);
+    EXPECT_EQ(erase_if(m, [](const auto &p) { return p.first % 2 == 0; }),
+              static_cast<typename TypeParam::size_type>((nbElems + 1) / 2));
+    EXPECT_EQ(m.size(), static_cast<std::size_t>(nbElems / 2));
+  }
+}
+#endif
+
+TEST(SmallMapTest, IteratorTypes) {
+  using MapType = SmallMap<int, int, 4>;
+  static_assert(std::is_same<MapType::value_type, std::pair<const int, int>>::value, "");
+  MapType m{{1, 1}, {2, 2}};
+  MapType::const_iterator cit = m.begin();
+  EXPECT_EQ(cit, m.begin());
+  EXPECT_EQ(m.begin(), cit);
+  EXPECT_EQ(std::distance(m.rbegin(), m.rend()), 2);
+
+  using FlatMapType = FlatMap<int, int>;
+  using SmallFlatMapType = SmallMap<int, int, 4, std::less<int>, FlatMapType::allocator_type, FlatMapType>;
+  static_assert(std::is_same<SmallFlatMapType::iterator, std::pair<int, int> *>::value, "");
+  static_assert(std::is_same<SmallFlatMapType::const_iterator, const std::pair<int, int> *>::value, "");
+}
+
+TEST(SmallMapTest, StringKeys) {
+  using MapType = SmallMap<std::string, std::string, 3, std::less<>>;
+  MapType m;
+  m["currency"] = "EUR";
+  m["origin"] = "NCE";
+  m.emplace("destination", "JFK");
+  EXPECT_EQ(m.at("origin"), "NCE");
+  EXPECT_EQ(m.erase("currency"), 1U);
+  EXPECT_TRUE(m.contains("destination"));
+  EXPECT_FALSE(m.contains("currency"));
+  m["carrier"] = "AF";
+  m["cabin"] = "Y";
+  EXPECT_EQ(m.size(), 4U);
+  EXPECT_EQ(m.find("cabin")->second, "Y");
+  EXPECT_EQ(m.count("destination"), 1U);
+  MapType copy = m;
+  EXPECT_EQ(copy, m);
+}
+
+TEST(SmallMapTest, Relocatability) {
+  static_assert(!is_trivially_relocatable<SmallMap<int, int, 4>>::value, "");
+  static_assert(is_trivially_relocatable<SmallMap<int, int, 4, std::less<int>, amc::allocator<std::pair<int, int>>,
+                                                  FlatMap<int, int>>>::value,
+                "");
+}
+
+TEST(SmallMapTest, CompareWithStdMap) {
+  std::map<int, int> ref;
+  SmallMap<int, int, 8> m;
+  uint32_t seed = 13;
+  for (int i = 0; i < 1000; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    int key = static_cast<int>((seed >> 16) % 16U);
+    switch (seed % 4U) {
+      case 0:
+        ref[key] = i;
+        m[key] = i;
+        break;
+      case 1:
+        EXPECT_EQ(ref.erase(key), m.erase(key));
+        break;
+      case 2:
+        EXPECT_EQ(ref.count(key) == 0, m.insert_or_assign(key, i).second);
+        ref[key] = i;
+        break;
+      default:
+        EXPECT_EQ(ref.emplace(key, i).second, m.emplace(key, i).second);
+        break;
+    }
+    ASSERT_EQ(ref.size(), m.size());
+    ASSERT_TRUE(std::is_permutation(ref.begin(), ref.end(), m.begin(), m.end()));
+  }
+}
+#endif
+
+}  // namespace amc
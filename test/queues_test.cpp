@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <amc/concurrentqueue.hpp>
+#include <amc/vector.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "testtypes.hpp"
+
+namespace amc {
+
+TypeStats TypeStats::_stats;
+
+TEST(QueuesTest, SPSCQueue) {
+  SPSCQueue<std::string, 5> q;
+  EXPECT_EQ(q.capacity(), 5U);
+  EXPECT_TRUE(q.empty());
+  std::string out;
+  EXPECT_FALSE(q.try_pop(out));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(q.try_push(std::to_string(i)));
+  }
+  EXPECT_FALSE(q.try_emplace("5"));
+  EXPECT_EQ(q.size(), 5U);
+  EXPECT_TRUE(q.try_pop(out));
+  EXPECT_EQ(out, "0");
+
+  // Batches wrap around the end of the 8 slots
+  std::string batch[4] = {"5", "6", "7", "8"};
+  EXPECT_EQ(q.try_push_n(batch, 4), 1U);
+  EXPECT_EQ(batch[0], "");
+  std::string popped[3];
+  EXPECT_EQ(q.try_pop_n(popped, 3), 3U);
+  EXPECT_EQ(popped[2], "3");
+  EXPECT_EQ(q.try_push_n(batch + 1, 3), 3U);
+  std::string all[8];
+  EXPECT_EQ(q.try_pop_n(all, 8), 5U);
+  EXPECT_EQ(std::vector<std::string>(all, all + 5), std::vector<std::string>({"4", "5", "6", "7", "8"}));
+  EXPECT_TRUE(q.empty());
+
+  // Remaining elements are destroyed with the queue
+  EXPECT_TRUE(q.try_emplace(100, 'a'));
+}
+
+TEST(QueuesTest, SPSCQueueThreads) {
+  using Payload = vector<uint32_t>;
+  constexpr uint32_t kNbElems = 100000;
+  SPSCQueue<Payload, 64> q;
+  std::thread producer([&q] {
+    Payload batch[3];
+    for (uint32_t i = 0; i < kNbElems;) {
+      if (i % 2 == 0) {
+        while (!q.try_emplace(1U, i)) {
+          std::this_thread::yield();
+        }
+        ++i;
+      } else {
+        uint32_t nbElems = 0;
+        for (; nbElems < 3U && i + nbElems < kNbElems; ++nbElems) {
+          batch[nbElems].assign(2U, i + nbElems);
+        }
+        uint32_t nbPushed = static_cast<uint32_t>(q.try_push_n(batch, nbElems));
+        while (nbPushed < nbElems) {
+          std::this_thread::yield();
+          nbPushed += static_cast<uint32_t>(q.try_push_n(batch + nbPushed, nbElems - nbPushed));
+        }
+        i += nbElems;
+      }
+    }
+  });
+  Payload popped[5];
+  for (uint32_t expected = 0; expected < kNbElems;) {
+    const std::size_t nbPopped = expected % 7 == 0 ? q.try_pop(popped[0]) : q.try_pop_n(popped, 5);
+    if (nbPopped == 0) {
+      std::this_thread::yield();
+    }
+    for (std::size_t i = 0; i < nbPopped; ++i, ++expected) {
+      ASSERT_FALSE(popped[i].empty());
+      ASSERT_EQ(popped[i].front(), expected);
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(QueuesTest, MPMCQueue) {
+  EXPECT_THROW(MPMCQueue<int>(0), std::length_error);
+  MPMCQueue<std::string> q(5);
+  EXPECT_EQ(q.capacity(), 8U);
+  std::string out;
+  EXPECT_FALSE(q.try_pop(out));
+  std::string batch[10];
+  for (int i = 0; i < 10; ++i) {
+    batch[i] = std::to_string(i);
+  }
+  EXPECT_EQ(q.try_push_n(batch, 10), 8U);
+  EXPECT_EQ(q.size(), 8U);
+  EXPECT_FALSE(q.try_push(batch[8]));
+  EXPECT_TRUE(q.try_pop(out));
+  EXPECT_EQ(out, "0");
+  EXPECT_TRUE(q.try_emplace(3, 'z'));
+  std::string popped[10];
+  EXPECT_EQ(q.try_pop_n(popped, 10), 8U);
+  EXPECT_EQ(popped[0], "1");
+  EXPECT_EQ(popped[7], "zzz");
+  EXPECT_TRUE(q.empty());
+
+  // Remaining elements are destroyed with the queue
+  EXPECT_TRUE(q.try_push("remaining"));
+}
+
+TEST(QueuesTest, RelocationAvoidsMoveOperations) {
+  // Trivially relocatable elements are moved by memcpy: no forbidden move operation
+  SPSCQueue<MoveForbidden<true>, 4> spsc;
+  MoveForbidden<true> out[4];
+  EXPECT_TRUE(spsc.try_emplace());
+  EXPECT_TRUE(spsc.try_emplace());
+  EXPECT_NO_THROW(spsc.try_pop(out[0]));
+  EXPECT_EQ(spsc.try_pop_n(out, 4), 1U);
+
+  MPMCQueue<MoveForbidden<true>> mpmc(4);
+  EXPECT_NO_THROW(mpmc.try_emplace());
+  EXPECT_NO_THROW(mpmc.try_pop(out[0]));
+}
+
+TEST(QueuesTest, MPMCQueueThreads) {
+  constexpr uint32_t kNbProducers = 3;
+  constexpr uint32_t kNbConsumers = 3;
+  constexpr uint32_t kNbElemsPerProducer = 30000;
+  // Elements are pairs of producer id and sequence number
+  using Elem = std::pair<uint32_t, uint32_t>;
+  MPMCQueue<Elem> q(16);
+
+  std::vector<std::thread> threads;
+  for (uint32_t producerId = 0; producerId < kNbProducers; ++producerId) {
+    threads.emplace_back([&q, producerId] {
+      for (uint32_t seq = 0; seq < kNbElemsPerProducer; ++seq) {
+        while (!q.try_push(Elem(producerId, seq))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::atomic<uint32_t> nbPopped{0};
+  std::vector<uint64_t> sums(kNbConsumers);
+  std::vector<uint32_t> nbOrderErrors(kNbConsumers);
+  for (uint32_t consumerId = 0; consumerId < kNbConsumers; ++consumerId) {
+    threads.emplace_back([&, consumerId] {
+      // Elements of a given producer are popped in order by each consumer
+      std::vector<uint32_t> lastSeqs(kNbProducers);
+      Elem batch[4];
+      while (nbPopped.load() < kNbProducers * kNbElemsPerProducer) {
+        const std::size_t nbElems = q.try_pop_n(batch, 4);
+        if (nbElems == 0) {
+          std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < nbElems; ++i) {
+          sums[consumerId] += batch[i].second;
+          if (batch[i].second != 0 && batch[i].second <= lastSeqs[batch[i].first]) {
+            ++nbOrderErrors[consumerId];
+          }
+          lastSeqs[batch[i].first] = batch[i].second;
+        }
+        nbPopped += static_cast<uint32_t>(nbElems);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  uint64_t sum = 0;
+  for (uint32_t consumerId = 0; consumerId < kNbConsumers; ++consumerId) {
+    sum += sums[consumerId];
+    EXPECT_EQ(nbOrderErrors[consumerId], 0U);
+  }
+  EXPECT_EQ(sum, uint64_t(kNbProducers) * (uint64_t(kNbElemsPerProducer) * (kNbElemsPerProducer - 1U) / 2U));
+  EXPECT_TRUE(q.empty());
+}
+
+}  // namespace amc
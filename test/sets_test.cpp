@@ -4,7 +4,13 @@
 #include <amc/config.hpp>
 #include <amc/fixedcapacityvector.hpp>
 #include <amc/flatset.hpp>
+#include <amc/staticsearchset.hpp>
+#include <atomic>
+#include <limits>
 #include <list>
+#include <set>
+#include <string>
+#include <vector>
 #ifdef AMC_SMALLSET
 #include <amc/smallset.hpp>
 #endif
@@ -503,6 +509,163 @@ TEST(FlatSetTest, MergeDifferentCompare) {
   EXPECT_EQ(s2, RevSetType({19, 4, 2, -2}));
 }
 
+template <typename T>
+class FlatSetSearchTest : public ::testing::Test {
+ public:
+  using ValueType = typename T::value_type;
+
+  static ValueType Value(int i) { return static_cast<ValueType>(3 * i - 101); }
+};
+
+typedef ::testing::Types<FlatSet<uint32_t>, FlatSet<int32_t>, FlatSet<uint64_t>, FlatSet<int64_t>, FlatSet<float>,
+                         FlatSet<double>, FlatSet<int64_t, std::less<int64_t>, std::allocator<int64_t>>,
+                         FlatSet<uint32_t, std::less<uint32_t>, std::allocator<uint32_t>,
+                                 std::vector<uint32_t, std::allocator<uint32_t>>>,
+#ifdef AMC_CXX14
+                         FlatSet<double, std::less<>>,
+#endif
+                         FlatSet<int32_t, std::greater<int32_t>>>
+    FlatSetsSearchType;
+TYPED_TEST_SUITE(FlatSetSearchTest, FlatSetsSearchType, );
+
+TYPED_TEST(FlatSetSearchTest, BoundsForAllSizes) {
+  using ValueType = typename TestFixture::ValueType;
+  using Limits = std::numeric_limits<ValueType>;
+  TypeParam s{Limits::lowest(), Limits::max()};
+  auto comp = s.key_comp();
+  for (int size = 0; size < 150; ++size) {
+    for (int i = -1; i <= size + 1; ++i) {
+      for (ValueType v : {static_cast<ValueType>(TestFixture::Value(i) - 1), TestFixture::Value(i),
+                          static_cast<ValueType>(TestFixture::Value(i) + 1), Limits::lowest(), Limits::max()}) {
+        auto lbIt = std::lower_bound(s.begin(), s.end(), v, comp);
+        auto ubIt = std::upper_bound(s.begin(), s.end(), v, comp);
+        EXPECT_EQ(s.lower_bound(v), lbIt);
+        EXPECT_EQ(s.upper_bound(v), ubIt);
+        EXPECT_EQ(s.find(v), lbIt != ubIt ? lbIt : s.end());
+        EXPECT_EQ(s.contains(v), lbIt != ubIt);
+      }
+    }
+    EXPECT_TRUE(s.insert(TestFixture::Value(size)).second);
+    EXPECT_FALSE(s.insert(TestFixture::Value(size)).second);
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end(), comp));
+  }
+  EXPECT_EQ(s.erase(TestFixture::Value(42)), 1U);
+  EXPECT_FALSE(s.contains(TestFixture::Value(42)));
+}
+
+TEST(FlatSetTest, InsertRangeInExistingSet) {
+  using SetType = FlatSet<int>;
+  std::set<int> ref;
+  SetType s;
+  std::vector<int> toInsert;
+  for (int round = 0; round < 20; ++round) {
+    toInsert.clear();
+    for (int i = 0; i < 10 * round; ++i) {
+      // mix of new values, duplicates among themselves and values already present
+      toInsert.push_back(static_cast<int>((i * 7919 + round * 104729) % (30 * (round + 1))));
+    }
+    if (round % 3 == 0) {
+      std::sort(toInsert.begin(), toInsert.end());
+    }
+    s.insert(toInsert.begin(), toInsert.end());
+    ref.insert(toInsert.begin(), toInsert.end());
+    ASSERT_EQ(s.size(), ref.size());
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), ref.begin()));
+  }
+  // Values all greater than existing ones
+  const int kGreater[] = {1000000, 999999, 1000001};
+  s.insert(std::begin(kGreater), std::end(kGreater));
+  EXPECT_EQ(s.size(), ref.size() + 3U);
+  EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+  EXPECT_EQ(*std::prev(s.end()), 1000001);
+  // Empty range
+  s.insert(toInsert.end(), toInsert.end());
+  EXPECT_EQ(s.size(), ref.size() + 3U);
+}
+
+template <typename T>
+class FlatSetPresortedTest : public ::testing::Test {};
+
+typedef ::testing::Types<int, ComplexTriviallyRelocatableType, ComplexNonTriviallyRelocatableType> PresortedTypes;
+TYPED_TEST_SUITE(FlatSetPresortedTest, PresortedTypes, );
+
+TYPED_TEST(FlatSetPresortedTest, ConstructAndInsertFromRuns) {
+  using SetType = FlatSet<TypeParam>;
+  for (uint32_t nbRuns : {1U, 2U, 3U, 7U, 16U, 40U}) {
+    for (uint32_t runLen : {1U, 15U, 16U, 33U, 100U}) {
+      // Runs of increasing values, starting from overlapping positions, with a few duplicates
+      std::vector<uint32_t> values;
+      for (uint32_t run = 0; run < nbRuns; ++run) {
+        for (uint32_t i = 0; i < runLen + run; ++i) {
+          values.push_back(((run * 37U) % 101U) + 2U * i);
+        }
+      }
+      std::set<uint32_t> ref(values.begin(), values.end());
+      SetType s(values.begin(), values.end());
+      ASSERT_EQ(s.size(), ref.size());
+      EXPECT_TRUE(std::equal(s.begin(), s.end(), ref.begin(), [](const TypeParam &lhs, uint32_t rhs) {
+        return !(lhs < TypeParam(rhs)) && !(TypeParam(rhs) < lhs);
+      }));
+
+      SetType s2{0U, 50U, 100U};
+      s2.insert(values.begin(), values.end());
+      ref.insert({0U, 50U, 100U});
+      ASSERT_EQ(s2.size(), ref.size());
+      EXPECT_TRUE(std::is_sorted(s2.begin(), s2.end()));
+    }
+  }
+}
+
+namespace {
+struct ThrowingCompareException {};
+
+/// Comparator throwing after a given number of comparisons
+struct ThrowingLess {
+  template <class T>
+  bool operator()(const T &lhs, const T &rhs) const {
+    if (--*pNbComparisonsBeforeThrow == 0) {
+      throw ThrowingCompareException();
+    }
+    return lhs < rhs;
+  }
+
+  int *pNbComparisonsBeforeThrow;
+};
+}  // namespace
+
+TEST(FlatSetTest, ConstructFromRunsWithThrowingCompare) {
+  using SetType = FlatSet<ComplexTriviallyRelocatableType, ThrowingLess>;
+  std::vector<uint32_t> values;
+  for (uint32_t run = 0; run < 8U; ++run) {
+    for (uint32_t i = 0; i < 64U; ++i) {
+      values.push_back(run + 8U * i);
+    }
+  }
+  for (int nbComparisons : {600, 700, 800, 1000, 2000}) {
+    int nbComparisonsBeforeThrow = nbComparisons;
+    // Elements should all be destroyed exactly once
+    EXPECT_THROW(SetType(values.begin(), values.end(), ThrowingLess{&nbComparisonsBeforeThrow}),
+                 ThrowingCompareException);
+  }
+  int nbComparisonsBeforeThrow = 1000000;
+  SetType s(values.begin(), values.end(), ThrowingLess{&nbComparisonsBeforeThrow});
+  EXPECT_EQ(s.size(), values.size());
+}
+
+TEST(FlatSetTest, FloatingPointBounds) {
+  FlatSet<double> s{-std::numeric_limits<double>::infinity(), -1.5, -0.0, 2.25,
+                    std::numeric_limits<double>::infinity()};
+  EXPECT_EQ(s.size(), 5U);
+  EXPECT_EQ(s.lower_bound(0.0), s.begin() + 2);
+  EXPECT_EQ(s.upper_bound(0.0), s.begin() + 3);
+  EXPECT_EQ(s.find(0.0), s.begin() + 2);
+  EXPECT_EQ(s.lower_bound(std::numeric_limits<double>::infinity()), s.begin() + 4);
+  EXPECT_EQ(s.upper_bound(std::numeric_limits<double>::infinity()), s.end());
+  // NaN is neither less nor greater than any other value: bounds are the same as the ones of std algorithms
+  EXPECT_EQ(s.lower_bound(std::numeric_limits<double>::quiet_NaN()), s.begin());
+  EXPECT_EQ(s.upper_bound(std::numeric_limits<double>::quiet_NaN()), s.end());
+}
+
 #ifdef AMC_CXX14
 template <typename T>
 class SetListEquivalentType : public ::testing::Test {
@@ -550,6 +713,83 @@ TEST(SmallSetTest, MergeDifferentCompare) {
 }
 #endif
 
+#ifdef AMC_SMALLSET
+enum class ScanEnum : int16_t { kMin = -32768, kMax = 32767 };
+
+int gScanArray[64];
+
+template <class T>
+T ScanValue(int i) {
+  return static_cast<T>(i % 2 == 0 ? i * 37 : -i * 11);
+}
+
+template <>
+ScanEnum ScanValue<ScanEnum>(int i) {
+  return static_cast<ScanEnum>(i % 2 == 0 ? i * 37 : -i * 11);
+}
+
+template <>
+int *ScanValue<int *>(int i) {
+  return gScanArray + i;
+}
+
+template <typename T>
+class SmallSetScanTest : public ::testing::Test {
+ public:
+  using ValueType = typename T::value_type;
+};
+
+typedef ::testing::Types<SmallSet<int8_t, 64>, SmallSet<uint8_t, 33>, SmallSet<int16_t, 64, std::greater<int16_t>>,
+                         SmallSet<uint32_t, 64>, SmallSet<int32_t, 17>, SmallSet<int64_t, 64>,
+                         SmallSet<uint64_t, 31, std::greater<uint64_t>>, SmallSet<ScanEnum, 40>, SmallSet<int *, 64>,
+                         SmallSet<int64_t, 64, std::less<>>>
+    SmallSetsScanType;
+TYPED_TEST_SUITE(SmallSetScanTest, SmallSetsScanType, );
+
+TYPED_TEST(SmallSetScanTest, FindAtAllPositions) {
+  using ValueType = typename TestFixture::ValueType;
+  TypeParam s;
+  std::set<ValueType> ref;
+  for (int size = 0; size < 64; ++size) {
+    for (int i = 0; i < 64; ++i) {
+      ValueType v = ScanValue<ValueType>(i);
+      EXPECT_EQ(s.contains(v), ref.count(v) == 1U);
+      auto it = s.find(v);
+      if (ref.count(v) == 1U) {
+        ASSERT_NE(it, s.end());
+        EXPECT_EQ(*it, v);
+      } else {
+        EXPECT_EQ(it, s.end());
+      }
+    }
+    ValueType newVal = ScanValue<ValueType>(size);
+    EXPECT_EQ(s.insert(newVal).second, ref.insert(newVal).second);
+    EXPECT_FALSE(s.emplace(newVal).second);
+    EXPECT_EQ(s.size(), ref.size());
+  }
+}
+
+TYPED_TEST(SmallSetScanTest, EraseAndMerge) {
+  using ValueType = typename TestFixture::ValueType;
+  TypeParam s1;
+  TypeParam s2;
+  for (int i = 0; i < 16; ++i) {
+    s1.insert(ScanValue<ValueType>(i));
+    s2.insert(ScanValue<ValueType>(i + 8));
+  }
+  EXPECT_EQ(s1.erase(ScanValue<ValueType>(3)), 1U);
+  EXPECT_EQ(s1.erase(ScanValue<ValueType>(3)), 0U);
+  EXPECT_FALSE(s1.contains(ScanValue<ValueType>(3)));
+  s1.merge(s2);
+  EXPECT_EQ(s1.size(), 23U);
+  EXPECT_EQ(s2.size(), 8U);
+  for (int i = 0; i < 24; ++i) {
+    EXPECT_EQ(s1.contains(ScanValue<ValueType>(i)), i != 3);
+    EXPECT_EQ(s2.contains(ScanValue<ValueType>(i)), i >= 8 && i < 16);
+  }
+}
+#endif
+
 #ifdef AMC_NONSTD_FEATURES
 TEST(FlatSetTest, SpecificPointerMethods) {
   using SetType = FlatSet<int>;
@@ -578,5 +818,218 @@ TEST(FlatSetTest, StealVector) {
   EXPECT_TRUE(s.empty());
   EXPECT_EQ(stolenVec, VecType({-1, 0, 5, 6, 8}));
 }
+
+TEST(FlatSetTest, SortedUniqueVector) {
+  using SetType = FlatSet<int>;
+  using VecType = SetType::vector_type;
+  SetType s(sorted_unique, VecType({-1, 0, 5, 6, 8}));
+  EXPECT_EQ(s, SetType({8, 6, 5, 0, -1}));
+  s.replace(VecType({1, 2, 3}));
+  EXPECT_EQ(s, SetType({1, 2, 3}));
+#ifndef NDEBUG
+  EXPECT_DEATH(s.replace(VecType({1, 3, 2})), "");
+  EXPECT_DEATH(s.replace(VecType({1, 2, 2})), "");
+#endif
+}
+
+template <typename T>
+class FlatSetParallelTest : public ::testing::Test {};
+
+TYPED_TEST_SUITE(FlatSetParallelTest, PresortedTypes, );
+
+TYPED_TEST(FlatSetParallelTest, ConstructInsertAndMerge) {
+  using SetType = FlatSet<TypeParam>;
+  // Large enough to be split across several threads, with duplicates
+  std::vector<uint32_t> values(100000U);
+  for (uint32_t i = 0; i < values.size(); ++i) {
+    values[i] = (i * 7919U) % 70001U;
+  }
+  std::set<uint32_t> ref(values.begin(), values.end());
+  SetType s(parallel_t(4), values.begin(), values.end());
+  EXPECT_EQ(s, SetType(values.begin(), values.end()));
+  EXPECT_EQ(s.size(), ref.size());
+
+  std::vector<uint32_t> newValues(70000U);
+  for (uint32_t i = 0; i < newValues.size(); ++i) {
+    newValues[i] = 50000U + 3U * i;
+  }
+  s.insert(parallel_t(3), newValues.begin(), newValues.end());
+  SetType expected(values.begin(), values.end());
+  expected.insert(newValues.begin(), newValues.end());
+  EXPECT_EQ(s, expected);
+
+  SetType o;
+  SetType expectedO;
+  for (uint32_t i = 0; i < 100000U; ++i) {
+    o.insert(o.end(), TypeParam(i * 2U));
+    if (expected.contains(TypeParam(i * 2U))) {
+      expectedO.insert(expectedO.end(), TypeParam(i * 2U));
+    }
+  }
+  expected.insert(o.begin(), o.end());
+  s.merge(parallel, o);
+  EXPECT_EQ(s, expected);
+  EXPECT_EQ(o, expectedO);
+}
+
+namespace {
+/// Thread safe comparator throwing after a given number of comparisons
+struct ConcurrentThrowingLess {
+  template <class T>
+  bool operator()(const T &lhs, const T &rhs) const {
+    if (--*pNbComparisonsBeforeThrow == 0) {
+      throw ThrowingCompareException();
+    }
+    return lhs < rhs;
+  }
+
+  std::atomic<int> *pNbComparisonsBeforeThrow;
+};
+}  // namespace
+
+TYPED_TEST(FlatSetParallelTest, ThrowingCompare) {
+  using SetType = FlatSet<TypeParam, ConcurrentThrowingLess>;
+  std::vector<uint32_t> values(70000U);
+  for (uint32_t i = 0; i < values.size(); ++i) {
+    values[i] = (i * 7919U) % 70001U;
+  }
+  for (int nbComparisons : {1000, 100000, 500000}) {
+    std::atomic<int> nbComparisonsBeforeThrow(nbComparisons);
+    // Elements should all be destroyed exactly once
+    EXPECT_THROW(SetType(parallel_t(2), values.begin(), values.end(), ConcurrentThrowingLess{&nbComparisonsBeforeThrow}),
+                 ThrowingCompareException);
+  }
+}
 #endif
+
+TEST(FlatSetTest, SortedUniqueConstructors) {
+  using SetType = FlatSet<int>;
+  const int kValues[] = {-4, 0, 2, 7};
+  SetType s1(sorted_unique, std::begin(kValues), std::end(kValues));
+  EXPECT_EQ(s1, SetType({2, 7, -4, 0}));
+  SetType s2(sorted_unique, {-4, 0, 2, 7});
+  EXPECT_EQ(s1, s2);
+  FlatSet<int, std::greater<int>> s3(sorted_unique, {7, 2, 0, -4});
+  EXPECT_TRUE(std::equal(s3.begin(), s3.end(), s1.rbegin()));
+  SetType s4(sorted_unique, std::begin(kValues), std::begin(kValues));
+  EXPECT_TRUE(s4.empty());
+#ifndef NDEBUG
+  EXPECT_DEATH(SetType(sorted_unique, {0, 2, 2}), "");
+#endif
+}
+
+TEST(FlatSetTest, InsertSortedUnique) {
+  using SetType = FlatSet<int>;
+  SetType s{1, 4, 7, 10};
+  const int kValues[] = {0, 4, 5, 12};
+  s.insert(sorted_unique, std::begin(kValues), std::end(kValues));
+  EXPECT_EQ(s, SetType({0, 1, 4, 5, 7, 10, 12}));
+  s.insert(sorted_unique, {13, 14});
+  EXPECT_EQ(s.size(), 9U);
+  EXPECT_EQ(*std::prev(s.end()), 14);
+  s.insert(sorted_unique, std::begin(kValues), std::begin(kValues));
+  EXPECT_EQ(s.size(), 9U);
+#ifndef NDEBUG
+  EXPECT_DEATH(s.insert(sorted_unique, {20, 19}), "");
+#endif
+}
+
+TEST(StaticSearchSetTest, LookupsForAllSizes) {
+  for (int n = 0; n < 70; ++n) {
+    std::set<int> ref;
+    FlatSet<int> flatSet;
+    for (int i = 0; i < n; ++i) {
+      ref.insert(2 * i);
+      flatSet.insert(2 * i);
+    }
+    StaticSearchSet<int> s(flatSet);
+    ASSERT_EQ(s.size(), ref.size());
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), ref.begin()));
+    EXPECT_TRUE(std::equal(s.rbegin(), s.rend(), ref.rbegin()));
+    EXPECT_EQ(static_cast<std::size_t>(std::distance(s.begin(), s.end())), ref.size());
+    for (int v = -1; v <= 2 * n; ++v) {
+      auto lb = s.lower_bound(v);
+      auto refLb = ref.lower_bound(v);
+      ASSERT_EQ(lb == s.end(), refLb == ref.end()) << "n=" << n << " v=" << v;
+      if (lb != s.end()) {
+        EXPECT_EQ(*lb, *refLb);
+      }
+      auto ub = s.upper_bound(v);
+      auto refUb = ref.upper_bound(v);
+      ASSERT_EQ(ub == s.end(), refUb == ref.end()) << "n=" << n << " v=" << v;
+      if (ub != s.end()) {
+        EXPECT_EQ(*ub, *refUb);
+      }
+      EXPECT_EQ(s.contains(v), ref.count(v) == 1U);
+      EXPECT_EQ(s.count(v), ref.count(v));
+      EXPECT_EQ(s.find(v) == s.end(), ref.find(v) == ref.end());
+      auto range = s.equal_range(v);
+      EXPECT_EQ(static_cast<std::size_t>(std::distance(range.first, range.second)), ref.count(v));
+    }
+  }
+}
+
+TEST(StaticSearchSetTest, Constructors) {
+  using SetType = StaticSearchSet<int, std::greater<int>>;
+  SetType s1{4, 7, -1, 4, 12, 7};
+  EXPECT_EQ(s1.size(), 4U);
+  EXPECT_TRUE(std::is_sorted(s1.begin(), s1.end(), s1.key_comp()));
+  EXPECT_EQ(*s1.begin(), 12);
+  std::list<int> l{12, -1, 7, 4};
+  SetType s2(l.begin(), l.end());
+  EXPECT_EQ(s1, s2);
+  SetType s3(FlatSet<int, std::greater<int>>{-1, 4, 7, 12});
+  EXPECT_EQ(s1, s3);
+  EXPECT_EQ(s3.to_flat_set(), (FlatSet<int, std::greater<int>>{-1, 4, 7, 12}));
+  s3 = {3};
+  EXPECT_EQ(s3.size(), 1U);
+  EXPECT_NE(s1, s3);
+  s3.clear();
+  EXPECT_TRUE(s3.empty());
+  EXPECT_EQ(s3.begin(), s3.end());
+}
+
+TEST(StaticSearchSetTest, SwapAndComparisons) {
+  using SetType = StaticSearchSet<std::string>;
+  SetType s1{"Paris", "London", "Nice"};
+  SetType s2{"Madrid"};
+  EXPECT_LT(s1, s2);
+  swap(s1, s2);
+  EXPECT_EQ(s1, SetType({"Madrid"}));
+  EXPECT_GT(s1, s2);
+  EXPECT_GE(s2, SetType({"London", "Nice"}));
+  EXPECT_TRUE(s2.contains("Nice"));
+  EXPECT_FALSE(s2.contains("Madrid"));
+}
+
+#ifdef AMC_CXX14
+TEST(StaticSearchSetTest, TransparentLookups) {
+  StaticSearchSet<std::string, std::less<>> s{"ABC", "DEF", "GHI"};
+  EXPECT_TRUE(s.contains("DEF"));
+  EXPECT_EQ(s.count("DEG"), 0U);
+  EXPECT_EQ(*s.lower_bound("DEG"), "GHI");
+  EXPECT_EQ(*s.upper_bound("ABC"), "DEF");
+  EXPECT_EQ(s.find("XYZ"), s.end());
+}
+#endif
+
+TEST(StaticSearchSetTest, Relocatability) {
+  static_assert(is_trivially_relocatable<StaticSearchSet<int>>::value, "");
+  static_assert(is_trivially_relocatable<StaticSearchSet<std::list<int>>>::value, "");
+}
+
+#ifdef AMC_NONSTD_FEATURES
+TEST(StaticSearchSetTest, CreateFromFlatSetAndVector) {
+  using SetType = StaticSearchSet<int>;
+  FlatSet<int> flatSet{5, -1, 6, 8, 0};
+  SetType s1(std::move(flatSet));
+  EXPECT_TRUE(flatSet.empty());
+  SetType::vector_type v{8, 0, 6, -1, 5, 6};
+  SetType s2(std::move(v));
+  EXPECT_EQ(s1, s2);
+  // Elements are stored in breadth first order of the implicit binary search tree
+  EXPECT_EQ(std::vector<int>(s1.data(), s1.data() + s1.size()), std::vector<int>({6, 0, 8, -1, 5}));
+}
+#endif
+
 }  // namespace amc
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <amc/flatset.hpp>
+#include <amc/inlinestring.hpp>
+#include <amc/smallstring.hpp>
+#include <amc/vector.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace amc {
+
+static_assert(sizeof(SmallString<8>) == 2 * sizeof(uint32_t) + sizeof(char *), "SmallString<8> should share its pointer");
+static_assert(is_trivially_relocatable<SmallString<8>>::value, "SmallString should be trivially relocatable");
+static_assert(is_trivially_relocatable<SmallString<40>>::value, "SmallString should be trivially relocatable");
+static_assert(sizeof(InlineString<24>) == 24, "InlineString should only store its chars");
+static_assert(std::is_trivially_copyable<InlineString<24>>::value, "InlineString should be trivially copyable");
+
+TEST(StringsTest, SmallStringBasics) {
+  using StringType = SmallString<8>;
+  StringType s;
+  EXPECT_TRUE(s.empty());
+  EXPECT_STREQ(s.c_str(), "");
+  EXPECT_EQ(s.capacity(), StringType::kInlineCapacity);
+
+  s = "abcdefg";
+  EXPECT_EQ(s.size(), 7U);
+  EXPECT_EQ(s.capacity(), 7U);
+  s.push_back('h');
+  EXPECT_GT(s.capacity(), 7U);
+  EXPECT_STREQ(s.c_str(), "abcdefgh");
+  EXPECT_EQ(s.front(), 'a');
+  EXPECT_EQ(s.back(), 'h');
+  EXPECT_THROW(s.at(8), std::out_of_range);
+  s.pop_back();
+  EXPECT_EQ(s, "abcdefg");
+  s.shrink_to_fit();
+  EXPECT_EQ(s.capacity(), 7U);
+  EXPECT_EQ(s, "abcdefg");
+
+  StringType filled(20, 'x');
+  EXPECT_EQ(filled.size(), 20U);
+  EXPECT_EQ(filled[19], 'x');
+  EXPECT_EQ(filled.c_str()[20], '\0');
+  filled.resize(3);
+  EXPECT_EQ(filled, "xxx");
+  filled.resize(5, 'y');
+  EXPECT_EQ(filled, "xxxyy");
+  filled.clear();
+  EXPECT_TRUE(filled.empty());
+  EXPECT_STREQ(filled.c_str(), "");
+
+  std::string ref("from iterators");
+  StringType fromIt(ref.begin(), ref.end());
+  EXPECT_EQ(std::string(fromIt.begin(), fromIt.end()), ref);
+  EXPECT_EQ(std::string(fromIt.rbegin(), fromIt.rend()), std::string(ref.rbegin(), ref.rend()));
+}
+
+TEST(StringsTest, SmallStringModifiers) {
+  using StringType = SmallString<16>;
+  StringType s("world");
+  s.insert(0, "hello ");
+  s += '!';
+  s.append(3, '?');
+  EXPECT_EQ(s, "hello world!???");
+  s.erase(12);
+  EXPECT_EQ(s, "hello world!");
+  s.erase(5, 1);
+  EXPECT_EQ(s, "helloworld!");
+  s.insert(5, 2, '-');
+  EXPECT_EQ(s, "hello--world!");
+  EXPECT_THROW(s.insert(14, "x"), std::out_of_range);
+
+  // Parts of the string itself are valid arguments, even if the string grows
+  s.append(s.data(), s.size());
+  EXPECT_EQ(s, "hello--world!hello--world!");
+  s.insert(0, s.data() + 7, 5);
+  EXPECT_EQ(s, "worldhello--world!hello--world!");
+  s.assign(s.data() + 5, 5);
+  EXPECT_EQ(s, "hello");
+
+  StringType copy(s);
+  StringType moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_STREQ(copy.c_str(), "");
+  copy = moved + " " + StringType("there") + '.';
+  EXPECT_EQ(copy, "hello there.");
+  EXPECT_EQ(copy.substr(6, 5), "there");
+  EXPECT_EQ(copy.substr(6), "there.");
+  swap(copy, moved);
+  EXPECT_EQ(moved, "hello there.");
+
+  // Large strings are moved by stealing their buffer
+  StringType large(100, 'l');
+  const char *largeData = large.data();
+  StringType stolen;
+  stolen = std::move(large);
+  EXPECT_EQ(stolen.data(), largeData);
+  EXPECT_TRUE(large.empty());
+  large += "reused";
+  EXPECT_EQ(large, "reused");
+}
+
+TEST(StringsTest, SmallStringSearchAndCompare) {
+  SmallString<24> s("abracadabra");
+  EXPECT_EQ(s.find("abra"), 0U);
+  EXPECT_EQ(s.find("abra", 1), 7U);
+  EXPECT_EQ(s.find("abrax"), s.npos);
+  EXPECT_EQ(s.find(""), 0U);
+  EXPECT_EQ(s.find("", 11), 11U);
+  EXPECT_EQ(s.find("", 12), s.npos);
+  EXPECT_EQ(s.find('c'), 4U);
+  EXPECT_EQ(s.find('a', 8), 10U);
+  EXPECT_EQ(s.find('z'), s.npos);
+  EXPECT_EQ(s.rfind("abra"), 7U);
+  EXPECT_EQ(s.rfind("abra", 6), 0U);
+  EXPECT_EQ(s.rfind('a'), 10U);
+  EXPECT_EQ(s.rfind('a', 9), 7U);
+  EXPECT_EQ(s.rfind("abracadabras"), s.npos);
+  EXPECT_TRUE(s.starts_with("abr"));
+  EXPECT_TRUE(s.ends_with("bra"));
+  EXPECT_FALSE(s.ends_with("abracadabra!"));
+  EXPECT_TRUE(s.contains("cad"));
+  EXPECT_FALSE(s.contains('z'));
+
+  EXPECT_EQ(s.compare("abracadabra"), 0);
+  EXPECT_LT(s.compare("abracadabrb"), 0);
+  EXPECT_GT(s.compare("abra"), 0);
+  EXPECT_TRUE(s < "b");
+  EXPECT_TRUE("a" < s);
+  EXPECT_TRUE(s != "abra");
+  EXPECT_TRUE("abracadabra" == s);
+  SmallString<8> other("abra");
+  EXPECT_TRUE(other < s);
+  EXPECT_TRUE(s > other);
+  EXPECT_TRUE(s >= s);
+  EXPECT_FALSE(s == other);
+
+  std::ostringstream os;
+  os << s;
+  EXPECT_EQ(os.str(), "abracadabra");
+}
+
+#ifdef AMC_CXX17
+TEST(StringsTest, SmallStringStringView) {
+  using StringType = SmallString<16>;
+  std::string_view sv("string view");
+  StringType s(sv);
+  EXPECT_EQ(s, sv);
+  EXPECT_EQ(std::string_view(s), sv);
+  s = std::string_view("other");
+  s += std::string_view(" view");
+  EXPECT_EQ(s, "other view");
+  EXPECT_EQ(std::string_view("other view"), s);
+  EXPECT_EQ(std::string(s), "other view");
+
+  std::unordered_set<StringType> set{StringType("a"), StringType("b"), StringType("a")};
+  EXPECT_EQ(set.size(), 2U);
+  EXPECT_EQ(set.count(StringType("b")), 1U);
+}
+#endif
+
+TEST(StringsTest, VectorOfSmallStrings) {
+  // Strings are relocated when the vector grows: heap buffers of large strings are kept
+  vector<SmallString<16>> v;
+  std::vector<const char *> largeData;
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(static_cast<uint32_t>(i % 3 == 0 ? 30 : 5), static_cast<char>('a' + i % 26));
+    largeData.push_back(i % 3 == 0 ? v.back().data() : nullptr);
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(v[i].size(), i % 3 == 0 ? 30U : 5U);
+    EXPECT_EQ(v[i].front(), static_cast<char>('a' + i % 26));
+    if (i % 3 == 0) {
+      EXPECT_EQ(v[i].data(), largeData[i]);
+    }
+  }
+  v.erase(v.begin());
+  EXPECT_EQ(v.front(), "bbbbb");
+}
+
+TEST(StringsTest, InlineStringBasics) {
+  using StringType = InlineString<8>;
+  StringType s;
+  EXPECT_TRUE(s.empty());
+  EXPECT_STREQ(s.c_str(), "");
+  EXPECT_EQ(s, "");
+
+  StringType full("1234567");
+  EXPECT_EQ(full.size(), StringType::kCapacity);
+  EXPECT_STREQ(full.c_str(), "1234567");
+  EXPECT_EQ(full.front(), '1');
+  EXPECT_EQ(full.back(), '7');
+  EXPECT_THROW(full.at(7), std::out_of_range);
+  EXPECT_THROW(StringType("12345678"), std::length_error);
+
+  InlineString<24> code("LHR");
+  EXPECT_EQ(code.size(), 3U);
+  EXPECT_EQ(std::string(code.begin(), code.end()), "LHR");
+  EXPECT_EQ(std::string(code.rbegin(), code.rend()), "RHL");
+  EXPECT_TRUE(code == "LHR");
+  EXPECT_TRUE("LHRX" != code);
+  EXPECT_EQ(code, InlineString<24>(std::string("LHR!").c_str(), 3));
+
+  std::ostringstream os;
+  os << code;
+  EXPECT_EQ(os.str(), "LHR");
+}
+
+TEST(StringsTest, InlineStringOrdering) {
+  // Same order as std::string, including chars above 127 and embedded null chars
+  std::vector<std::string> refs{"",
+                                "a",
+                                std::string("a\0", 2),
+                                std::string("a\0\0", 3),
+                                "a\x01",
+                                "ab",
+                                "abcdefgh",
+                                "abcdefghi",
+                                "abcdefgi",
+                                "\x7f",
+                                "\x80",
+                                "\xff",
+                                "zzzzzzzzzzzzzzzzzzzzzzy",
+                                "zzzzzzzzzzzzzzzzzzzzzzz",
+                                std::string(23, '\0')};
+  for (const std::string &lhs : refs) {
+    const InlineString<24> lhsStr(lhs.data(), lhs.size());
+    EXPECT_EQ(lhsStr.size(), lhs.size());
+    for (const std::string &rhs : refs) {
+      const InlineString<24> rhsStr(rhs.data(), rhs.size());
+      EXPECT_EQ(lhsStr < rhsStr, lhs < rhs) << lhs << " " << rhs;
+      EXPECT_EQ(lhsStr == rhsStr, lhs == rhs) << lhs << " " << rhs;
+      EXPECT_EQ(lhsStr.compare(rhsStr) < 0, lhs.compare(rhs) < 0) << lhs << " " << rhs;
+      EXPECT_EQ(lhsStr.compare(rhsStr) > 0, lhs.compare(rhs) > 0) << lhs << " " << rhs;
+      EXPECT_EQ(lhsStr >= rhsStr, lhs >= rhs);
+    }
+  }
+}
+
+TEST(StringsTest, FlatSetOfInlineStrings) {
+  FlatSet<InlineString<24>> airports{"NCE", "CDG", "LHR", "JFK", "CDG", "SIN"};
+  EXPECT_EQ(airports.size(), 5U);
+  EXPECT_EQ(airports.front(), "CDG");
+  EXPECT_EQ(airports.back(), "SIN");
+  EXPECT_TRUE(airports.contains("NCE"));
+  EXPECT_FALSE(airports.contains("NC"));
+  airports.insert("AMS");
+  airports.erase("JFK");
+  std::vector<std::string> expected{"AMS", "CDG", "LHR", "NCE", "SIN"};
+  EXPECT_TRUE(std::equal(airports.begin(), airports.end(), expected.begin(),
+                         [](const InlineString<24> &lhs, const std::string &rhs) { return lhs == rhs.c_str(); }));
+#ifdef AMC_CXX17
+  EXPECT_EQ(std::string_view(airports.front()), "AMS");
+  EXPECT_EQ(std::hash<InlineString<24>>()(airports.front()), std::hash<std::string_view>()("AMS"));
+#endif
+}
+
+}  // namespace amc
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <amc/allocator.hpp>
 #include <amc/type_traits.hpp>
 #include <cstdint>
 #include <cstdlib>
@@ -381,4 +382,56 @@ class TestReallocateAllocator {
   char bytes[20];
 };
 
+/// Basic allocator of a single block, which can always be expanded in place up to 32 bytes
+class TestExpandAllocator {
+ public:
+  void *allocate(size_t n) {
+    if (_allocated || n > sizeof(bytes)) {
+      throw BiggerAllocateException();
+    }
+    _allocated = true;
+    return bytes;
+  }
+
+  bool try_expand(void *, size_t, size_t newSz) { return newSz <= sizeof(bytes); }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) {
+    if (!try_expand(p, oldSz, newSz)) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  void deallocate(void *, size_t) { _allocated = false; }
+
+ private:
+  char bytes[32];
+  bool _allocated = false;
+};
+
+/// Basic allocator rounding up the size of its blocks to a multiple of 64 bytes, and telling it
+class TestAtLeastAllocator {
+ public:
+  static constexpr size_t kBlockSize = 64;
+
+  void *allocate(size_t n) { return allocate_at_least(n).ptr; }
+
+  allocation_result<void *> allocate_at_least(size_t n) {
+    const size_t sz = RoundUp(n);
+    return {SimpleAllocator().allocate(sz), sz};
+  }
+
+  void *reallocate(void *p, size_t oldSz, size_t newSz) { return reallocate_at_least(p, oldSz, newSz).ptr; }
+
+  allocation_result<void *> reallocate_at_least(void *p, size_t oldSz, size_t newSz) {
+    const size_t sz = RoundUp(newSz);
+    return {SimpleAllocator().reallocate(p, oldSz, sz), sz};
+  }
+
+  void deallocate(void *p, size_t n) { SimpleAllocator().deallocate(p, n); }
+
+ private:
+  static size_t RoundUp(size_t n) { return ((n + kBlockSize - 1U) / kBlockSize) * kBlockSize; }
+};
+
 }  // namespace amc
@@ -1,12 +1,24 @@
 #include <gtest/gtest.h>
 
 #include <amc/fixedcapacityvector.hpp>
+#include <amc/flatset.hpp>
+#include <amc/memoryresource.hpp>
+#include <amc/mmapallocator.hpp>
+#include <amc/monotonicarena.hpp>
+#include <amc/poolallocator.hpp>
+#include <amc/ringvector.hpp>
+#include <amc/segmentedvector.hpp>
 #include <amc/smallvector.hpp>
+#include <amc/soavector.hpp>
+#include <amc/statsallocator.hpp>
 #include <amc/vector.hpp>
 #include <array>
+#include <cstring>
 #include <initializer_list>
 #include <list>
 #include <numeric>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "testhelpers.hpp"
@@ -259,7 +271,12 @@ typedef ::testing::Types<
     SmallVector<NonTriviallyRelocatableType, 140>, vector<int32_t>, vector<TriviallyCopyableType>,
     vector<ComplexNonTriviallyRelocatableType>,
     vector<ComplexTriviallyRelocatableType, std::allocator<ComplexTriviallyRelocatableType>>,
-    SmallVector<NonTriviallyRelocatableType, 0U, std::allocator<NonTriviallyRelocatableType>, uint64_t>>
+    SmallVector<NonTriviallyRelocatableType, 0U, std::allocator<NonTriviallyRelocatableType>, uint64_t>,
+    vector<int32_t, amc::allocator<int32_t>, uint32_t, vec::DoublingGrowingPolicy>,
+    SmallVector<ComplexNonTriviallyRelocatableType, 5, amc::allocator<ComplexNonTriviallyRelocatableType>, uint32_t,
+                vec::SizeClassGrowingPolicy>,
+    vector<ComplexTriviallyRelocatableType, amc::allocator<ComplexTriviallyRelocatableType>, uint16_t,
+           vec::PageGrowingPolicy>>
     MyTypesForRef;
 TYPED_TEST_SUITE(VectorRefTest, MyTypesForRef, );
 
@@ -587,6 +604,90 @@ TEST(VectorTest, RelocatabilityAvoidsMoveOperations) {
   EXPECT_THROW(v3.emplace_back(), MoveForbiddenException);
 }
 
+TEST(VectorTest, TryExpandAvoidsMoveOperations) {
+  vector<MoveForbidden<false>, BasicAllocatorWrapper<MoveForbidden<false>, TestExpandAllocator>> v(10);
+  // Block is expanded in place: no forbidden move / new allocate operation
+  EXPECT_NO_THROW(v.resize(15));
+  EXPECT_NO_THROW(v.resize(32));
+  // Block cannot be expanded anymore: attempt to allocate a second block should fail
+  EXPECT_THROW(v.resize(33), BiggerAllocateException);
+  EXPECT_EQ(v.size(), 32U);
+
+  SmallVector<MoveForbidden<false>, 4, BasicAllocatorWrapper<MoveForbidden<false>, TestExpandAllocator>> sv(5);
+  EXPECT_NO_THROW(sv.resize(20));
+  EXPECT_EQ(sv.size(), 20U);
+}
+
+#ifdef AMC_MMAP_ALLOCATOR
+TEST(VectorTest, MmapAllocator) {
+  MmapAllocator alloc;
+  const size_t pageSize = MmapAllocator::PageSize();
+  void *p = alloc.allocate(100);
+  EXPECT_TRUE(alloc.try_expand(p, 100, pageSize));
+  std::memset(p, 42, pageSize);
+  p = alloc.reallocate(p, pageSize, 3 * pageSize);
+  EXPECT_EQ(static_cast<char *>(p)[pageSize - 1U], 42);
+  p = alloc.reallocate(p, 3 * pageSize, 10);
+  EXPECT_EQ(static_cast<char *>(p)[9], 42);
+  alloc.deallocate(p, 10);
+
+  vector<std::string, mmap_allocator<std::string>> strings;
+  // Capacity is the whole mapping
+  strings.emplace_back("first");
+  EXPECT_EQ(strings.capacity(), pageSize / sizeof(std::string));
+  for (int i = 1; i < 100000; ++i) {
+    strings.emplace_back(std::to_string(i) + " is not a short string");
+  }
+  EXPECT_EQ(strings.front(), "first");
+  EXPECT_EQ(strings[77777], "77777 is not a short string");
+  strings.shrink_to_fit();
+  EXPECT_EQ(strings.back(), "99999 is not a short string");
+
+  vector<uint64_t, mmap_allocator<uint64_t>> ints(10000, 7U);
+  ints.resize(1000000, 8U);
+  EXPECT_EQ(ints[9999], 7U);
+  EXPECT_EQ(ints[10000], 8U);
+}
+
+template <bool UseHugePages>
+void CheckHugeBufferAllocator() {
+  using Alloc = HugeBufferAllocator<1 << 16, UseHugePages>;
+  using VecType = vector<uint64_t, BasicAllocatorWrapper<uint64_t, Alloc>>;
+  // Grows from heap to mapped storage
+  VecType v;
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v[7777], 7777U);
+  EXPECT_EQ(v.back(), 999999U);
+  v.erase(v.begin() + 100, v.end());
+  // Back to heap storage
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 100U);
+  EXPECT_EQ(v.back(), 99U);
+  v.reserve(Alloc::kMinMappedSize / sizeof(uint64_t));
+  EXPECT_EQ(v.back(), 99U);
+
+  // Non trivially relocatable types are expanded in place when possible
+  vector<std::string, BasicAllocatorWrapper<std::string, Alloc>> strings(10000, "not a short string at all");
+  strings.resize(100000, "another long string");
+  EXPECT_EQ(strings[9999], "not a short string at all");
+  EXPECT_EQ(strings[10000], "another long string");
+}
+
+TEST(VectorTest, HugeBufferAllocator) {
+  CheckHugeBufferAllocator<false>();
+  CheckHugeBufferAllocator<true>();
+
+  HugeBufferAllocator<1 << 16> alloc;
+  auto res = alloc.allocate_at_least(1000);
+  EXPECT_LT(res.count, HugeBufferAllocator<1 << 16>::kMinMappedSize);
+  res = alloc.reallocate_at_least(res.ptr, res.count, 1 << 16);
+  EXPECT_EQ(res.count, size_t(1) << 16);
+  alloc.deallocate(res.ptr, res.count);
+}
+#endif
+
 TEST(VectorTest, RelocatabilityAgainstRefVector) {
   using Vec1 = vector<SmallVector<int, 3>>;
   using Vec2 = vector<FixedCapacityVector<int, 8>>;
@@ -694,6 +795,802 @@ TEST(VectorTest, SmallVectorMoveAssignFromVector) {
   EXPECT_EQ(v.capacity(), 0U);
 }
 
+TEST(VectorTest, GrowingPolicies) {
+  // std::allocator does not round up the capacity to the usable size of the blocks, unlike amc::allocator
+  using Alloc = std::allocator<int32_t>;
+  vector<int32_t, Alloc> v;
+  vector<int32_t, Alloc, uint32_t, vec::DoublingGrowingPolicy> doublingV;
+  vector<int32_t, Alloc, uint32_t, vec::SizeClassGrowingPolicy> sizeClassV;
+  vector<int32_t, Alloc, uint32_t, vec::PageGrowingPolicy> pageV;
+  std::vector<uint32_t> capacities, doublingCapacities, sizeClassCapacities, pageCapacities;
+  for (int32_t i = 0; i < 3000; ++i) {
+    v.push_back(i);
+    doublingV.push_back(i);
+    sizeClassV.push_back(i);
+    pageV.push_back(i);
+    if (capacities.empty() || capacities.back() != v.capacity()) {
+      capacities.push_back(v.capacity());
+    }
+    if (doublingCapacities.empty() || doublingCapacities.back() != doublingV.capacity()) {
+      doublingCapacities.push_back(doublingV.capacity());
+    }
+    if (sizeClassCapacities.empty() || sizeClassCapacities.back() != sizeClassV.capacity()) {
+      sizeClassCapacities.push_back(sizeClassV.capacity());
+    }
+    if (pageCapacities.empty() || pageCapacities.back() != pageV.capacity()) {
+      pageCapacities.push_back(pageV.capacity());
+    }
+  }
+  EXPECT_TRUE(std::equal(v.begin(), v.end(), doublingV.begin()));
+  EXPECT_TRUE(std::equal(v.begin(), v.end(), sizeClassV.begin()));
+  EXPECT_TRUE(std::equal(v.begin(), v.end(), pageV.begin()));
+  EXPECT_EQ(std::vector<uint32_t>(capacities.begin(), capacities.begin() + 6),
+            std::vector<uint32_t>({1, 2, 3, 5, 8, 12}));
+  EXPECT_EQ(std::vector<uint32_t>(doublingCapacities.begin(), doublingCapacities.begin() + 6),
+            std::vector<uint32_t>({1, 2, 4, 8, 16, 32}));
+  // Size classes of 16 bytes up to 64 bytes, then 4 classes per power of 2 (..., 256, 320, 384, 448, 512...)
+  EXPECT_EQ(std::vector<uint32_t>(sizeClassCapacities.begin(), sizeClassCapacities.begin() + 8),
+            std::vector<uint32_t>({4, 8, 12, 20, 32, 48, 80, 128}));
+  // Capacity is rounded to a whole number of 4096 bytes pages above 1024 elements of 4 bytes
+  EXPECT_TRUE(std::all_of(pageCapacities.begin(), pageCapacities.end(),
+                          [](uint32_t capa) { return capa <= 1024U || capa % 1024U == 0; }));
+  EXPECT_EQ(pageCapacities.back(), 3072U);
+
+  // Reserve stays exact
+  doublingV.reserve(5000U);
+  EXPECT_EQ(doublingV.capacity(), 5000U);
+
+  // Dynamic storage can be stolen from a vector with another growing policy
+  SmallVector<int32_t, 4, Alloc, uint32_t, vec::DoublingGrowingPolicy> sv(std::move(v));
+  EXPECT_EQ(sv.size(), 3000U);
+  EXPECT_TRUE(v.empty());
+#ifdef AMC_NONSTD_FEATURES
+  sv.swap2(sizeClassV);
+  EXPECT_EQ(sizeClassV.size(), 3000U);
+#endif
+}
+
+TEST(VectorTest, AllocateAtLeast) {
+  using IntAlloc = BasicAllocatorWrapper<int32_t, TestAtLeastAllocator>;
+  vector<int32_t, IntAlloc> v;
+  v.push_back(0);
+  EXPECT_EQ(v.capacity(), 16U);
+  for (int32_t i = 1; i < 17; ++i) {
+    v.push_back(i);
+  }
+  // 16 * 1.5 elements of 4 bytes, rounded up to 128 bytes
+  EXPECT_EQ(v.capacity(), 32U);
+  for (int32_t i = 0; i < 17; ++i) {
+    EXPECT_EQ(v[i], i);
+  }
+  // Reserve stays exact
+  v.reserve(100U);
+  EXPECT_EQ(v.capacity(), 100U);
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 17U);
+
+  SmallVector<int32_t, 4, IntAlloc> sv{0, 1, 2, 3};
+  sv.push_back(4);
+  EXPECT_EQ(sv.capacity(), 16U);
+  for (int32_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(sv[i], i);
+  }
+
+  // TestAtLeastAllocator returns blocks of 64 bytes for a single element: all of them are used without reallocation
+  using ObjType = NonTriviallyRelocatableType;
+  static_assert(2 * sizeof(ObjType) <= TestAtLeastAllocator::kBlockSize, "Test needs several elements per block");
+  constexpr uint32_t kNbObjsPerBlock = static_cast<uint32_t>(TestAtLeastAllocator::kBlockSize / sizeof(ObjType));
+  vector<ObjType, BasicAllocatorWrapper<ObjType, TestAtLeastAllocator>> objs;
+  objs.emplace_back(0U);
+  EXPECT_EQ(objs.capacity(), kNbObjsPerBlock);
+  const ObjType *data = objs.data();
+  for (uint32_t i = 1; i < kNbObjsPerBlock; ++i) {
+    objs.emplace_back(i);
+    EXPECT_EQ(objs.data(), data);
+    EXPECT_EQ(objs.capacity(), kNbObjsPerBlock);
+  }
+  for (uint32_t i = kNbObjsPerBlock; i < 20; ++i) {
+    objs.emplace_back(i);
+  }
+  for (uint32_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(objs[i], ObjType(i));
+  }
+
+  // Real capacity is at least the requested one with amc::allocator
+  vector<int32_t> defaultV;
+  for (int32_t i = 0; i < 1000; ++i) {
+    defaultV.push_back(i);
+    EXPECT_GE(defaultV.capacity(), defaultV.size());
+  }
+  EXPECT_EQ(defaultV.back(), 999);
+}
+
+TEST(VectorTest, MonotonicArena) {
+  MonotonicArena arena(1024);
+  void *p1 = arena.allocate(10);
+  void *p2 = arena.allocate(100);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(p2) % MonotonicArena::kAlignment, 0U);
+  // Last block is extended or shrunk in place
+  EXPECT_EQ(arena.reallocate(p2, 100, 500), p2);
+  EXPECT_EQ(arena.reallocate(p2, 500, 50), p2);
+  EXPECT_FALSE(arena.try_expand(p1, 10, 100));
+  // Other blocks are moved
+  std::memset(p1, 42, 10);
+  void *p3 = arena.reallocate(p1, 10, 100);
+  EXPECT_NE(p3, p1);
+  EXPECT_EQ(static_cast<char *>(p3)[9], 42);
+  // Last block is reused after deallocation
+  arena.deallocate(p3, 100);
+  EXPECT_EQ(arena.allocate(20), p3);
+  EXPECT_EQ(arena.chunksSize(), 1024U);
+  // New chunk is allocated when current one is full
+  arena.allocate(2000);
+  EXPECT_GE(arena.chunksSize(), 1024U + 2000U);
+  arena.release();
+  EXPECT_EQ(arena.chunksSize(), 0U);
+}
+
+TEST(VectorTest, ArenaAllocator) {
+  MonotonicArena arena;
+  {
+    using IntVector = vector<int32_t, arena_allocator<int32_t>>;
+    const arena_allocator<int32_t> alloc(arena);
+    IntVector v(alloc);
+    for (int32_t i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+    const int32_t *data = v.data();
+    v.push_back(1000);
+    // Only allocation of the arena: vector is grown in place
+    EXPECT_EQ(v.data(), data);
+
+    // Allocator is propagated
+    IntVector copy(v);
+    EXPECT_EQ(&copy.get_allocator().basic_allocator().arena(), &arena);
+    IntVector moved(std::move(copy));
+    EXPECT_EQ(&moved.get_allocator().basic_allocator().arena(), &arena);
+    EXPECT_EQ(moved.size(), 1001U);
+    moved.push_back(1001);
+    EXPECT_EQ(moved.back(), 1001);
+
+    using StringSmallVector = SmallVector<std::string, 4, arena_allocator<std::string>>;
+    StringSmallVector strings{arena_allocator<std::string>(arena)};
+    for (int i = 0; i < 100; ++i) {
+      strings.push_back(std::to_string(i) + " is not a short string");
+    }
+    StringSmallVector otherStrings(std::move(strings));
+    otherStrings.emplace_back("other");
+    EXPECT_EQ(otherStrings[42], "42 is not a short string");
+
+    FlatSet<int32_t, std::less<int32_t>, arena_allocator<int32_t>> set(v.rbegin(), v.rend(), alloc);
+    EXPECT_EQ(set.size(), 1001U);
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), v.begin()));
+  }
+  EXPECT_GT(arena.chunksSize(), 0U);
+
+  struct RequestTag {};
+  {
+    vector<int32_t, monotonic_allocator<int32_t, RequestTag>> v(10, 7);
+    v.resize(1000, 8);
+    EXPECT_EQ(v[9], 7);
+    EXPECT_EQ(v[10], 8);
+    EXPECT_GT(ThreadLocalMonotonicArena<RequestTag>::instance().chunksSize(), 0U);
+  }
+  ThreadLocalMonotonicArena<RequestTag>::release();
+  EXPECT_EQ(ThreadLocalMonotonicArena<RequestTag>::instance().chunksSize(), 0U);
+}
+
+TEST(VectorTest, PoolAllocatorSizeClasses) {
+  EXPECT_EQ(PoolAllocator::ClassSize(PoolAllocator::SizeClass(1)), 16U);
+  EXPECT_EQ(PoolAllocator::ClassSize(PoolAllocator::SizeClass(17)), 32U);
+  EXPECT_EQ(PoolAllocator::ClassSize(PoolAllocator::SizeClass(129)), 160U);
+  EXPECT_EQ(PoolAllocator::ClassSize(PoolAllocator::SizeClass(257)), 320U);
+  EXPECT_EQ(PoolAllocator::SizeClass(PoolAllocator::kMaxPooledSize), PoolAllocator::kNbSizeClasses - 1U);
+  for (size_t sizeClass = 0; sizeClass < PoolAllocator::kNbSizeClasses; ++sizeClass) {
+    EXPECT_EQ(PoolAllocator::SizeClass(PoolAllocator::ClassSize(sizeClass)), sizeClass);
+    EXPECT_EQ(PoolAllocator::ClassSize(sizeClass) % 16U, 0U);
+  }
+}
+
+TEST(VectorTest, PoolAllocator) {
+  PoolAllocator &pool = PoolAllocator::instance();
+  void *p = pool.allocate(24);
+  allocation_result<void *> res = pool.reallocate_at_least(p, 24, 30);
+  // Same size class: block is kept
+  EXPECT_EQ(res.ptr, p);
+  EXPECT_EQ(res.count, 32U);
+  EXPECT_TRUE(pool.try_expand(p, 30, 32));
+  EXPECT_FALSE(pool.try_expand(p, 32, 33));
+  pool.deallocate(p, 32);
+  // Last freed block of a size class is reused first
+  EXPECT_EQ(pool.allocate(20), p);
+  pool.deallocate(p, 20);
+
+  using IntVector = vector<int32_t, pool_allocator<int32_t>>;
+  IntVector v;
+  for (int32_t i = 0; i < 100000; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v[99999], 99999);
+  v.resize(10);
+  v.shrink_to_fit();
+  EXPECT_EQ(v, IntVector({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+  using StringSmallVector = SmallVector<std::string, 2, pool_allocator<std::string>>;
+  StringSmallVector strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i) + " is not a short string");
+  }
+  EXPECT_EQ(strings[42], "42 is not a short string");
+
+  // Blocks freed by another thread are given back to their owner
+  IntVector otherThreadVector;
+  std::thread([&otherThreadVector] { otherThreadVector.assign(3, 7); }).join();
+  otherThreadVector.push_back(8);
+  EXPECT_EQ(otherThreadVector, IntVector({7, 7, 7, 8}));
+  std::thread([&v] { v = IntVector(); }).join();
+  v.assign(5, 1);
+  EXPECT_EQ(v.size(), 5U);
+}
+
+TEST(VectorTest, StatefulAllocatorsMoveAndSwap) {
+  MonotonicArena arena1;
+  MonotonicArena arena2;
+  using IntVector = vector<int32_t, arena_allocator<int32_t>>;
+  const arena_allocator<int32_t> alloc1(arena1);
+  const arena_allocator<int32_t> alloc2(arena2);
+  EXPECT_EQ(alloc1, arena_allocator<int32_t>(arena1));
+  EXPECT_NE(alloc1, alloc2);
+
+  IntVector v1({1, 2, 3}, alloc1);
+  IntVector v2({4, 5}, alloc2);
+  IntVector v3({6}, alloc1);
+
+  // Same arena: dynamic storage is stolen
+  const int32_t *data = v1.data();
+  v3 = std::move(v1);
+  EXPECT_EQ(v3.data(), data);
+  EXPECT_EQ(v3, IntVector({1, 2, 3}, alloc1));
+
+  // Different arenas: elements are moved, allocator is kept
+  v3 = std::move(v2);
+  EXPECT_EQ(&v3.get_allocator().basic_allocator().arena(), &arena1);
+  EXPECT_EQ(v3, IntVector({4, 5}, alloc1));
+
+  IntVector v4(std::move(v3), alloc2);
+  EXPECT_EQ(&v4.get_allocator().basic_allocator().arena(), &arena2);
+  EXPECT_EQ(v4, IntVector({4, 5}, alloc2));
+
+  using SmallIntVector = SmallVector<int32_t, 2, arena_allocator<int32_t>>;
+  SmallIntVector s1({1, 2, 3, 4}, alloc1);
+  SmallIntVector s2({5, 6, 7}, alloc2);
+  s2 = std::move(s1);
+  EXPECT_EQ(s2, SmallIntVector({1, 2, 3, 4}, alloc2));
+  EXPECT_EQ(&s2.get_allocator().basic_allocator().arena(), &arena2);
+
+#ifdef AMC_NONSTD_FEATURES
+  // Dynamic storages of vectors with different allocators cannot be swapped
+  IntVector v5({7, 8, 9}, alloc1);
+  SmallIntVector s3({10, 11, 12}, alloc2);
+  v5.swap2(s3);
+  EXPECT_EQ(v5, IntVector({10, 11, 12}, alloc1));
+  EXPECT_EQ(s3, SmallIntVector({7, 8, 9}, alloc2));
+#endif
+}
+
+TEST(VectorTest, StatsAllocator) {
+  EXPECT_EQ(AllocationCounters::SizeBucket(0), 0U);
+  EXPECT_EQ(AllocationCounters::SizeBucket(1), 0U);
+  EXPECT_EQ(AllocationCounters::SizeBucket(4), 2U);
+  EXPECT_EQ(AllocationCounters::SizeBucket(1023), 9U);
+  EXPECT_EQ(AllocationCounters::SizeBucket(1024), 10U);
+
+  struct IntTag {};
+  struct StringTag {};
+  AllocationStats<IntTag>::reset();
+  AllocationStats<StringTag>::reset();
+  {
+    using IntVector = vector<int32_t, BasicAllocatorWrapper<int32_t, StatsAllocator<IntTag>>>;
+    IntVector v;
+    for (int32_t i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+    AllocationStatsSnapshot stats = AllocationStats<IntTag>::snapshot();
+    EXPECT_GT(stats.nbAllocations + stats.nbReallocations(), 1U);
+    EXPECT_EQ(stats.nbDeallocations, 0U);
+    EXPECT_EQ(stats.liveBytes, v.capacity() * sizeof(int32_t));
+    EXPECT_GE(stats.peakLiveBytes, stats.liveBytes);
+    EXPECT_GE(stats.allocatedBytes, stats.liveBytes);
+  }
+  AllocationStatsSnapshot stats = AllocationStats<IntTag>::snapshot();
+  EXPECT_EQ(stats.nbDeallocations, 1U);
+  EXPECT_EQ(stats.liveBytes, 0U);
+  EXPECT_EQ(std::accumulate(std::begin(stats.deallocationSizes), std::end(stats.deallocationSizes), uint64_t(0)), 1U);
+  EXPECT_EQ(std::accumulate(std::begin(stats.reallocationSizes), std::end(stats.reallocationSizes), uint64_t(0)),
+            stats.nbReallocations());
+  EXPECT_EQ(AllocationStats<StringTag>::snapshot().nbAllocations, 0U);
+
+  // Moved reallocations of non trivially relocatable elements are recorded as failed expansions
+  MonotonicArena arena;
+  using ArenaStatsAllocator = StatsAllocator<StringTag, MonotonicArenaRef>;
+  using StringVector = vector<std::string, BasicAllocatorWrapper<std::string, ArenaStatsAllocator>>;
+  StringVector strings{BasicAllocatorWrapper<std::string, ArenaStatsAllocator>(ArenaStatsAllocator(arena))};
+  strings.emplace_back("first");
+  strings.resize(100);
+  stats = AllocationStats<StringTag>::snapshot();
+  EXPECT_EQ(stats.nbAllocations, 1U);
+  EXPECT_EQ(stats.nbMovedReallocations, 0U);
+  EXPECT_GT(stats.nbInPlaceReallocations, 0U);
+  EXPECT_EQ(stats.inPlaceReallocationRatio(), 1.0);
+
+  StringVector otherStrings(strings);
+  strings.resize(1000);
+  stats = AllocationStats<StringTag>::snapshot();
+  EXPECT_EQ(stats.nbMovedReallocations, 1U);
+  EXPECT_EQ(stats.nbAllocations, 3U);
+  EXPECT_EQ(stats.nbDeallocations, 1U);
+  EXPECT_LT(stats.inPlaceReallocationRatio(), 1.0);
+
+  // Usable sizes of blocks (24 bytes for 16 requested with glibc) are not always a multiple of the size of elements
+  struct PairTag {};
+  struct Pair16 {
+    uint64_t first;
+    uint64_t second;
+  };
+  AllocationStats<PairTag>::reset();
+  AllocationStats<StringTag>::reset();
+  {
+    vector<Pair16, BasicAllocatorWrapper<Pair16, StatsAllocator<PairTag>>> pairs;
+    vector<std::string, BasicAllocatorWrapper<std::string, StatsAllocator<StringTag>>> largeStrings;
+    for (uint64_t i = 0; i < 100; ++i) {
+      pairs.push_back(Pair16{i, i});
+      largeStrings.emplace_back(100, 'a');
+      EXPECT_EQ(AllocationStats<PairTag>::snapshot().liveBytes, pairs.capacity() * sizeof(Pair16));
+      EXPECT_EQ(AllocationStats<StringTag>::snapshot().liveBytes, largeStrings.capacity() * sizeof(std::string));
+    }
+  }
+  EXPECT_EQ(AllocationStats<PairTag>::snapshot().liveBytes, 0U);
+  EXPECT_EQ(AllocationStats<StringTag>::snapshot().liveBytes, 0U);
+
+#ifndef AMC_NO_ALLOCATION_STATS
+  struct DefaultTag {};
+  vector<char, stats_allocator<char, DefaultTag>> chars(100, 'a');
+  EXPECT_EQ(AllocationStats<DefaultTag>::snapshot().allocationSizes[6], 1U);
+#endif
+}
+
+#ifdef AMC_MEMORY_RESOURCE
+TEST(VectorTest, MemoryResourceAllocator) {
+  std::pmr::monotonic_buffer_resource resource;
+  using IntVector = vector<int32_t, pmr_allocator<int32_t>>;
+  const pmr_allocator<int32_t> alloc(&resource);
+  EXPECT_EQ(alloc.basic_allocator().resource(), &resource);
+  EXPECT_EQ(pmr_allocator<int32_t>().basic_allocator().resource(), std::pmr::get_default_resource());
+  EXPECT_NE(alloc, pmr_allocator<int32_t>());
+
+  IntVector v(alloc);
+  for (int32_t i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v[999], 999);
+  IntVector copy(v);
+  EXPECT_EQ(copy.get_allocator(), alloc);
+
+  using StringSmallVector = SmallVector<std::string, 2, pmr_allocator<std::string>>;
+  StringSmallVector strings{pmr_allocator<std::string>(&resource)};
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i) + " is not a short string");
+  }
+  EXPECT_EQ(strings[42], "42 is not a short string");
+
+  IntVector defaultVector(v.begin(), v.begin() + 10);
+  defaultVector = std::move(v);
+  EXPECT_EQ(defaultVector.size(), 1000U);
+  EXPECT_EQ(defaultVector.get_allocator(), pmr_allocator<int32_t>());
+}
+
+TEST(VectorTest, MonotonicArenaResource) {
+  MonotonicArenaResource resource;
+  using IntVector = vector<int32_t, pmr_allocator<int32_t>>;
+  IntVector v{pmr_allocator<int32_t>(&resource)};
+  v.push_back(0);
+  const int32_t *data = v.data();
+  for (int32_t i = 1; i < 1000; ++i) {
+    v.push_back(i);
+  }
+  // Last block of the arena is extended in place
+  EXPECT_EQ(v.data(), data);
+
+  using NonTrivVector = vector<std::string, pmr_allocator<std::string>>;
+  NonTrivVector strings{pmr_allocator<std::string>(&resource)};
+  strings.emplace_back("first");
+  const std::string *stringsData = strings.data();
+  strings.resize(100);
+  EXPECT_EQ(strings.data(), stringsData);
+
+  // Shared with std::pmr containers
+  std::pmr::vector<int32_t> stdVector(v.begin(), v.end(), &resource);
+  EXPECT_TRUE(std::equal(stdVector.begin(), stdVector.end(), v.begin(), v.end()));
+
+  struct alignas(64) OverAligned {
+    char c;
+  };
+  std::pmr::vector<OverAligned> overAligned(3, &resource);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(overAligned.data()) % 64U, 0U);
+}
+#endif
+
+TEST(VectorTest, SoAVectorColumns) {
+  using SoAType = SoAVector<char, double, int16_t>;
+  SoAType v;
+  EXPECT_TRUE(v.empty());
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(static_cast<char>('a' + i % 26), i * 0.5, static_cast<int16_t>(-i));
+  }
+  EXPECT_EQ(v.size(), 100U);
+  EXPECT_GE(v.capacity(), 100U);
+  EXPECT_EQ(v[3], std::make_tuple('d', 1.5, int16_t(-3)));
+  EXPECT_EQ(std::get<2>(v.back()), -99);
+
+  // Columns are contiguous and aligned for their type
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(v.data<1>()) % alignof(double), 0U);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(v.data<2>()) % alignof(int16_t), 0U);
+  const double sum = std::accumulate(v.column<1>().begin(), v.column<1>().end(), 0.0);
+  EXPECT_EQ(sum, 0.5 * (99 * 100) / 2);
+  for (int16_t &e : v.column<2>()) {
+    e = static_cast<int16_t>(-e);
+  }
+  EXPECT_EQ(v.column<2>()[42], 42);
+
+  // Proxy references
+  std::get<0>(v[0]) = 'z';
+  v[1] = std::make_tuple('y', -1.0, int16_t(7));
+  EXPECT_EQ(v.front(), std::make_tuple('z', 0.0, int16_t(0)));
+  EXPECT_EQ(v[1], std::make_tuple('y', -1.0, int16_t(7)));
+  int nbRows = 0;
+  for (SoAType::reference row : v) {
+    EXPECT_EQ(std::get<1>(row), v.data<1>()[nbRows++]);
+  }
+  EXPECT_EQ(nbRows, 100);
+  EXPECT_EQ(v.end() - v.begin(), 100);
+  EXPECT_EQ(std::get<0>(*v.rbegin()), v.data<0>()[99]);
+  EXPECT_THROW(v.at(100), std::out_of_range);
+
+  v.resize(10);
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 10U);
+  EXPECT_EQ(std::get<2>(v.at(9)), 9);
+}
+
+TEST(VectorTest, SoAVectorInsertErase) {
+  using SoAType = SoAVector<std::string, int32_t>;
+  SoAType v{std::make_tuple(std::string("first"), 1), std::make_tuple(std::string("last"), 4)};
+  v.insert(v.begin() + 1, std::make_tuple(std::string("second"), 2));
+  SoAType::iterator it = v.emplace(v.end() - 1, "third", 3);
+  EXPECT_EQ(it - v.begin(), 2);
+  EXPECT_EQ(std::get<0>(*it), "third");
+  EXPECT_EQ(v, SoAType({std::make_tuple(std::string("first"), 1), std::make_tuple(std::string("second"), 2),
+                        std::make_tuple(std::string("third"), 3), std::make_tuple(std::string("last"), 4)}));
+
+  // Arguments may refer to elements of the vector when it grows
+  v.shrink_to_fit();
+  v.emplace(v.begin(), std::get<0>(v[3]), std::get<1>(v[3]));
+  EXPECT_EQ(v.size(), 5U);
+  EXPECT_EQ(v.front(), std::make_tuple(std::string("last"), 4));
+  EXPECT_EQ(v.back(), std::make_tuple(std::string("last"), 4));
+
+  it = v.erase(v.begin() + 1);
+  EXPECT_EQ(std::get<1>(*it), 2);
+  it = v.erase(v.begin(), v.begin() + 2);
+  EXPECT_EQ(it, v.begin());
+  EXPECT_EQ(v.size(), 2U);
+  EXPECT_EQ(v[0], std::make_tuple(std::string("third"), 3));
+  v.pop_back();
+  EXPECT_EQ(v.size(), 1U);
+
+  SoAType copy(v);
+  SoAType moved(std::move(v));
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(copy, moved);
+  copy.push_back(std::make_tuple(std::string("other"), 5));
+  EXPECT_NE(copy, moved);
+  swap(copy, moved);
+  EXPECT_EQ(moved.size(), 2U);
+  copy = moved;
+  EXPECT_EQ(copy, moved);
+  copy.clear();
+  EXPECT_TRUE(copy.empty());
+}
+
+TEST(VectorTest, SoAVectorStandardAlgorithms) {
+  using SoAType = SoAVector<std::string, int32_t>;
+  SoAType v;
+  for (int32_t i = 0; i < 100; ++i) {
+    const int32_t key = (i * 37) % 100;
+    v.emplace_back(std::to_string(key), key);
+  }
+  // Rows are moved as a whole: both columns stay consistent
+  std::sort(v.begin(), v.end(), [](SoAType::const_reference lhs, SoAType::const_reference rhs) {
+    return std::get<1>(lhs) < std::get<1>(rhs);
+  });
+  EXPECT_TRUE(std::is_sorted(v.column<1>().begin(), v.column<1>().end()));
+  for (SoAType::size_type i = 0; i < v.size(); ++i) {
+    EXPECT_EQ(v[i], std::make_tuple(std::to_string(i), static_cast<int32_t>(i)));
+  }
+
+  std::rotate(v.begin(), v.begin() + 10, v.end());
+  EXPECT_EQ(v.front(), std::make_tuple(std::string("10"), 10));
+  EXPECT_EQ(v.back(), std::make_tuple(std::string("9"), 9));
+
+  std::reverse(v.begin(), v.end());
+  EXPECT_EQ(v.front(), std::make_tuple(std::string("9"), 9));
+
+  swap(v[0], v[1]);
+  SoAType::value_type first = v[0];
+  EXPECT_EQ(first, std::make_tuple(std::string("8"), 8));
+#ifdef AMC_CXX17
+  auto [str, key] = v[1];
+  EXPECT_EQ(str, "9");
+  EXPECT_EQ(key, 9);
+#endif
+}
+
+TEST(VectorTest, SegmentedVectorStableReferences) {
+  using SegmentedType = SegmentedVector<uint32_t, 8>;
+  SegmentedType v;
+  v.push_back(0);
+  const uint32_t *first = &v.front();
+  for (uint32_t i = 1; i < 100; ++i) {
+    v.push_back(i);
+    EXPECT_EQ(&v.front(), first);
+  }
+  EXPECT_EQ(v.size(), 100U);
+  EXPECT_EQ(v.capacity(), 104U);
+  EXPECT_EQ(v.nb_chunks(), 13U);
+  EXPECT_EQ(v.chunk_size(12), 4U);
+  EXPECT_EQ(v.chunk_data(1)[3], 11U);
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(v[i], i);
+  }
+  EXPECT_EQ(std::accumulate(v.begin(), v.end(), 0U), 4950U);
+  EXPECT_EQ(v.end() - v.begin(), 100);
+  EXPECT_EQ(*(v.rbegin() + 1), 98U);
+  EXPECT_THROW(v.at(100), std::out_of_range);
+
+  // Chunks are kept on clear, and freed by shrink_to_fit
+  v.resize(10);
+  v.clear();
+  EXPECT_EQ(v.capacity(), 104U);
+  v.emplace_back(42U);
+  EXPECT_EQ(&v.front(), first);
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 8U);
+
+  // Chunk size which is not a power of 2
+  SegmentedVector<std::string, 3> strings{"a", "b", "c", "d"};
+  strings.resize(7, "e");
+  EXPECT_EQ(strings[3], "d");
+  EXPECT_EQ(strings.back(), "e");
+  strings.pop_back();
+  EXPECT_EQ(strings.size(), 6U);
+  EXPECT_EQ(strings.capacity(), 9U);
+}
+
+TEST(VectorTest, SegmentedVectorCopyMoveFlatten) {
+  using SegmentedType = SegmentedVector<std::string, 4>;
+  SegmentedType v;
+  for (int i = 0; i < 10; ++i) {
+    v.push_back(std::to_string(i));
+  }
+  SegmentedType copy(v);
+  EXPECT_EQ(copy, v);
+  SegmentedType moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved, v);
+  moved.emplace_back("10");
+  EXPECT_NE(moved, v);
+  copy = moved;
+  EXPECT_EQ(copy, moved);
+  swap(copy, v);
+  EXPECT_EQ(v.size(), 11U);
+
+  vector<std::string> flat = v.flatten();
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(v.capacity(), 0U);
+  EXPECT_EQ(flat.size(), 11U);
+  EXPECT_EQ(flat.capacity(), 11U);
+  EXPECT_TRUE(std::equal(flat.begin(), flat.end(), moved.begin()));
+
+  using SegmentedInts = SegmentedVector<int, 16>;
+  SegmentedInts ints(20, 3);
+  vector<int> flatInts = ints.flatten();
+  EXPECT_EQ(flatInts, vector<int>(20, 3));
+  EXPECT_TRUE(SegmentedInts().flatten().empty());
+}
+
+TEST(VectorTest, SegmentedVectorStatefulAllocators) {
+  MonotonicArena arena1;
+  MonotonicArena arena2;
+  using SegmentedInts = SegmentedVector<int, 4, arena_allocator<int>>;
+  const arena_allocator<int> alloc1(arena1);
+  const arena_allocator<int> alloc2(arena2);
+
+  SegmentedInts v1({1, 2, 3, 4, 5}, alloc1);
+  SegmentedInts v2({6, 7}, alloc2);
+  SegmentedInts v3({8}, alloc1);
+
+  // Same arena: chunks are stolen
+  const int *chunk = v1.chunk_data(0);
+  v3 = std::move(v1);
+  EXPECT_EQ(v3.chunk_data(0), chunk);
+  EXPECT_TRUE(v1.empty());
+  EXPECT_EQ(v3, SegmentedInts({1, 2, 3, 4, 5}, alloc1));
+
+  // Different arenas: elements are moved, allocator is kept
+  v3 = std::move(v2);
+  EXPECT_EQ(&v3.get_allocator().basic_allocator().arena(), &arena1);
+  EXPECT_EQ(v3, SegmentedInts({6, 7}, alloc1));
+
+  SegmentedInts v4({9, 10, 11, 12, 13, 14}, alloc2);
+  v3 = v4;
+  EXPECT_EQ(&v3.get_allocator().basic_allocator().arena(), &arena1);
+  EXPECT_EQ(v3, v4);
+
+  SegmentedInts v5(alloc1);
+  v5.swap(v3);
+  EXPECT_EQ(v5, v4);
+  EXPECT_TRUE(v3.empty());
+}
+
+TEST(VectorTest, FixedCapacityRing) {
+  using RingType = FixedCapacityRing<std::string, 5>;
+  RingType r;
+  EXPECT_EQ(r.capacity(), 5U);
+  r.push_back("2");
+  r.push_back("3");
+  r.push_front("1");
+  r.emplace_front("0");
+  r.emplace_back("4");
+  EXPECT_TRUE(r.full());
+  EXPECT_THROW(r.push_back("5"), std::out_of_range);
+  EXPECT_THROW(r.push_front("5"), std::out_of_range);
+  EXPECT_EQ(r, RingType({"0", "1", "2", "3", "4"}));
+  EXPECT_EQ(r.front(), "0");
+  EXPECT_EQ(r.back(), "4");
+  EXPECT_THROW(r.at(5), std::out_of_range);
+
+  // Elements wrap around the end of the 8 slots
+  r.pop_front();
+#ifdef AMC_NONSTD_FEATURES
+  EXPECT_EQ(r.pop_front_val(), "1");
+#else
+  EXPECT_EQ(r.front(), "1");
+  r.pop_front();
+#endif
+  r.push_back("5");
+  r.push_back("6");
+  r.pop_back();
+  r.push_back("7");
+  EXPECT_EQ(r, RingType({"2", "3", "4", "5", "7"}));
+  for (int i = 8; i < 20; ++i) {
+    r.pop_front();
+    r.push_back(std::to_string(i));
+  }
+  auto one = r.array_one();
+  auto two = r.array_two();
+  EXPECT_EQ(one.second + two.second, r.size());
+  EXPECT_EQ(one.first[0], "15");
+  EXPECT_EQ(two.first[two.second - 1U], "19");
+  EXPECT_TRUE(std::equal(one.first, one.first + one.second, r.begin()));
+  EXPECT_TRUE(std::equal(two.first, two.first + two.second, r.begin() + one.second));
+
+  RingType copy(r);
+  EXPECT_EQ(copy, r);
+  RingType moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved, r);
+  EXPECT_EQ(moved.array_two().second, 0U);
+  moved.pop_back();
+  swap(moved, r);
+  EXPECT_EQ(r.size(), 4U);
+  EXPECT_EQ(std::vector<std::string>(r.rbegin(), r.rend()), std::vector<std::string>({"18", "17", "16", "15"}));
+  r.clear();
+  EXPECT_TRUE(r.empty());
+  EXPECT_EQ(r.array_one().second, 0U);
+}
+
+TEST(VectorTest, RingVector) {
+  using RingType = RingVector<std::string>;
+  RingType r;
+  EXPECT_EQ(r.capacity(), 0U);
+  for (int i = 0; i < 10; ++i) {
+    r.push_back(std::to_string(i));
+    EXPECT_EQ(r.capacity() & (r.capacity() - 1U), 0U);
+  }
+  r.pop_front();
+  r.pop_front();
+  while (!r.full()) {
+    r.push_front(r.back());
+  }
+  const auto capacity = r.capacity();
+  EXPECT_GT(r.array_two().second, 0U);
+  // Pushed element refers to an element of the ring, relocated when growing
+  r.push_back(r.front());
+  EXPECT_GT(r.capacity(), capacity);
+  EXPECT_EQ(r.front(), "9");
+  EXPECT_EQ(r.back(), "9");
+  EXPECT_EQ(r.array_two().second, 0U);
+  EXPECT_EQ(r[capacity - 8U], "2");
+
+  r.push_front("front");
+  EXPECT_EQ(r.front(), "front");
+  EXPECT_EQ(r[1], "9");
+
+  RingType copy(r);
+  EXPECT_EQ(copy, r);
+  RingType moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.capacity(), 0U);
+  EXPECT_EQ(moved, r);
+
+  while (r.size() > 3U) {
+    r.pop_front();
+  }
+  r.shrink_to_fit();
+  EXPECT_EQ(r.capacity(), 4U);
+  EXPECT_EQ(r, RingType({"8", "9", "9"}));
+  r.reserve(100);
+  EXPECT_EQ(r.capacity(), 128U);
+  r.clear();
+  r.shrink_to_fit();
+  EXPECT_EQ(r.capacity(), 0U);
+
+  // Growing relocates the wrapped halves without any forbidden move operation
+  RingVector<MoveForbidden<true>> relocRing;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NO_THROW(relocRing.emplace_front());
+    EXPECT_NO_THROW(relocRing.emplace_back());
+  }
+  EXPECT_EQ(relocRing.size(), 200U);
+  RingVector<MoveForbidden<false>> nonRelocRing;
+  EXPECT_THROW(nonRelocRing.emplace_back(), MoveForbiddenException);
+}
+
+TEST(VectorTest, RingVectorStatefulAllocators) {
+  MonotonicArena arena1;
+  MonotonicArena arena2;
+  using RingType = RingVector<int, arena_allocator<int>>;
+  const arena_allocator<int> alloc1(arena1);
+  const arena_allocator<int> alloc2(arena2);
+
+  RingType r1({1, 2, 3}, alloc1);
+  RingType r2({4, 5}, alloc2);
+  RingType r3({6}, alloc1);
+
+  // Same arena: storage is stolen
+  const int *front = &r1.front();
+  r3 = std::move(r1);
+  EXPECT_EQ(&r3.front(), front);
+  EXPECT_TRUE(r1.empty());
+  EXPECT_EQ(r3, RingType({1, 2, 3}, alloc1));
+
+  // Different arenas: elements are moved, allocator is kept
+  r3 = std::move(r2);
+  EXPECT_EQ(&r3.get_allocator().basic_allocator().arena(), &arena1);
+  EXPECT_EQ(r3, RingType({4, 5}, alloc1));
+
+  RingType r4({7, 8, 9, 10, 11}, alloc2);
+  r3 = r4;
+  EXPECT_EQ(&r3.get_allocator().basic_allocator().arena(), &arena1);
+  EXPECT_EQ(r3, r4);
+
+  RingType r5(alloc1);
+  r5.swap(r3);
+  EXPECT_EQ(r5, r4);
+  EXPECT_TRUE(r3.empty());
+  EXPECT_EQ(&r5.get_allocator().basic_allocator().arena(), &arena1);
+}
+
 template <typename T>
 class VectorTestUnalignedStorage : public ::testing::Test {
  public: